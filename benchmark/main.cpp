@@ -0,0 +1,584 @@
+#include <iostream>
+#include <iomanip>
+#include <sstream>
+#include <algorithm>
+#include <string>
+#include <vector>
+#include <boost/filesystem.hpp>
+#include <boost/program_options.hpp>
+#include <base/Time.hpp>
+#include <base/samples/Sonar.hpp>
+#include <opencv2/opencv.hpp>
+#include "sonar_processing/ScanningHolder.hpp"
+#include "sonarlog_obstacle_detection/BitMask.hpp"
+#include "sonarlog_obstacle_detection/BlobTracker.hpp"
+#include "sonarlog_obstacle_detection/CartesianProjection.hpp"
+#include "sonarlog_obstacle_detection/Detection.hpp"
+#include "sonarlog_obstacle_detection/DetectionWriter.hpp"
+#include "sonarlog_obstacle_detection/DeviceProjector.hpp"
+#include "sonarlog_obstacle_detection/FramePool.hpp"
+#include "sonarlog_obstacle_detection/MappedLog.hpp"
+#include "sonarlog_obstacle_detection/ParameterSweep.hpp"
+#include "sonarlog_obstacle_detection/PolarDetector.hpp"
+#include "sonarlog_obstacle_detection/PolarSweep.hpp"
+#include "sonarlog_obstacle_detection/Metrics.hpp"
+#include "sonarlog_obstacle_detection/RangeRoi.hpp"
+#include "sonarlog_obstacle_detection/RlsDenoiser.hpp"
+#include "sonarlog_obstacle_detection/ScanningCanvas.hpp"
+#include "sonarlog_obstacle_detection/SparseBinFilter.hpp"
+#include "sonarlog_obstacle_detection/SsivDetector.hpp"
+#include "sonarlog_obstacle_detection/SymmetricRemoval.hpp"
+#include "sonarlog_obstacle_detection/SyntheticSonar.hpp"
+
+using namespace sonar_processing;
+using namespace sonarlog_obstacle_detection;
+
+namespace {
+
+/* per-iteration wall time of one stage */
+class StageTimer {
+public:
+
+    StageTimer(const std::string& stage, const std::string& device, const std::string& variant)
+        : stage_(stage)
+        , device_(device)
+        , variant_(variant)
+        , items_(0) {
+    }
+
+    void start() {
+        start_ = base::Time::now();
+    }
+
+    void stop(size_t items = 1) {
+        durations_.push_back((base::Time::now() - start_).toSeconds() * 1e6);
+        items_ += items;
+    }
+
+    std::string stage_;
+    std::string device_;
+    std::string variant_;
+    std::vector<double> durations_;
+    size_t items_;
+
+private:
+    base::Time start_;
+};
+
+struct Result {
+    std::string stage;
+    std::string device;
+    std::string variant;
+    size_t iterations;
+    double mean_us;
+    double min_us;
+    double median_us;
+    double max_us;
+    double items_per_second;
+};
+
+Result summarize(StageTimer& timer) {
+    Result result;
+    result.stage = timer.stage_;
+    result.device = timer.device_;
+    result.variant = timer.variant_;
+    result.iterations = timer.durations_.size();
+
+    std::vector<double>& durations = timer.durations_;
+    std::sort(durations.begin(), durations.end());
+
+    double total = 0;
+    for (size_t i = 0; i < durations.size(); i++) total += durations[i];
+
+    bool empty = durations.empty();
+    result.mean_us = empty ? 0 : total / durations.size();
+    result.min_us = empty ? 0 : durations.front();
+    result.median_us = empty ? 0 : durations[durations.size() / 2];
+    result.max_us = empty ? 0 : durations.back();
+    result.items_per_second = (total > 0) ? timer.items_ / (total * 1e-6) : 0;
+    return result;
+}
+
+void write_csv(std::ostream& out, const std::vector<Result>& results) {
+    out << "stage,device,variant,iterations,mean_us,min_us,median_us,max_us,items_per_second" << std::endl;
+    out << std::fixed << std::setprecision(3);
+    for (size_t i = 0; i < results.size(); i++) {
+        const Result& r = results[i];
+        out << r.stage << "," << r.device << "," << r.variant << "," << r.iterations << ","
+            << r.mean_us << "," << r.min_us << "," << r.median_us << "," << r.max_us << ","
+            << r.items_per_second << std::endl;
+    }
+}
+
+void write_json(std::ostream& out, const std::vector<Result>& results) {
+    out << std::fixed << std::setprecision(3);
+    out << "[" << std::endl;
+    for (size_t i = 0; i < results.size(); i++) {
+        const Result& r = results[i];
+        out << "  {\"stage\": \"" << r.stage << "\", \"device\": \"" << r.device << "\", \"variant\": \"" << r.variant << "\""
+            << ", \"iterations\": " << r.iterations
+            << ", \"mean_us\": " << r.mean_us
+            << ", \"min_us\": " << r.min_us
+            << ", \"median_us\": " << r.median_us
+            << ", \"max_us\": " << r.max_us
+            << ", \"items_per_second\": " << r.items_per_second << "}"
+            << ((i + 1 < results.size()) ? "," : "") << std::endl;
+    }
+    out << "]" << std::endl;
+}
+
+std::vector<base::samples::Sonar> generate(const SyntheticSonarConfig& config, size_t count) {
+    SyntheticSonar generator(config);
+    std::vector<base::samples::Sonar> pings(count);
+    for (size_t i = 0; i < count; i++) generator.next(pings[i]);
+    return pings;
+}
+
+void bench_sparse_filter(const std::vector<base::samples::Sonar>& pings, const std::string& device,
+                         SparseBinFilter::Mode mode, std::vector<Result>& results) {
+    SparseBinFilter filter(mode);
+    StageTimer timer("sparse_filter", device, (mode == SparseBinFilter::TEMPORAL) ? "temporal" : "spatio_temporal");
+
+    for (size_t i = 0; i < pings.size(); i++) {
+        timer.start();
+        filter.push(pings[i]);
+        timer.stop(pings[i].bins.size());
+    }
+
+    results.push_back(summarize(timer));
+}
+
+/*
+ * Decode and the first stage of the mapped path that reads the ping: the
+ * sparse filter of the detectors and the display projection. "copy" makes
+ * a fresh sample per ping (as the log decoder does), "view" hands them the
+ * view over the marshalled payload, as LogProcessor::process_view.
+ */
+void bench_decode(const std::vector<base::samples::Sonar>& pings, const std::string& device, std::vector<Result>& results) {
+    std::vector<std::vector<char> > payloads(pings.size());
+    for (size_t i = 0; i < pings.size(); i++) SonarView::marshal(pings[i], payloads[i]);
+
+    SparseBinFilter copy_filter(SparseBinFilter::SPATIO_TEMPORAL);
+    StageTimer copy("decode_filter", device, "copy");
+    for (size_t i = 0; i < payloads.size(); i++) {
+        copy.start();
+        SonarView view;
+        base::samples::Sonar sample;
+        view.parse(&payloads[i][0], payloads[i].size());
+        view.copy_to(sample);
+        copy_filter.push(sample);
+        copy.stop(payloads[i].size());
+    }
+    results.push_back(summarize(copy));
+
+    SparseBinFilter view_filter(SparseBinFilter::SPATIO_TEMPORAL);
+    StageTimer mapped("decode_filter", device, "view");
+    for (size_t i = 0; i < payloads.size(); i++) {
+        mapped.start();
+        SonarView view;
+        view.parse(&payloads[i][0], payloads[i].size());
+        view_filter.push(view);
+        mapped.stop(payloads[i].size());
+    }
+    results.push_back(summarize(mapped));
+
+    std::auto_ptr<DeviceProjector> copy_projector = DeviceProjector::create(pings[0]);
+    StageTimer copy_display("decode_display", device, "copy");
+    for (size_t i = 0; i < payloads.size(); i++) {
+        copy_display.start();
+        SonarView view;
+        base::samples::Sonar sample;
+        view.parse(&payloads[i][0], payloads[i].size());
+        view.copy_to(sample);
+        copy_projector->project(sample);
+        copy_display.stop(payloads[i].size());
+    }
+    results.push_back(summarize(copy_display));
+
+    // a payload whose bins are not aligned is copied, as in process_mapped
+    std::auto_ptr<DeviceProjector> view_projector = DeviceProjector::create(pings[0]);
+    base::samples::Sonar unaligned;
+    StageTimer view_display("decode_display", device, "view");
+    for (size_t i = 0; i < payloads.size(); i++) {
+        view_display.start();
+        SonarView view;
+        view.parse(&payloads[i][0], payloads[i].size());
+        if (view.aligned) {
+            view_projector->project(view);
+        }
+        else {
+            view.copy_to(unaligned);
+            view_projector->project(unaligned);
+        }
+        view_display.stop(payloads[i].size());
+    }
+    results.push_back(summarize(view_display));
+}
+
+void bench_denoise(const std::vector<base::samples::Sonar>& pings, const std::string& device,
+                   sparse_bins::Isa isa, std::vector<Result>& results) {
+    if (!sparse_bins::isa_supported(isa)) return;
+
+    RlsDenoiser denoiser(4);
+    denoiser.set_isa(isa);
+
+    StageTimer timer("denoise", device, std::string("rls_") + sparse_bins::isa_name(isa));
+    for (size_t i = 0; i < pings.size(); i++) {
+        timer.start();
+        denoiser.apply(pings[i].bins);
+        timer.stop(pings[i].bins.size());
+    }
+    results.push_back(summarize(timer));
+}
+
+void bench_projection(const std::vector<base::samples::Sonar>& pings, std::vector<Result>& results) {
+    CartesianProjection projection;
+    StageTimer timer("projection", "multibeam", "cartesian_table");
+
+    for (size_t i = 0; i < pings.size(); i++) {
+        timer.start();
+        const cv::Mat& cart = projection.project(pings[i]);
+        timer.stop(cart.total());
+    }
+
+    results.push_back(summarize(timer));
+
+    // the profile picked from the first ping (gemini for the synthetic multibeam)
+    std::auto_ptr<DeviceProjector> projector = DeviceProjector::create(pings[0]);
+    StageTimer profile("projection", "multibeam", std::string("profile_") + projector->name());
+
+    for (size_t i = 0; i < pings.size(); i++) {
+        profile.start();
+        cv::Rect changed = projector->project(pings[i]);
+        profile.stop(changed.area());
+    }
+
+    results.push_back(summarize(profile));
+}
+
+/* projects every ping and returns the last canvas */
+cv::Mat bench_scanning_holder(const std::vector<base::samples::Sonar>& pings, int size, std::vector<Result>& results) {
+    ScanningHolder holder(size, size, base::Angle::fromDeg(-45.0), base::Angle::fromDeg(45.0));
+    StageTimer timer("projection", "scanning", "scanning_holder");
+
+    for (size_t i = 0; i < pings.size(); i++) {
+        timer.start();
+        holder.update(pings[i]);
+        timer.stop(pings[i].bins.size());
+    }
+
+    results.push_back(summarize(timer));
+
+    return holder.getCartImage().clone();
+}
+
+/* the same pings on a canvas sized after their range, at most size pixels */
+void bench_scanning_canvas(const std::vector<base::samples::Sonar>& pings, int size, std::vector<Result>& results) {
+    ScanningCanvas canvas(base::Angle::fromDeg(45.0), base::Angle::fromDeg(-45.0), size);
+    StageTimer timer("projection", "scanning", "scanning_canvas");
+
+    for (size_t i = 0; i < pings.size(); i++) {
+        timer.start();
+        cv::Rect changed = canvas.update(pings[i]);
+        timer.stop(changed.area());
+    }
+
+    results.push_back(summarize(timer));
+}
+
+void bench_symmetric_removal(const cv::Mat& frame, size_t iterations, std::vector<Result>& results) {
+    StageTimer reference("symmetric_removal", "scanning", "reference");
+    for (size_t i = 0; i < iterations; i++) {
+        reference.start();
+        detection::removeSymmetricData(frame);
+        reference.stop(frame.total());
+    }
+    results.push_back(summarize(reference));
+
+    SymmetricRemoval symmetric;
+    cv::Mat dst;
+    StageTimer fused("symmetric_removal", "scanning", "fused");
+    for (size_t i = 0; i < iterations; i++) {
+        fused.start();
+        symmetric.apply(frame, dst);
+        fused.stop(frame.total());
+    }
+    results.push_back(summarize(fused));
+}
+
+void bench_roi(const cv::Mat& frame, const base::samples::Sonar& sample, size_t iterations, std::vector<Result>& results) {
+    StageTimer extract("roi", "scanning", "extract_roi");
+    cv::Mat dst;
+    for (size_t i = 0; i < iterations; i++) {
+        extract.start();
+        detection::extractRoi(frame, dst, 1, 7, sample);
+        extract.stop(frame.rows);
+    }
+    results.push_back(summarize(extract));
+
+    StageTimer cached("roi", "scanning", "range_roi");
+    RangeRoi range_roi(1, 7);
+    for (size_t i = 0; i < iterations; i++) {
+        cached.start();
+        range_roi.update(sample, frame.size());
+        dst = frame(range_roi.rect());
+        cached.stop(frame.rows);
+    }
+    results.push_back(summarize(cached));
+}
+
+cv::Mat bench_threshold_morphology(const cv::Mat& frame, size_t iterations, std::vector<Result>& results) {
+    cv::Mat kernel = cv::getStructuringElement(cv::MORPH_ELLIPSE, cv::Size(5, 5));
+    cv::Mat thresh, opened;
+
+    StageTimer timer("threshold_morphology", "scanning", "opencv");
+    for (size_t i = 0; i < iterations; i++) {
+        timer.start();
+        cv::threshold(frame, thresh, 0.1, 1.0, CV_THRESH_BINARY);
+        cv::morphologyEx(thresh, opened, cv::MORPH_OPEN, kernel, cv::Point(-1, -1), 2);
+        timer.stop(frame.total());
+    }
+    results.push_back(summarize(timer));
+
+    BitMask::Kernel bit_kernel = BitMask::kernel(kernel);
+    BitMask bits, bits_opened, work;
+    StageTimer bit_timer("threshold_morphology", "scanning", "bitmask");
+    for (size_t i = 0; i < iterations; i++) {
+        bit_timer.start();
+        bits.threshold(frame, 0.1f);
+        BitMask::open(bits, bits_opened, bit_kernel, 2, work);
+        bit_timer.stop(frame.total());
+    }
+    results.push_back(summarize(bit_timer));
+
+    return opened;
+}
+
+void bench_blob(const cv::Mat& binary, size_t iterations, std::vector<Result>& results) {
+    FramePool pool;
+    detection::Target target;
+
+    StageTimer timer("blob", "scanning", "find_biggest_blob");
+    for (size_t i = 0; i < iterations; i++) {
+        timer.start();
+        detection::findBiggestBlob(binary, 100, 20, target, pool);
+        timer.stop();
+    }
+    results.push_back(summarize(timer));
+
+    // the first update searches the whole frame, the others the gated window
+    BlobTracker tracker;
+    tracker.update(binary, 20);
+    StageTimer tracked("blob", "scanning", "blob_tracker");
+    for (size_t i = 0; i < iterations; i++) {
+        tracked.start();
+        tracker.update(binary, 20);
+        tracked.stop();
+    }
+    results.push_back(summarize(tracked));
+}
+
+void bench_world_point(cv::Size size, size_t iterations, std::vector<Result>& results) {
+    const size_t points = 1000;
+    base::Vector2d sum(0, 0);
+
+    StageTimer timer("world_point", "scanning", "get_world_point");
+    for (size_t i = 0; i < iterations; i++) {
+        timer.start();
+        for (size_t j = 0; j < points; j++) {
+            cv::Point2f p(j % size.width, (j * 7) % size.height);
+            sum += detection::getWorldPoint(p, size, 20);
+        }
+        timer.stop(points);
+    }
+    results.push_back(summarize(timer));
+
+    // keeps the loop from being optimized away
+    if (sum.norm() < 0) std::cerr << sum << std::endl;
+}
+
+/* the whole SSIV pipeline on the Cartesian canvas against the polar detector on the sweep */
+void bench_detectors(const std::vector<base::samples::Sonar>& pings, const cv::Mat& canvas,
+                     size_t iterations, std::vector<Result>& results) {
+    SsivDetector ssiv;
+    StageTimer cartesian("detector", "scanning", "ssiv_cartesian");
+    for (size_t i = 0; i < iterations; i++) {
+        cartesian.start();
+        ssiv.process(canvas, pings.back());
+        cartesian.stop();
+    }
+    results.push_back(summarize(cartesian));
+
+    base::Angle limit = base::Angle::fromDeg(45);
+    PolarSweep sweep(limit, base::Angle::fromRad(-limit.getRad()), base::Angle::fromDeg(1.8));
+    for (size_t i = 0; i < pings.size(); i++) sweep.update(pings[i]);
+
+    PolarDetector detector;
+    StageTimer polar("detector", "scanning", "polar");
+    for (size_t i = 0; i < iterations; i++) {
+        polar.start();
+        detector.process(sweep);
+        polar.stop();
+    }
+    results.push_back(summarize(polar));
+}
+
+/* a 16 point SSIV sweep on one canvas, on one thread and on every core */
+void bench_sweep(const std::vector<base::samples::Sonar>& pings, const cv::Mat& canvas,
+                 size_t iterations, std::vector<Result>& results) {
+    std::vector<SsivParameters> configs = ParameterSweep::parse("threshold=0.05,0.1,0.15,0.2;morph_size=3,5;min_contour=50,100");
+    const size_t jobs[] = { 1, 0 };
+    const char *variants[] = { "serial", "parallel" };
+
+    for (size_t j = 0; j < 2; j++) {
+        ParameterSweep sweep(configs, jobs[j]);
+        StageTimer timer("sweep", "scanning", variants[j]);
+        for (size_t i = 0; i < iterations; i++) {
+            timer.start();
+            sweep.process(canvas, pings.back(), cv::Rect(0, 0, canvas.cols, canvas.rows));
+            timer.stop(configs.size());
+        }
+        results.push_back(summarize(timer));
+    }
+}
+
+/* cost of one ScopedLatency, to compare with the per-ping time of the stages it wraps */
+void bench_metrics(size_t iterations, std::vector<Result>& results) {
+    const size_t records = 1000;
+    Metrics metrics;
+    size_t stage = metrics.add_stage("bench");
+
+    StageTimer timer("metrics", "none", "scoped_latency");
+    for (size_t i = 0; i < iterations; i++) {
+        timer.start();
+        for (size_t j = 0; j < records; j++) {
+            ScopedLatency latency(metrics, stage);
+        }
+        timer.stop(records);
+    }
+    results.push_back(summarize(timer));
+}
+
+/* per-ping cost of the detection output: a CSV line on a stream, or a push to the writer thread */
+void bench_detection_output(size_t iterations, std::vector<Result>& results) {
+    const size_t records = 1000;
+
+    detection::TimedTarget detection;
+    detection.target.valid = true;
+    detection.target.bbox = cv::Rect(380, 200, 30, 12);
+    detection.target.position = base::Vector2d(4.9, 0.8);
+
+    std::ostringstream out;
+    StageTimer ostream("detection_output", "none", "ostream_csv");
+    for (size_t i = 0; i < iterations; i++) {
+        ostream.start();
+        for (size_t j = 0; j < records; j++) {
+            out << detection.time.toMicroseconds() << "," << detection.ping << ","
+                << detection.target.bbox.x << "," << detection.target.bbox.y << ","
+                << detection.target.position.x() << "," << detection.target.position.y() << std::endl;
+        }
+        ostream.stop(records);
+        out.str("");
+    }
+    results.push_back(summarize(ostream));
+
+    std::string path = (boost::filesystem::temp_directory_path() / "bench_detections.bin").string();
+    DetectionWriter writer(path, DetectionEncoder::BINARY, std::vector<std::string>(1, "bench"));
+    StageTimer async("detection_output", "none", "async_binary");
+    for (size_t i = 0; i < iterations; i++) {
+        async.start();
+        for (size_t j = 0; j < records; j++) writer.push(detection);
+        async.stop(records);
+    }
+    writer.close();
+    boost::filesystem::remove(path);
+    results.push_back(summarize(async));
+}
+
+}
+
+int main(int argc, char const *argv[]) {
+    namespace po = boost::program_options;
+
+    po::options_description desc("benchmark the obstacle detection stages on synthetic sonar data");
+
+    desc.add_options()
+        ("pings", po::value<size_t>()->default_value(200), "the number of synthetic pings of each device")
+        ("iterations", po::value<size_t>()->default_value(100), "the repetitions of each image stage")
+        ("bins", po::value<uint32_t>(), "the bins per beam of both devices")
+        ("beams", po::value<uint32_t>(), "the beams of the multibeam device")
+        ("speckle", po::value<float>(), "the fraction of bins with speckle noise")
+        ("canvas", po::value<int>()->default_value(800), "the size of the scanning sonar canvas")
+        ("format", po::value<std::string>()->default_value("csv"), "the output format (csv or json)")
+        ("help,h", "show the command line description");
+
+    po::variables_map vm;
+
+    try {
+        po::store(po::parse_command_line(argc, argv, desc), vm);
+        po::notify(vm);
+    } catch (std::exception& e) {
+        std::cerr << "ERROR: " << e.what() << std::endl;
+        return 1;
+    }
+
+    if (vm.count("help")) {
+        std::cout << desc << std::endl;
+        return 0;
+    }
+
+    std::string format = vm["format"].as<std::string>();
+    if (format != "csv" && format != "json") {
+        std::cerr << "ERROR: unknown format " << format << std::endl;
+        return 1;
+    }
+
+    SyntheticSonarConfig multibeam = SyntheticSonarConfig::multibeam();
+    SyntheticSonarConfig scanning = SyntheticSonarConfig::scanning();
+
+    if (vm.count("bins")) multibeam.bin_count = scanning.bin_count = vm["bins"].as<uint32_t>();
+    if (vm.count("beams")) multibeam.beam_count = vm["beams"].as<uint32_t>();
+    if (vm.count("speckle")) multibeam.speckle_density = scanning.speckle_density = vm["speckle"].as<float>();
+
+    size_t pings = vm["pings"].as<size_t>();
+    size_t iterations = vm["iterations"].as<size_t>();
+
+    std::vector<base::samples::Sonar> multibeam_pings = generate(multibeam, pings);
+    std::vector<base::samples::Sonar> scanning_pings = generate(scanning, pings);
+
+    std::vector<Result> results;
+
+    bench_decode(multibeam_pings, "multibeam", results);
+    bench_decode(scanning_pings, "scanning", results);
+
+    bench_sparse_filter(multibeam_pings, "multibeam", SparseBinFilter::TEMPORAL, results);
+    bench_sparse_filter(multibeam_pings, "multibeam", SparseBinFilter::SPATIO_TEMPORAL, results);
+    bench_sparse_filter(scanning_pings, "scanning", SparseBinFilter::TEMPORAL, results);
+    bench_sparse_filter(scanning_pings, "scanning", SparseBinFilter::SPATIO_TEMPORAL, results);
+
+    bench_denoise(multibeam_pings, "multibeam", sparse_bins::ISA_SCALAR, results);
+    bench_denoise(multibeam_pings, "multibeam", sparse_bins::best_isa(), results);
+
+    bench_projection(multibeam_pings, results);
+    cv::Mat canvas = bench_scanning_holder(scanning_pings, vm["canvas"].as<int>(), results);
+    bench_scanning_canvas(scanning_pings, vm["canvas"].as<int>(), results);
+    cv::Mat frame = canvas(cv::Rect(0, 0, canvas.cols, canvas.rows * 0.5));
+
+    cv::Mat blurred;
+    cv::blur(frame, blurred, cv::Size(3, 3));
+
+    bench_symmetric_removal(blurred, iterations, results);
+    bench_roi(blurred, scanning_pings.back(), iterations, results);
+    cv::Mat binary = bench_threshold_morphology(blurred, iterations, results);
+    bench_blob(binary, iterations, results);
+    bench_world_point(binary.size(), iterations, results);
+    bench_detectors(scanning_pings, canvas, iterations, results);
+    bench_sweep(scanning_pings, canvas, iterations, results);
+    bench_metrics(iterations, results);
+    bench_detection_output(iterations, results);
+
+    if (format == "json") write_json(std::cout, results);
+    else write_csv(std::cout, results);
+
+    return 0;
+}
@@ -0,0 +1,55 @@
+#include <iostream>
+#include <iomanip>
+#include <cstdlib>
+#include <vector>
+#include <base/Time.hpp>
+#include "sonarlog_obstacle_detection/SparseBinKernel.hpp"
+
+using namespace sonarlog_obstacle_detection;
+
+std::vector<float> random_bins(size_t size) {
+    std::vector<float> bins(size);
+    for (size_t i = 0; i < size; i++) {
+        bins[i] = (rand() % 100 < 30) ? (rand() % 1000 + 1) / 1000.0f : 0;
+    }
+    return bins;
+}
+
+double bins_per_second(void (*kernel)(float*, const float*, const float*, size_t, sparse_bins::Isa),
+                       sparse_bins::Isa isa, size_t bin_count, size_t iterations) {
+    std::vector<float> last = random_bins(bin_count);
+    std::vector<float> current = random_bins(bin_count);
+    std::vector<float> next = random_bins(bin_count);
+    std::vector<float> work(bin_count);
+
+    base::Time elapsed;
+    for (size_t i = 0; i < iterations; i++) {
+        work = current;
+        base::Time start = base::Time::now();
+        kernel(&work[0], &last[0], &next[0], bin_count, isa);
+        elapsed = elapsed + (base::Time::now() - start);
+    }
+
+    return (bin_count * iterations) / elapsed.toSeconds();
+}
+
+int main(int argc, char const *argv[]) {
+    size_t bin_count = (argc >= 2) ? atoi(argv[1]) : 256 * 1500;
+    size_t iterations = (argc >= 3) ? atoi(argv[2]) : 200;
+
+    const sparse_bins::Isa isas[] = { sparse_bins::ISA_SCALAR, sparse_bins::ISA_SSE2, sparse_bins::ISA_AVX2 };
+
+    std::cout << "bins per ping: " << bin_count << ", iterations: " << iterations << std::endl;
+    for (size_t i = 0; i < sizeof(isas) / sizeof(sparse_bins::Isa); i++) {
+        if (!sparse_bins::isa_supported(isas[i])) continue;
+
+        double temporal = bins_per_second(sparse_bins::remove_temporal, isas[i], bin_count, iterations);
+        double spatio_temporal = bins_per_second(sparse_bins::remove_spatio_temporal, isas[i], bin_count, iterations);
+
+        std::cout << std::setw(8) << sparse_bins::isa_name(isas[i])
+                  << "  temporal: " << std::setw(10) << std::fixed << std::setprecision(1) << temporal / 1e6 << " Mbins/s"
+                  << "  spatio-temporal: " << std::setw(10) << spatio_temporal / 1e6 << " Mbins/s" << std::endl;
+    }
+
+    return 0;
+}
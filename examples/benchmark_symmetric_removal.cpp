@@ -0,0 +1,52 @@
+#include <iostream>
+#include <iomanip>
+#include <cstdlib>
+#include <base/Time.hpp>
+#include <opencv2/opencv.hpp>
+#include "sonarlog_obstacle_detection/Detection.hpp"
+#include "sonarlog_obstacle_detection/SymmetricRemoval.hpp"
+
+using namespace sonarlog_obstacle_detection;
+
+int main(int argc, char const *argv[]) {
+    int width = (argc >= 2) ? atoi(argv[1]) : 800;
+    int height = (argc >= 3) ? atoi(argv[2]) : 400;
+    size_t iterations = (argc >= 4) ? atoi(argv[3]) : 200;
+
+    // sparse speckle with a mirrored pair of blobs
+    cv::Mat src = cv::Mat::zeros(height, width, CV_32FC1);
+    for (int y = 0; y < height; y++) {
+        for (int x = 0; x < width; x++) {
+            if (rand() % 100 < 20) src.at<float>(y, x) = (rand() % 1000) / 1000.0f;
+        }
+    }
+    cv::circle(src, cv::Point(width / 4, height / 2), height / 10, cv::Scalar(0.7), -1);
+    cv::circle(src, cv::Point(3 * width / 4, height / 2), height / 10, cv::Scalar(0.7), -1);
+
+    base::Time reference_time;
+    cv::Mat reference;
+    for (size_t i = 0; i < iterations; i++) {
+        base::Time start = base::Time::now();
+        reference = detection::removeSymmetricData(src);
+        reference_time = reference_time + (base::Time::now() - start);
+    }
+
+    SymmetricRemoval symmetric;
+    base::Time fused_time;
+    cv::Mat fused;
+    for (size_t i = 0; i < iterations; i++) {
+        base::Time start = base::Time::now();
+        symmetric.apply(src, fused);
+        fused_time = fused_time + (base::Time::now() - start);
+    }
+
+    double max_error = cv::norm(reference, fused, cv::NORM_INF);
+
+    std::cout << std::fixed << std::setprecision(3)
+              << "frame: " << width << "x" << height << ", iterations: " << iterations << std::endl
+              << "removeSymmetricData: " << reference_time.toSeconds() * 1000 / iterations << " ms/frame" << std::endl
+              << "SymmetricRemoval:    " << fused_time.toSeconds() * 1000 / iterations << " ms/frame" << std::endl
+              << "max abs difference:  " << std::scientific << max_error << std::endl;
+
+    return (max_error < 1e-6) ? 0 : 1;
+}
@@ -5,18 +5,13 @@
 #include "rock_util/LogReader.hpp"
 #include "rock_util/SonarSampleConverter.hpp"
 #include "rock_util/Utilities.hpp"
-#include "sonar_processing/SonarHolder.hpp"
+#include "sonarlog_obstacle_detection/CartesianProjection.hpp"
+#include "sonarlog_obstacle_detection/Display.hpp"
+#include "sonarlog_obstacle_detection/Throughput.hpp"
 #include "sonar_util/Converter.hpp"
 
 using namespace sonar_processing;
-
-inline void load_sonar_holder(const base::samples::Sonar& sample, sonar_processing::SonarHolder& sonar_holder) {
-    sonar_holder.Reset(sample.bins,
-        rock_util::Utilities::get_radians(sample.bearings),
-        sample.beam_width.getRad(),
-        sample.bin_count,
-        sample.beam_count);
-}
+using namespace sonarlog_obstacle_detection;
 
 int main(int argc, char const *argv[]) {
 
@@ -25,7 +20,7 @@ int main(int argc, char const *argv[]) {
     };
 
     uint num_logfiles = sizeof(logfiles) / sizeof(std::string);
-    sonar_processing::SonarHolder sonar_holder;
+    CartesianProjection projection;
 
     for (size_t i = 0; i < num_logfiles; i++) {
         rock_util::LogReader reader(logfiles[i]);
@@ -34,14 +29,21 @@ int main(int argc, char const *argv[]) {
         base::samples::Sonar sample;
         std::vector<cv::Mat> last_covar_matrices;
 
+        Throughput throughput;
+        throughput.start();
+
         while (stream.current_sample_index() < stream.total_samples()) {
             stream.next<base::samples::Sonar>(sample);
-            load_sonar_holder(sample, sonar_holder);
+            throughput.add(sample);
 
             /* current frame */
-            cv::Mat cart_raw = sonar_holder.cart_image();
-            cv::imshow("cart_raw", cart_raw);
-            cv::waitKey(30);
+            const cv::Mat& cart_raw = projection.project(sample);
+            display::show("cart_raw", cart_raw);
+            display::wait(30);
         }
+
+        throughput.stop();
+        std::cout << "throughput: " << throughput << std::endl;
+        std::cout << "projection tables: " << projection.misses() << " built, " << projection.hits() << " reused" << std::endl;
     }
 }
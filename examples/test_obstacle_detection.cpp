@@ -1,5 +1,4 @@
 #include <iostream>
-#include <deque>
 #include <base/samples/Sonar.hpp>
 #include "base/MathUtil.hpp"
 #include "base/test_config.h"
@@ -8,8 +7,12 @@
 #include "rock_util/Utilities.hpp"
 #include "sonar_util/Converter.hpp"
 #include "sonar_processing/ScanningHolder.hpp"
+#include "sonarlog_obstacle_detection/Display.hpp"
+#include "sonarlog_obstacle_detection/SparseBinFilter.hpp"
+#include "sonarlog_obstacle_detection/Throughput.hpp"
 
 using namespace sonar_processing;
+using namespace sonarlog_obstacle_detection;
 
 cv::Mat getSymmetricData(const cv::Mat& src) {
     cv::Mat left  = src(cv::Rect(0, 0, src.cols * 0.5, src.rows));
@@ -30,29 +33,6 @@ cv::Mat getSymmetricData(const cv::Mat& src) {
     return dst;
 }
 
-void removeSparsenessBins(std::deque<base::samples::Sonar>& window, const base::samples::Sonar& sample) {
-    if(window.empty() || (window.front().bin_count != sample.bin_count)) {
-        window.clear();
-    }
-
-    window.push_front(sample);
-
-    if (window.size() == 3) {
-        base::samples::Sonar last    = window.at(0);
-        base::samples::Sonar current = window.at(1);
-        base::samples::Sonar next    = window.at(2);
-
-        for (size_t i = 0; i < current.bin_count; i++) {
-            if(current.bins[i] && !last.bins[i] && !next.bins[i]) {
-                current.bins[i] = 0;
-            }
-        }
-
-        window.erase(window.begin() + 1);
-        window.insert(window.begin() + 1, current);
-    }
-}
-
 int main(int argc, char const *argv[]) {
 
     const std::string logfiles[] = {
@@ -70,25 +50,24 @@ int main(int argc, char const *argv[]) {
         base::samples::Sonar sample;
         ScanningHolder holder1(600, 600);
         ScanningHolder holder2(600, 600);
-        std::deque<base::samples::Sonar> window;
+        SparseBinFilter sparse_filter;
+
+        Throughput throughput;
+        throughput.start();
 
         while (stream.current_sample_index() < stream.total_samples()) {
             stream.next<base::samples::Sonar>(sample);
+            throughput.add(sample);
 
             // update scanning holder
             holder1.update(sample);
             cv::Mat cart_raw = holder1.getCartImage();
 
             // remove sparseness bins
-            removeSparsenessBins(window, sample);
-
-            if (window.size() == 3) {
-                base::samples::Sonar processed = window.back();
-                window.pop_back();
-
-                holder2.update(processed);
+            if (sparse_filter.push(sample)) {
+                holder2.update(sparse_filter.output());
                 cv::Mat cart_processed = holder2.getCartImage();
-                cv::imshow("cart_processed", cart_processed);
+                display::show("cart_processed", cart_processed);
             }
 
 
@@ -101,13 +80,19 @@ int main(int argc, char const *argv[]) {
             // cart_out.setTo(0, cart_out < 0);
 
             // output
-            cv::imshow("cart_raw", cart_raw);
-            // cv::imshow("cart_sym", cart_sym);
-            // cv::imshow("cart_out", cart_out);
-            std::cout << "========== IDX   : " << stream.current_sample_index() << std::endl;
-            std::cout << "========== BINS  : " << sample.bin_count << std::endl;
-            std::cout << "========== RANGE : " << (sample.bin_count * 0.05) << "m" << std::endl;
-            cv::waitKey(5);
+            display::show("cart_raw", cart_raw);
+            // display::show("cart_sym", cart_sym);
+            // display::show("cart_out", cart_out);
+            // the per-ping trace goes with the windows, out of the throughput runs
+            if (display::enabled()) {
+                std::cout << "========== IDX   : " << stream.current_sample_index() << std::endl;
+                std::cout << "========== BINS  : " << sample.bin_count << std::endl;
+                std::cout << "========== RANGE : " << (sample.bin_count * 0.05) << "m" << std::endl;
+            }
+            display::wait(5);
         }
+
+        throughput.stop();
+        std::cout << "throughput: " << throughput << std::endl;
     }
 }
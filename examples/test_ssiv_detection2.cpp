@@ -1,5 +1,4 @@
 #include <iostream>
-#include <deque>
 #include <base/samples/Sonar.hpp>
 #include "base/test_config.h"
 #include "rock_util/LogReader.hpp"
@@ -7,30 +6,12 @@
 #include "rock_util/Utilities.hpp"
 #include "sonar_util/Converter.hpp"
 #include "sonar_processing/ScanningHolder.hpp"
+#include "sonarlog_obstacle_detection/Display.hpp"
+#include "sonarlog_obstacle_detection/SparseBinFilter.hpp"
+#include "sonarlog_obstacle_detection/Throughput.hpp"
 
 using namespace sonar_processing;
-
-void removeSparsenessBins(std::deque<base::samples::Sonar>& window, const base::samples::Sonar& sample) {
-    if(window.empty() || (window.front().bin_count != sample.bin_count))
-        window.clear();
-
-    window.push_front(sample);
-
-    if (window.size() == 3) {
-        base::samples::Sonar last    = window.at(0);
-        base::samples::Sonar current = window.at(1);
-        base::samples::Sonar next    = window.at(2);
-
-        for (size_t i = 0; i < current.bin_count; i++) {
-            if(current.bins[i] && !last.bins[i] && !next.bins[i]) {
-                current.bins[i] = 0;
-            }
-        }
-
-        window.erase(window.begin() + 1);
-        window.insert(window.begin() + 1, current);
-    }
-}
+using namespace sonarlog_obstacle_detection;
 
 
 int main(int argc, char const *argv[]) {
@@ -52,10 +33,14 @@ int main(int argc, char const *argv[]) {
         base::Angle right_limit = base::Angle::fromDeg( 45.0);
         ScanningHolder holder1(600, 600, left_limit, right_limit);
         ScanningHolder holder2(600, 600, left_limit, right_limit);
-        std::deque<base::samples::Sonar> window;
+        SparseBinFilter sparse_filter;
+
+        Throughput throughput;
+        throughput.start();
 
         while (stream.current_sample_index() < stream.total_samples()) {
             stream.next<base::samples::Sonar>(sample);
+            throughput.add(sample);
 
             // update scanning holder
             holder1.update(sample);
@@ -63,24 +48,25 @@ int main(int argc, char const *argv[]) {
             cart_raw = cart_raw(cv::Rect(0, 0, cart_raw.cols, cart_raw.rows * 0.5));
 
             // remove sparseness bins
-            removeSparsenessBins(window, sample);
-            if (window.size() == 3) {
-                base::samples::Sonar processed = window.back();
-                window.pop_back();
-
-                holder2.update(processed);
+            if (sparse_filter.push(sample)) {
+                holder2.update(sparse_filter.output());
                 cv::Mat cart_processed = holder2.getCartImage();
                 cart_processed = cart_processed(cv::Rect(0, 0, cart_processed.cols, cart_processed.rows * 0.5));
-                cv::imshow("cart_processed", cart_processed);
+                display::show("cart_processed", cart_processed);
             }
 
             // output
-            cv::imshow("cart_raw", cart_raw);
-            std::cout   << "===== [IDX, BINS, RANGE] : ["
-                        << stream.current_sample_index() << ", "
-                        << sample.bin_count << ", "
-                        << sample.getBinStartDistance(sample.bin_count) << "m]" << std::endl;
-            cv::waitKey();
+            display::show("cart_raw", cart_raw);
+            if (display::enabled()) {
+                std::cout   << "===== [IDX, BINS, RANGE] : ["
+                            << stream.current_sample_index() << ", "
+                            << sample.bin_count << ", "
+                            << sample.getBinStartDistance(sample.bin_count) << "m]" << std::endl;
+            }
+            display::wait();
         }
+
+        throughput.stop();
+        std::cout << "throughput: " << throughput << std::endl;
     }
 }
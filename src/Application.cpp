@@ -1,15 +1,8 @@
+#include <algorithm>
 #include <opencv2/opencv.hpp>
-#include <base/samples/Sonar.hpp>
-#include "base/MathUtil.hpp"
-#include "sonar_util/Converter.hpp"
-#include "rock_util/SonarSampleConverter.hpp"
-#include "rock_util/Utilities.hpp"
+#include <boost/bind.hpp>
+#include <boost/thread/thread.hpp>
 #include "sonarlog_obstacle_detection/Application.hpp"
-#include "sonar_processing/ImageUtil.hpp"
-#include "sonar_processing/Preprocessing.hpp"
-#include "sonar_processing/QualityMetrics.hpp"
-
-using namespace sonar_processing;
 
 namespace sonarlog_obstacle_detection {
 
@@ -22,26 +15,149 @@ Application*  Application::instance() {
     return instance_;
 }
 
-void Application::init(const std::string& filename, const std::string& stream_name) {
-    reader_.reset(new rock_util::LogReader(filename));
-    plot_.reset(new base::Plot());
-    stream_ = reader_->stream(stream_name);
+void Application::init(const std::vector<std::string>& filenames, const std::vector<std::string>& stream_names) {
+    filenames_ = filenames;
+    stream_names_ = stream_names;
+    processors_.assign(filenames_.size(), boost::shared_ptr<LogProcessor>());
+    multi_processors_.assign(filenames_.size(), boost::shared_ptr<MultiStreamProcessor>());
+    errors_.assign(filenames_.size(), std::string());
+    next_file_ = 0;
 }
 
-void Application::process_next_sample() {
-    base::samples::Sonar sample;
-    stream_.next<base::samples::Sonar>(sample);
+void Application::process_logfiles() {
+    size_t jobs = (jobs_) ? jobs_ : boost::thread::hardware_concurrency();
+    jobs = std::max<size_t>(1, std::min(jobs, filenames_.size()));
+
+    Throughput total;
+    total.start();
+
+    if (jobs == 1) {
+        process_worker();
+    }
+    else {
+        boost::thread_group workers;
+        for (size_t i = 0; i < jobs; i++) {
+            workers.create_thread(boost::bind(&Application::process_worker, this));
+        }
+        workers.join_all();
+    }
+
+    total.stop();
+    print_summary(total);
+
+    display::wait();
 }
 
-void Application::process_logfile() {
-    rls.setWindow_size(4);
-    stream_.reset();
-    while (stream_.current_sample_index() < stream_.total_samples()) process_next_sample();
-    cv::waitKey();
+void Application::process_worker() {
+    for (;;) {
+        size_t index;
+        {
+            boost::mutex::scoped_lock lock(mutex_);
+            if (next_file_ >= filenames_.size()) return;
+            index = next_file_++;
+        }
+
+        try {
+            if (stream_names_.size() == 1) {
+                boost::shared_ptr<LogProcessor> processor(new LogProcessor(filenames_[index], stream_names_[0], options_));
+                processor->process_logfile();
+                processors_[index] = processor;
+            }
+            else {
+                boost::shared_ptr<MultiStreamProcessor> processor(new MultiStreamProcessor(filenames_[index], stream_names_, options_));
+                processor->process_logfile();
+                multi_processors_[index] = processor;
+            }
+        } catch (std::exception& e) {
+            errors_[index] = e.what();
+        }
+    }
 }
 
-void Application::plot(cv::Mat mat) {
-    (*plot_)(image_util::mat2vector<float>(mat));
+void Application::print_summary(const Throughput& total) const {
+    size_t pings = 0;
+    for (size_t i = 0; i < filenames_.size(); i++) {
+        std::cout << "input-file: " << filenames_[i] << std::endl;
+        if (processors_[i]) {
+            print_processor(*processors_[i]);
+            pings += processors_[i]->throughput().pings();
+        }
+        else if (multi_processors_[i]) {
+            const MultiStreamProcessor& processor = *multi_processors_[i];
+            std::cout << "throughput: " << processor.throughput() << std::endl;
+            std::cout << "decode: " << processor.decode_time().toSeconds() << "s, "
+                      << "reader blocked: " << processor.reader_wait().toSeconds() << "s, "
+                      << processor.detections().size() << " detections" << std::endl;
+            for (size_t j = 0; j < processor.stream_count(); j++) {
+                std::cout << "stream-name: " << processor.stream_names()[j] << std::endl;
+                print_processor(processor.processor(j));
+            }
+            pings += processor.throughput().pings();
+        }
+        else {
+            std::cout << "ERROR: " << errors_[i] << "\n" << std::endl;
+        }
+    }
+
+    std::cout << "total: " << pings << " pings from " << filenames_.size()
+              << " files in " << total.elapsed_seconds() << "s" << std::endl;
+
+    if (!options_.metrics_format.empty()) print_metrics();
+}
+
+void Application::print_processor(const LogProcessor& processor) const {
+    const SampleQueue::Timing& timing = processor.queue_timing();
+    std::cout << "throughput: " << processor.throughput() << std::endl;
+    if (timing.samples) {
+        std::cout << "decode: " << timing.decode.toSeconds() << "s, "
+                  << "hidden: " << timing.hidden().toSeconds() << "s, "
+                  << "processing stalled: " << timing.consumer_wait.toSeconds() << "s, "
+                  << "reader blocked: " << timing.reader_wait.toSeconds() << "s" << std::endl;
+    }
+    if (options_.denoise) {
+        std::cout << "denoise: " << processor.denoise_seconds() << "s ("
+                  << processor.denoise_bins_per_second() / 1e6 << " Mbins/s)" << std::endl;
+    }
+    if (const ParameterSweep *sweep = processor.sweep()) {
+        std::cout << "sweep: " << sweep->size() << " configurations on " << sweep->jobs() << " threads, "
+                  << sweep->pings() << " pings in " << processor.sweep_seconds() << "s" << std::endl;
+    }
+    if (options_.detect() && processor.detections_dropped()) {
+        std::cout << "detections: " << processor.detections_dropped() << " of "
+                  << processor.detections().size() << " dropped by the writer" << std::endl;
+    }
+    if (processor.detector()) {
+        const DeadlineScheduler& scheduler = processor.scheduler();
+        const DeadlineScheduler::Stats& stats = scheduler.stats();
+        std::cout << "realtime: " << scheduler.budget() * 1e3 << "ms budget ("
+                  << DeadlineScheduler::policy_name(scheduler.policy()) << "), "
+                  << stats.pings << " pings, " << stats.dropped << " dropped, "
+                  << stats.degraded << " degraded, " << stats.missed << " missed, "
+                  << "max latency: " << stats.max_latency * 1e3 << "ms" << std::endl;
+    }
+    std::cout << std::endl;
+}
+
+void Application::print_metrics() const {
+    std::cout << std::endl;
+    if (options_.metrics_format == "csv") Metrics::write_csv_header(std::cout);
+
+    for (size_t i = 0; i < filenames_.size(); i++) {
+        std::vector<const LogProcessor*> processors;
+        if (processors_[i]) processors.push_back(processors_[i].get());
+        if (multi_processors_[i]) {
+            for (size_t j = 0; j < multi_processors_[i]->stream_count(); j++) processors.push_back(&multi_processors_[i]->processor(j));
+        }
+
+        for (size_t j = 0; j < processors.size(); j++) {
+            // label the streams of a multi-stream file
+            std::string label = filenames_[i];
+            if (multi_processors_[i]) label += ":" + processors[j]->stream_name();
+
+            if (options_.metrics_format == "csv") processors[j]->metrics().write_csv(std::cout, label);
+            else processors[j]->metrics().write_json(std::cout, label);
+        }
+    }
 }
 
 }
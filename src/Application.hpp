@@ -3,44 +3,72 @@
 
 #include <iostream>
 #include <string>
-#include <deque>
-#include "rock_util/LogReader.hpp"
-#include "sonar_processing/Denoising.hpp"
-#include "base/Plot.hpp"
-
-using namespace sonar_processing;
+#include <vector>
+#include <boost/shared_ptr.hpp>
+#include <boost/thread/mutex.hpp>
+#include "sonarlog_obstacle_detection/Display.hpp"
+#include "sonarlog_obstacle_detection/LogProcessor.hpp"
+#include "sonarlog_obstacle_detection/MultiStreamProcessor.hpp"
 
 namespace sonarlog_obstacle_detection {
 
 class Application {
 public:
 
-    void init(const std::string& filename, const std::string& stream_name);
+    void init(const std::vector<std::string>& filenames, const std::vector<std::string>& stream_names);
+
+    void process_logfiles();
 
-    void process_logfile();
+    void set_options(const ProcessingOptions& options) {
+        options_ = options;
+        display::set_enabled(!options.headless);
+    }
 
-    void process_next_sample();
+    const ProcessingOptions& options() const {
+        return options_;
+    }
 
-    void plot(cv::Mat mat);
+    void set_jobs(size_t jobs) {
+        jobs_ = jobs;
+    }
 
-    base::Plot& plot() {
-        return *(plot_.get());
+    size_t jobs() const {
+        return jobs_;
     }
 
     static Application* instance();
 
 private:
 
-    Application() {}
+    Application()
+        : next_file_(0)
+        , jobs_(1) {
+    }
 
     ~Application() {}
 
-    std::auto_ptr<rock_util::LogReader> reader_;
-    rock_util::LogStream stream_;
-    denoising::RLS rls;
+    void process_worker();
+
+    void print_summary(const Throughput& total) const;
+
+    void print_processor(const LogProcessor& processor) const;
+
+    void print_metrics() const;
+
+    std::vector<std::string> filenames_;
+    std::vector<std::string> stream_names_;
+
+    // one stream per file uses processors_, several streams multi_processors_
+    std::vector<boost::shared_ptr<LogProcessor> > processors_;
+    std::vector<boost::shared_ptr<MultiStreamProcessor> > multi_processors_;
+    std::vector<std::string> errors_;
+    size_t next_file_;
+    boost::mutex mutex_;
+
+    ProcessingOptions options_;
+    size_t jobs_;
 
     static Application *instance_;
-    std::auto_ptr<base::Plot> plot_;
 };
 
 } /* namespace sonarlog_obstacle_detection */
@@ -10,7 +10,29 @@ namespace sonarlog_obstacle_detection {
 
 ArgumentParser::ArgumentParser()
     : input_files_()
-    , stream_name_("") {
+    , stream_names_()
+    , headless_(false)
+    , jobs_(1)
+    , queue_size_(4)
+    , mmap_(false)
+    , denoise_(false)
+    , denoise_window_(4)
+    , metrics_format_("")
+    , metrics_interval_(0)
+    , first_index_(0)
+    , last_index_(std::numeric_limits<size_t>::max())
+    , from_time_(0)
+    , to_time_(std::numeric_limits<double>::infinity())
+    , sweep_("")
+    , sweep_jobs_(0)
+    , sweep_output_(".")
+    , latency_budget_(0)
+    , realtime_policy_("drop")
+    , pixel_cost_(0)
+    , detections_output_("")
+    , detections_format_("csv")
+    , plot_every_(1)
+    , plot_rate_(0) {
 }
 
 ArgumentParser::~ArgumentParser() {
@@ -23,7 +45,31 @@ bool ArgumentParser::run(int argc, char const *argv[]) {
 
     desc.add_options()
         ("input-files,i", program_options::value<std::vector<std::string> >()->required(), "the input files path")
-        ("stream-name,s", program_options::value<std::string>()->default_value("sonar.sonar_scan_samples"), "the stream name")
+        ("stream-name,s", program_options::value<std::vector<std::string> >()->multitoken()
+            ->default_value(std::vector<std::string>(1, "sonar.sonar_scan_samples"), "sonar.sonar_scan_samples"),
+            "the stream names; several streams of a file are read in a single pass")
+        ("headless", "run without visualization and report the throughput of each input file")
+        ("jobs,j", program_options::value<size_t>()->default_value(1), "the number of input files processed concurrently (0 uses every core)")
+        ("queue-size", program_options::value<size_t>()->default_value(4), "the number of samples decoded ahead of the processing (0 decodes inline)")
+        ("mmap", "read uncompressed logs in place through a memory mapping (compressed logs and streams of another Sonar layout use the decoder)")
+        ("denoise", "filter every beam with the RLS denoiser over the earlier pings at its bearing before the detection")
+        ("denoise-window", program_options::value<unsigned int>()->default_value(4), "the number of pings weighted by the RLS denoiser")
+        ("metrics", program_options::value<std::string>(), "write the per-stage latency and counters of each input file (json or csv)")
+        ("metrics-interval", program_options::value<double>()->default_value(0), "seconds between metrics snapshots on stderr (0 disables them)")
+        ("first-index", program_options::value<size_t>(), "the first sample index processed")
+        ("last-index", program_options::value<size_t>(), "the last sample index processed")
+        ("from-time", program_options::value<double>(), "skip the samples recorded less than this many seconds after the first one")
+        ("to-time", program_options::value<double>(), "stop after the samples recorded this many seconds after the first one")
+        ("sweep", program_options::value<std::string>(), "evaluate a grid of SSIV parameters on every ping, e.g. \"threshold=0.05:0.2:0.05;morph_size=3,5\"")
+        ("sweep-jobs", program_options::value<size_t>()->default_value(0), "the number of threads running the sweep configurations (0 uses every core)")
+        ("sweep-output", program_options::value<std::string>()->default_value("."), "the directory of the sweep summary and tracks")
+        ("latency-budget", program_options::value<double>(), "run the SSIV detection in real-time mode with this per-ping latency budget (ms)")
+        ("realtime-policy", program_options::value<std::string>()->default_value("drop"), "what a late ping gives up in real-time mode (drop or degrade)")
+        ("pixel-cost", program_options::value<double>()->default_value(0), "the ns charged per processed pixel in real-time mode for a deterministic replay (0 uses the measured time)")
+        ("detections", program_options::value<std::string>(), "run the polar detector and write <log>.detections.<format>, merged by time over the streams, to this directory")
+        ("detections-format", program_options::value<std::string>()->default_value("csv"), "the encoding of the detections (csv, jsonl or binary)")
+        ("plot-every", program_options::value<size_t>()->default_value(1), "plot one frame out of this many")
+        ("plot-rate", program_options::value<double>()->default_value(0), "the maximum number of frames plotted per second (0 for no limit)")
         ("help,h", "show the command line description");
 
     program_options::positional_options_description pd;
@@ -51,7 +97,59 @@ bool ArgumentParser::run(int argc, char const *argv[]) {
             }
         }
 
-        stream_name_ = vm["stream-name"].as<std::string>();
+        stream_names_ = vm["stream-name"].as<std::vector<std::string> >();
+        headless_ = vm.count("headless") > 0;
+        jobs_ = vm["jobs"].as<size_t>();
+        queue_size_ = vm["queue-size"].as<size_t>();
+        mmap_ = vm.count("mmap") > 0;
+        denoise_ = vm.count("denoise") > 0;
+        denoise_window_ = vm["denoise-window"].as<unsigned int>();
+        metrics_interval_ = vm["metrics-interval"].as<double>();
+
+        if (vm.count("first-index")) first_index_ = vm["first-index"].as<size_t>();
+        if (vm.count("last-index")) last_index_ = vm["last-index"].as<size_t>();
+        if (vm.count("from-time")) from_time_ = vm["from-time"].as<double>();
+        if (vm.count("to-time")) to_time_ = vm["to-time"].as<double>();
+
+        if (vm.count("sweep")) sweep_ = vm["sweep"].as<std::string>();
+        sweep_jobs_ = vm["sweep-jobs"].as<size_t>();
+        sweep_output_ = vm["sweep-output"].as<std::string>();
+
+        if (vm.count("latency-budget")) latency_budget_ = vm["latency-budget"].as<double>() * 1e-3;
+        realtime_policy_ = vm["realtime-policy"].as<std::string>();
+        pixel_cost_ = vm["pixel-cost"].as<double>();
+        if (vm.count("detections")) detections_output_ = vm["detections"].as<std::string>();
+        detections_format_ = vm["detections-format"].as<std::string>();
+        plot_every_ = vm["plot-every"].as<size_t>();
+        plot_rate_ = vm["plot-rate"].as<double>();
+
+        if (realtime_policy_ != "drop" && realtime_policy_ != "degrade") {
+            std::cerr << "ERROR: realtime-policy must be drop or degrade" << std::endl;
+            return false;
+        }
+
+        if (detections_format_ != "csv" && detections_format_ != "jsonl" && detections_format_ != "binary") {
+            std::cerr << "ERROR: detections-format must be csv, jsonl or binary" << std::endl;
+            return false;
+        }
+
+        if (latency_budget_ > 0 && !sweep_.empty()) {
+            std::cerr << "ERROR: the sweep does not run in real-time mode" << std::endl;
+            return false;
+        }
+
+        if (first_index_ > last_index_ || from_time_ > to_time_) {
+            std::cerr << "ERROR: empty sample window" << std::endl;
+            return false;
+        }
+
+        if (vm.count("metrics")) {
+            metrics_format_ = vm["metrics"].as<std::string>();
+            if (metrics_format_ != "json" && metrics_format_ != "csv") {
+                std::cerr << "ERROR: metrics must be json or csv" << std::endl;
+                return false;
+            }
+        }
 
         program_options::notify(vm);
     } catch (boost::program_options::error& e) {
@@ -1,6 +1,7 @@
 #ifndef ArgumentParser_hpp
 #define ArgumentParser_hpp
 
+#include <limits>
 #include <string>
 #include <vector>
 
@@ -20,8 +21,101 @@ public:
         return app_name_;
     }
 
+    /* the first of stream_names() */
     std::string stream_name() const {
-        return stream_name_;
+        return stream_names_.empty() ? std::string() : stream_names_[0];
+    }
+
+    std::vector<std::string> stream_names() const {
+        return stream_names_;
+    }
+
+    bool headless() const {
+        return headless_;
+    }
+
+    size_t jobs() const {
+        return jobs_;
+    }
+
+    size_t queue_size() const {
+        return queue_size_;
+    }
+
+    bool mmap() const {
+        return mmap_;
+    }
+
+    bool denoise() const {
+        return denoise_;
+    }
+
+    unsigned int denoise_window() const {
+        return denoise_window_;
+    }
+
+    std::string metrics_format() const {
+        return metrics_format_;
+    }
+
+    double metrics_interval() const {
+        return metrics_interval_;
+    }
+
+    size_t first_index() const {
+        return first_index_;
+    }
+
+    size_t last_index() const {
+        return last_index_;
+    }
+
+    double from_time() const {
+        return from_time_;
+    }
+
+    double to_time() const {
+        return to_time_;
+    }
+
+    std::string sweep() const {
+        return sweep_;
+    }
+
+    size_t sweep_jobs() const {
+        return sweep_jobs_;
+    }
+
+    std::string sweep_output() const {
+        return sweep_output_;
+    }
+
+    double latency_budget() const {
+        return latency_budget_;
+    }
+
+    std::string realtime_policy() const {
+        return realtime_policy_;
+    }
+
+    double pixel_cost() const {
+        return pixel_cost_;
+    }
+
+    std::string detections_output() const {
+        return detections_output_;
+    }
+
+    std::string detections_format() const {
+        return detections_format_;
+    }
+
+    size_t plot_every() const {
+        return plot_every_;
+    }
+
+    double plot_rate() const {
+        return plot_rate_;
     }
 
     bool run(int argc, char const *argv[]);
@@ -32,8 +126,30 @@ private:
     std::string get_filename(std::string file_path);
 
     std::vector<std::string> input_files_;
-    std::string stream_name_;
+    std::vector<std::string> stream_names_;
     std::string app_name_;
+    bool headless_;
+    size_t jobs_;
+    size_t queue_size_;
+    bool mmap_;
+    bool denoise_;
+    unsigned int denoise_window_;
+    std::string metrics_format_;
+    double metrics_interval_;
+    size_t first_index_;
+    size_t last_index_;
+    double from_time_;
+    double to_time_;
+    std::string sweep_;
+    size_t sweep_jobs_;
+    std::string sweep_output_;
+    double latency_budget_;
+    std::string realtime_policy_;
+    double pixel_cost_;
+    std::string detections_output_;
+    std::string detections_format_;
+    size_t plot_every_;
+    double plot_rate_;
 
 };
 
@@ -0,0 +1,35 @@
+#include <cmath>
+#include <algorithm>
+#include "sonarlog_obstacle_detection/BeamDenoiser.hpp"
+
+namespace sonarlog_obstacle_detection {
+
+BeamDenoiser::BeamDenoiser(unsigned int window_size, base::Angle resolution)
+    : rls_(window_size)
+    , resolution_(resolution.getRad())
+    , slots_(std::max<long>(1, floor(2 * M_PI / resolution_ + 0.5))) {
+}
+
+void BeamDenoiser::reset() {
+    rls_.reset();
+}
+
+size_t BeamDenoiser::slot(double bearing) const {
+    // the nearest multiple of the resolution, whatever the turns of bearing
+    long index = (long)floor(bearing / resolution_ + 0.5) % (long)slots_;
+    return (index < 0) ? index + slots_ : index;
+}
+
+const base::samples::Sonar& BeamDenoiser::apply(const base::samples::Sonar& sample) {
+    output_ = sample;
+    if (sample.bins.empty()) return output_;
+
+    const float *estimate = (sample.beam_count > 1 || sample.bearings.empty()) ?
+        rls_.apply(0, 1, &sample.bins[0], sample.bins.size()) :
+        rls_.apply(slot(sample.bearings[0].getRad()), slots_, &sample.bins[0], sample.bins.size());
+
+    std::copy(estimate, estimate + sample.bins.size(), output_.bins.begin());
+    return output_;
+}
+
+} /* namespace sonarlog_obstacle_detection */
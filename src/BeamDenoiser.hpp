@@ -0,0 +1,56 @@
+#ifndef BeamDenoiser_hpp
+#define BeamDenoiser_hpp
+
+#include <cstddef>
+#include <base/Angle.hpp>
+#include <base/samples/Sonar.hpp>
+#include "sonarlog_obstacle_detection/RlsDenoiser.hpp"
+
+namespace sonarlog_obstacle_detection {
+
+/*
+ * RLS denoising of sonar pings on their bin x bearing grid, so that a bin
+ * is only filtered with the earlier echoes of the same place.
+ *
+ * A multibeam ping is one frame of all its beams. A single beam ping only
+ * updates the row of its bearing slot (the nearest multiple of resolution
+ * over the full circle): the consecutive bearings of a scan are never
+ * mixed, and each bearing is filtered over the sweeps that passed it. A change of the
+ * bin count, or of the kind of sonar, restarts every estimate.
+ */
+class BeamDenoiser {
+public:
+
+    BeamDenoiser(unsigned int window_size = 4, base::Angle resolution = base::Angle::fromDeg(1.8));
+
+    /* sample with its bins replaced by their estimate (the storage is reused by the next call) */
+    const base::samples::Sonar& apply(const base::samples::Sonar& sample);
+
+    const base::samples::Sonar& output() const {
+        return output_;
+    }
+
+    void reset();
+
+    /* slot of a single beam bearing (radians) */
+    size_t slot(double bearing) const;
+
+    size_t slots() const {
+        return slots_;
+    }
+
+    RlsDenoiser& rls() {
+        return rls_;
+    }
+
+private:
+
+    RlsDenoiser rls_;
+    double resolution_;
+    size_t slots_;
+    base::samples::Sonar output_;
+};
+
+} /* namespace sonarlog_obstacle_detection */
+
+#endif /* BeamDenoiser_hpp */
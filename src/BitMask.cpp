@@ -0,0 +1,240 @@
+#include <algorithm>
+#include "sonarlog_obstacle_detection/BitMask.hpp"
+
+namespace sonarlog_obstacle_detection {
+
+namespace {
+
+/* the words of a source row with the border value out of the image */
+class RowReader {
+public:
+
+    RowReader(const uint64_t *row, int words, uint64_t last_mask, bool border)
+        : row_(row)
+        , words_(words)
+        , last_mask_(last_mask)
+        , border_((border) ? ~0ULL : 0ULL) {
+    }
+
+    uint64_t word(int i) const {
+        if (i < 0 || i >= words_) return border_;
+        if (i == words_ - 1) return (row_[i] & last_mask_) | (border_ & ~last_mask_);
+        return row_[i];
+    }
+
+    /* word i of the row read at x + shift, for every x of that word */
+    uint64_t shifted(int i, int shift) const {
+        if (shift >= 0) {
+            int q = shift >> 6, r = shift & 63;
+            uint64_t lo = word(i + q);
+            return (r) ? (lo >> r) | (word(i + q + 1) << (64 - r)) : lo;
+        }
+
+        int t = -shift;
+        int q = t >> 6, r = t & 63;
+        uint64_t hi = word(i - q);
+        return (r) ? (hi << r) | (word(i - q - 1) >> (64 - r)) : hi;
+    }
+
+private:
+
+    const uint64_t *row_;
+    int words_;
+    uint64_t last_mask_;
+    uint64_t border_;
+};
+
+}
+
+void BitMask::create(int rows, int cols) {
+    rows_ = rows;
+    cols_ = cols;
+    words_per_row_ = (cols + 63) / 64;
+    words_.assign((size_t)rows_ * words_per_row_, 0);
+}
+
+void BitMask::clear() {
+    std::fill(words_.begin(), words_.end(), 0);
+}
+
+void BitMask::set(int y, int x, bool value) {
+    uint64_t bit = 1ULL << (x & 63);
+    uint64_t& word = row(y)[x >> 6];
+    word = (value) ? (word | bit) : (word & ~bit);
+}
+
+void BitMask::threshold(const cv::Mat& src, float threshold, int first_row, int end_row) {
+    CV_Assert(src.type() == CV_32FC1);
+    if (src.rows != rows_ || src.cols != cols_) create(src.rows, src.cols);
+
+    first_row = std::max(first_row, 0);
+    end_row = std::max(std::min(end_row, rows_), first_row);
+    std::fill(words_.begin(), words_.begin() + (size_t)first_row * words_per_row_, 0);
+    std::fill(words_.begin() + (size_t)end_row * words_per_row_, words_.end(), 0);
+
+    for (int y = first_row; y < end_row; y++) {
+        const float *s = src.ptr<float>(y);
+        uint64_t *words = row(y);
+
+        for (int i = 0; i < words_per_row_; i++) {
+            int x0 = i * 64;
+            int n = std::min(64, cols_ - x0);
+
+            uint64_t word = 0;
+            for (int b = 0; b < n; b++) word |= (uint64_t)(s[x0 + b] > threshold) << b;
+            words[i] = word;
+        }
+    }
+}
+
+void BitMask::copy_to(cv::Mat& dst, const cv::Rect& region, double value) const {
+    if (dst.type() != CV_8UC1) dst.create(region.height, region.width, CV_32FC1);
+    else dst.create(region.height, region.width, CV_8UC1);
+
+    for (int y = 0; y < region.height; y++) {
+        const uint64_t *words = row(region.y + y);
+
+        if (dst.type() == CV_8UC1) {
+            uchar *d = dst.ptr<uchar>(y);
+            uchar set = cv::saturate_cast<uchar>(value);
+            for (int x = 0; x < region.width; x++) {
+                int sx = region.x + x;
+                d[x] = ((words[sx >> 6] >> (sx & 63)) & 1) ? set : 0;
+            }
+        }
+        else {
+            float *d = dst.ptr<float>(y);
+            for (int x = 0; x < region.width; x++) {
+                int sx = region.x + x;
+                d[x] = ((words[sx >> 6] >> (sx & 63)) & 1) ? (float)value : 0.0f;
+            }
+        }
+    }
+}
+
+void BitMask::copy_to(BitMask& dst, const cv::Rect& region, const cv::Point& offset) const {
+    for (int y = 0; y < region.height; y++) {
+        const uint64_t *words = row(region.y + y);
+        for (int x = 0; x < region.width; x++) {
+            int sx = region.x + x;
+            dst.set(offset.y + y, offset.x + x, (words[sx >> 6] >> (sx & 63)) & 1);
+        }
+    }
+}
+
+size_t BitMask::count() const {
+    size_t total = 0;
+    for (size_t i = 0; i < words_.size(); i++) total += __builtin_popcountll(words_[i]);
+    return total;
+}
+
+cv::Rect BitMask::bounding_box() const {
+    int min_x = cols_, max_x = -1, min_y = rows_, max_y = -1;
+
+    for (int y = 0; y < rows_; y++) {
+        const uint64_t *words = row(y);
+
+        int first = 0;
+        while (first < words_per_row_ && !words[first]) first++;
+        if (first == words_per_row_) continue;
+
+        int last = words_per_row_ - 1;
+        while (!words[last]) last--;
+
+        min_x = std::min(min_x, first * 64 + __builtin_ctzll(words[first]));
+        max_x = std::max(max_x, last * 64 + 63 - __builtin_clzll(words[last]));
+        min_y = std::min(min_y, y);
+        max_y = y;
+    }
+
+    if (max_y < 0) return cv::Rect();
+    return cv::Rect(min_x, min_y, max_x - min_x + 1, max_y - min_y + 1);
+}
+
+BitMask::Kernel BitMask::kernel(const cv::Mat& element) {
+    CV_Assert(element.type() == CV_8UC1);
+
+    int ax = element.cols / 2, ay = element.rows / 2;
+
+    Kernel kernel;
+    for (int y = 0; y < element.rows; y++) {
+        const uchar *e = element.ptr<uchar>(y);
+
+        int begin = 0;
+        while (begin < element.cols && !e[begin]) begin++;
+        if (begin == element.cols) continue;
+
+        int end = element.cols - 1;
+        while (!e[end]) end--;
+
+        for (int x = begin; x <= end; x++) CV_Assert(e[x]);
+
+        Run run;
+        run.dy = y - ay;
+        run.begin = begin - ax;
+        run.end = end - ax;
+        kernel.push_back(run);
+    }
+
+    return kernel;
+}
+
+void BitMask::morphology(const BitMask& src, BitMask& dst, const Kernel& kernel, bool erode) {
+    CV_Assert(&src != &dst);
+    if (dst.rows_ != src.rows_ || dst.cols_ != src.cols_) dst.create(src.rows_, src.cols_);
+
+    const int words = src.words_per_row_;
+    const uint64_t last_mask = src.last_word_mask();
+
+    for (int y = 0; y < src.rows_; y++) {
+        uint64_t *out = dst.row(y);
+        std::fill(out, out + words, (erode) ? ~0ULL : 0ULL);
+
+        for (size_t k = 0; k < kernel.size(); k++) {
+            const Run& run = kernel[k];
+
+            // rows out of the image are the border value, neutral for both operations
+            int sy = y + run.dy;
+            if (sy < 0 || sy >= src.rows_) continue;
+
+            RowReader reader(src.row(sy), words, last_mask, erode);
+            for (int i = 0; i < words; i++) {
+                uint64_t value = out[i];
+                for (int dx = run.begin; dx <= run.end; dx++) {
+                    if (erode) value &= reader.shifted(i, dx);
+                    else value |= reader.shifted(i, dx);
+                }
+                out[i] = value;
+            }
+        }
+
+        if (words) out[words - 1] &= last_mask;
+    }
+}
+
+void BitMask::erode(const BitMask& src, BitMask& dst, const Kernel& kernel) {
+    morphology(src, dst, kernel, true);
+}
+
+void BitMask::dilate(const BitMask& src, BitMask& dst, const Kernel& kernel) {
+    morphology(src, dst, kernel, false);
+}
+
+void BitMask::open(const BitMask& src, BitMask& dst, const Kernel& kernel, int iterations, BitMask& work) {
+    if (iterations <= 0) {
+        dst = src;
+        return;
+    }
+
+    // ping-pong between work and dst so that the last dilation writes dst
+    const int steps = 2 * iterations;
+    const BitMask *input = &src;
+    for (int i = 0; i < steps; i++) {
+        BitMask& output = ((steps - 1 - i) % 2) ? work : dst;
+        if (i < iterations) erode(*input, output, kernel);
+        else dilate(*input, output, kernel);
+        input = &output;
+    }
+}
+
+} /* namespace sonarlog_obstacle_detection */
@@ -0,0 +1,129 @@
+#ifndef BitMask_hpp
+#define BitMask_hpp
+
+#include <vector>
+#include <stdint.h>
+#include <opencv2/opencv.hpp>
+
+namespace sonarlog_obstacle_detection {
+
+/*
+ * Binary image packed 64 pixels per word, row by row. Pixel x of a row is
+ * bit x % 64 of word x / 64; the bits past the last column are kept zero.
+ *
+ * Erosion and dilation follow cv::erode / cv::dilate with their default
+ * constant border (pixels out of the image count as set for an erosion
+ * and as clear for a dilation), for any structuring element whose rows are
+ * a single run of ones, such as the MORPH_RECT, MORPH_CROSS and
+ * MORPH_ELLIPSE elements. Each kernel row costs one AND (or OR) of
+ * word-shifted copies of a source row per word.
+ */
+class BitMask {
+public:
+
+    /* horizontal run [begin, end] of a structuring element row, relative to the anchor */
+    struct Run {
+        int dy;
+        int begin;
+        int end;
+    };
+
+    typedef std::vector<Run> Kernel;
+
+    BitMask()
+        : rows_(0)
+        , cols_(0)
+        , words_per_row_(0) {
+    }
+
+    BitMask(int rows, int cols) {
+        create(rows, cols);
+    }
+
+    void create(int rows, int cols);
+
+    void clear();
+
+    int rows() const {
+        return rows_;
+    }
+
+    int cols() const {
+        return cols_;
+    }
+
+    cv::Size size() const {
+        return cv::Size(cols_, rows_);
+    }
+
+    int words_per_row() const {
+        return words_per_row_;
+    }
+
+    const uint64_t* row(int y) const {
+        return &words_[(size_t)y * words_per_row_];
+    }
+
+    uint64_t* row(int y) {
+        return &words_[(size_t)y * words_per_row_];
+    }
+
+    bool get(int y, int x) const {
+        return (row(y)[x >> 6] >> (x & 63)) & 1;
+    }
+
+    void set(int y, int x, bool value);
+
+    /* src (CV_32FC1) > threshold, as cv::threshold with CV_THRESH_BINARY */
+    void threshold(const cv::Mat& src, float threshold) {
+        this->threshold(src, threshold, 0, src.rows);
+    }
+
+    /* as above, with the rows out of [first_row, end_row) left clear */
+    void threshold(const cv::Mat& src, float threshold, int first_row, int end_row);
+
+    /* writes value where the mask is set and 0 elsewhere (CV_32FC1, or CV_8UC1 if dst already is) */
+    void copy_to(cv::Mat& dst, double value = 1.0) const {
+        copy_to(dst, cv::Rect(0, 0, cols_, rows_), value);
+    }
+
+    /* as above for the pixels inside region; dst keeps its data if it has the region size */
+    void copy_to(cv::Mat& dst, const cv::Rect& region, double value = 1.0) const;
+
+    /* copies the pixels inside region to dst at offset, leaving the rest of dst as is */
+    void copy_to(BitMask& dst, const cv::Rect& region, const cv::Point& offset) const;
+
+    /* number of set pixels */
+    size_t count() const;
+
+    /* bounding rect of the set pixels (empty if none) */
+    cv::Rect bounding_box() const;
+
+    /* the runs of a structuring element, with its anchor at the center */
+    static Kernel kernel(const cv::Mat& element);
+
+    static void erode(const BitMask& src, BitMask& dst, const Kernel& kernel);
+
+    static void dilate(const BitMask& src, BitMask& dst, const Kernel& kernel);
+
+    /* as cv::morphologyEx(MORPH_OPEN) with the given iterations; work is scratch storage */
+    static void open(const BitMask& src, BitMask& dst, const Kernel& kernel, int iterations, BitMask& work);
+
+private:
+
+    static void morphology(const BitMask& src, BitMask& dst, const Kernel& kernel, bool erode);
+
+    uint64_t last_word_mask() const {
+        int bits = cols_ & 63;
+        return (bits) ? (~0ULL >> (64 - bits)) : ~0ULL;
+    }
+
+    int rows_;
+    int cols_;
+    int words_per_row_;
+    std::vector<uint64_t> words_;
+};
+
+} /* namespace sonarlog_obstacle_detection */
+
+#endif /* BitMask_hpp */
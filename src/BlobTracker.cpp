@@ -0,0 +1,117 @@
+#include "sonarlog_obstacle_detection/BlobTracker.hpp"
+
+namespace sonarlog_obstacle_detection {
+
+BlobTracker::BlobTracker(const BlobTrackerParameters& parameters)
+    : parameters_(parameters)
+    , full_searches_(0) {
+    reset();
+}
+
+void BlobTracker::reset() {
+    tracking_ = false;
+    misses_ = 0;
+    center_ = cv::Point2f(0, 0);
+    velocity_ = cv::Point2f(0, 0);
+    bbox_size_ = cv::Size();
+    target_ = detection::Target();
+}
+
+int BlobTracker::search(const cv::Mat& binary, const cv::Rect& window) {
+    window_ = window;
+
+    if (mask_.size() != binary.size()) mask_.create(binary.size(), CV_8UC1);
+
+    cv::Mat mask = mask_(window);
+    if (binary.type() == CV_8UC1) binary(window).copyTo(mask);
+    else binary(window).convertTo(mask, CV_8U);
+
+    labeler_.label(mask_, window);
+    return labeler_.largest(parameters_.min_area);
+}
+
+const detection::Target& BlobTracker::update(const cv::Mat& binary, float range) {
+    cv::Rect frame(0, 0, binary.cols, binary.rows);
+
+    int index = -1;
+    if (tracking_) {
+        cv::Point2f predicted = center_ + velocity_;
+        cv::Rect window(predicted.x - bbox_size_.width / 2 - parameters_.gate,
+                        predicted.y - bbox_size_.height / 2 - parameters_.gate,
+                        bbox_size_.width + 2 * parameters_.gate,
+                        bbox_size_.height + 2 * parameters_.gate);
+        window &= frame;
+
+        if (window.area()) index = search(binary, window);
+
+        // a blob cut by the window edge continues outside of it
+        if (index >= 0 && window != frame) {
+            const cv::Rect& bbox = labeler_.components()[index].bbox;
+            bool cut = (bbox.x == window.x && window.x > 0) ||
+                       (bbox.y == window.y && window.y > 0) ||
+                       (bbox.br().x == window.br().x && window.br().x < frame.width) ||
+                       (bbox.br().y == window.br().y && window.br().y < frame.height);
+            if (cut) index = -2;
+        }
+
+        if (index == -1 && ++misses_ <= parameters_.max_misses) {
+            // coast on the prediction
+            center_ = predicted;
+            target_.valid = false;
+            return target_;
+        }
+    }
+
+    if (index < 0) {
+        full_searches_++;
+        index = search(binary, frame);
+    }
+
+    if (index < 0) {
+        reset();
+        return target_;
+    }
+
+    update_track(labeler_.components()[index], binary.size(), range);
+    return target_;
+}
+
+void BlobTracker::update_track(const labeling::Component& component, cv::Size size, float range) {
+    const cv::Rect& bbox = component.bbox;
+    cv::Point2f measured(bbox.x + bbox.width * 0.5f, bbox.y + bbox.height * 0.5f);
+
+    if (tracking_) {
+        cv::Point2f predicted = center_ + velocity_;
+        cv::Point2f residual = measured - predicted;
+        center_ = predicted + residual * (float)parameters_.alpha;
+        velocity_ = velocity_ + residual * (float)parameters_.beta;
+    }
+    else {
+        center_ = measured;
+        velocity_ = cv::Point2f(0, 0);
+    }
+
+    tracking_ = true;
+    misses_ = 0;
+    bbox_size_ = bbox.size();
+
+    // the bottom point of the bbox closest to the sonar, as getTargetDistance
+    cv::Point2f origin(size.width / 2, size.height - 1);
+    double closest_distance = 100000;
+    for (size_t i = 0; i < 3; i++) {
+        cv::Point2f p(bbox.x + i * bbox.width / 2, bbox.y + bbox.height);
+        double distance = detection::euclideanDistance(p, origin);
+        if (distance < closest_distance) {
+            closest_distance = distance;
+            target_.closest = p;
+        }
+    }
+
+    target_.valid = true;
+    target_.bbox = bbox;
+    target_.position = detection::getWorldPoint(target_.closest, size, range);
+    target_.area = component.area;
+    target_.confidence = (float)component.area / bbox.area();
+}
+
+} /* namespace sonarlog_obstacle_detection */
@@ -0,0 +1,102 @@
+#ifndef BlobTracker_hpp
+#define BlobTracker_hpp
+
+#include <opencv2/opencv.hpp>
+#include "sonarlog_obstacle_detection/Detection.hpp"
+#include "sonarlog_obstacle_detection/Labeling.hpp"
+
+namespace sonarlog_obstacle_detection {
+
+struct BlobTrackerParameters {
+    BlobTrackerParameters()
+        : min_area(100)
+        , gate(24)
+        , max_misses(3)
+        , alpha(0.6)
+        , beta(0.2) {
+    }
+
+    // components with fewer pixels are not targets
+    int min_area;
+
+    // pixels added around the predicted bbox to form the search window
+    int gate;
+
+    // pings without a match before the track is dropped
+    int max_misses;
+
+    // alpha-beta gains of the position and velocity of the bbox center
+    double alpha;
+    double beta;
+};
+
+/*
+ * Tracks the biggest blob of a binary image across pings.
+ *
+ * While a track exists, only a window around the bbox predicted by a
+ * constant velocity (alpha-beta) model is labeled; the largest component
+ * of at least min_area pixels there updates the track. A component cut by
+ * the window edge is labeled again on the whole frame. Without a track, or
+ * after max_misses pings without a match, the whole frame is searched.
+ *
+ * The target comes from the component statistics, without drawing
+ * contours: the bbox, its closest bottom point (as getTargetDistance) and
+ * that point in world coordinates.
+ */
+class BlobTracker {
+public:
+
+    BlobTracker(const BlobTrackerParameters& parameters = BlobTrackerParameters());
+
+    /* binary is CV_32FC1 (0 or 1) or CV_8UC1; range is the range covered by its height */
+    const detection::Target& update(const cv::Mat& binary, float range);
+
+    void reset();
+
+    const detection::Target& target() const {
+        return target_;
+    }
+
+    bool tracking() const {
+        return tracking_;
+    }
+
+    /* the region labeled by the last update */
+    const cv::Rect& window() const {
+        return window_;
+    }
+
+    /* the number of updates that searched the whole frame */
+    size_t full_searches() const {
+        return full_searches_;
+    }
+
+    const labeling::Labeler& labeler() const {
+        return labeler_;
+    }
+
+private:
+
+    /* index of the largest component of at least min_area pixels inside window, or -1 */
+    int search(const cv::Mat& binary, const cv::Rect& window);
+
+    void update_track(const labeling::Component& component, cv::Size size, float range);
+
+    BlobTrackerParameters parameters_;
+    labeling::Labeler labeler_;
+    cv::Mat mask_;
+
+    bool tracking_;
+    int misses_;
+    cv::Point2f center_;
+    cv::Point2f velocity_;
+    cv::Size bbox_size_;
+
+    cv::Rect window_;
+    size_t full_searches_;
+    detection::Target target_;
+};
+
+} /* namespace sonarlog_obstacle_detection */
+
+#endif /* BlobTracker_hpp */
@@ -0,0 +1,209 @@
+#include <algorithm>
+#include <cmath>
+#include <cstring>
+#include "sonarlog_obstacle_detection/CartesianProjection.hpp"
+
+namespace sonarlog_obstacle_detection {
+
+namespace {
+
+inline uint64_t fnv1a(uint64_t hash, uint64_t value) {
+    for (size_t i = 0; i < 8; i++) {
+        hash ^= (value >> (i * 8)) & 0xff;
+        hash *= 1099511628211ULL;
+    }
+    return hash;
+}
+
+inline uint64_t double_bits(double value) {
+    uint64_t bits;
+    memcpy(&bits, &value, sizeof(bits));
+    return bits;
+}
+
+/* the bearings of sample in radians, in storage */
+SonarGeometry sonar_geometry(const base::samples::Sonar& sample, std::vector<double>& bearings) {
+    bearings.resize(sample.bearings.size());
+    for (size_t i = 0; i < bearings.size(); i++) bearings[i] = sample.bearings[i].getRad();
+    return SonarGeometry(sample.bin_count, bearings.size(), (bearings.empty()) ? NULL : &bearings[0],
+                         sample.beam_width.getRad());
+}
+
+}
+
+uint64_t CartesianTable::geometry_key(const base::samples::Sonar& sample, cv::Size size) {
+    std::vector<double> bearings;
+    return geometry_key(sonar_geometry(sample, bearings), size);
+}
+
+uint64_t CartesianTable::geometry_key(const SonarGeometry& geometry, cv::Size size) {
+    uint64_t hash = 14695981039346656037ULL;
+    hash = fnv1a(hash, geometry.bin_count);
+    hash = fnv1a(hash, geometry.beam_count);
+    hash = fnv1a(hash, size.width);
+    hash = fnv1a(hash, size.height);
+    for (size_t i = 0; i < geometry.beam_count; i++) {
+        hash = fnv1a(hash, double_bits(geometry.bearings[i]));
+    }
+    return hash;
+}
+
+cv::Size CartesianTable::default_size(const base::samples::Sonar& sample) {
+    std::vector<double> bearings;
+    return default_size(sonar_geometry(sample, bearings));
+}
+
+cv::Size CartesianTable::default_size(const SonarGeometry& geometry) {
+    double max_bearing = 0;
+    for (size_t i = 0; i < geometry.beam_count; i++) {
+        max_bearing = std::max(max_bearing, fabs(geometry.bearings[i]));
+    }
+    max_bearing += geometry.beam_width / 2;
+
+    int height = geometry.bin_count;
+    int width = (max_bearing < M_PI / 2) ? ceil(2 * height * sin(max_bearing)) : 2 * height;
+    return cv::Size(std::max(width, 1), std::max(height, 1));
+}
+
+bool CartesianTable::matches(const base::samples::Sonar& sample, cv::Size size, uint64_t key) const {
+    std::vector<double> bearings;
+    return matches(sonar_geometry(sample, bearings), size, key);
+}
+
+bool CartesianTable::matches(const SonarGeometry& geometry, cv::Size size, uint64_t key) const {
+    if (key != key_ || size != size_) return false;
+    if (geometry.bin_count != bin_count_ || geometry.beam_count != beam_count_) return false;
+    if (geometry.beam_count != bearings_.size()) return false;
+
+    for (size_t i = 0; i < bearings_.size(); i++) {
+        if (geometry.bearings[i] != bearings_[i]) return false;
+    }
+    return true;
+}
+
+void CartesianTable::build(const base::samples::Sonar& sample, cv::Size size, uint64_t key) {
+    std::vector<double> bearings;
+    build(sonar_geometry(sample, bearings), size, key);
+}
+
+void CartesianTable::build(const SonarGeometry& geometry, cv::Size size, uint64_t key) {
+    key_ = key;
+    size_ = size;
+    bin_count_ = geometry.bin_count;
+    beam_count_ = geometry.beam_count;
+    bearings_.assign(geometry.bearings, geometry.bearings + geometry.beam_count);
+
+    indices_.assign(size.area(), -1);
+    mask_ = cv::Mat::zeros(size, CV_8UC1);
+
+    if (bearings_.empty() || !bin_count_) return;
+
+    // beams sorted by bearing, keeping their original index
+    std::vector<std::pair<double, int> > beams(bearings_.size());
+    for (size_t i = 0; i < bearings_.size(); i++) beams[i] = std::make_pair(bearings_[i], (int)i);
+    std::sort(beams.begin(), beams.end());
+
+    double half_width = geometry.beam_width / 2;
+    if (beams.size() > 1) {
+        half_width = (beams.back().first - beams.front().first) / (beams.size() - 1) / 2;
+    }
+    double min_bearing = beams.front().first - half_width;
+    double max_bearing = beams.back().first + half_width;
+
+    double origin_x = size.width / 2.0;
+    double origin_y = size.height;
+    double bins_per_pixel = bin_count_ / (double)size.height;
+
+    for (int y = 0; y < size.height; y++) {
+        int32_t *indices = &indices_[y * size.width];
+        uchar *mask = mask_.ptr<uchar>(y);
+
+        for (int x = 0; x < size.width; x++) {
+            double dx = origin_x - (x + 0.5);
+            double dy = origin_y - (y + 0.5);
+
+            int bin = sqrt(dx * dx + dy * dy) * bins_per_pixel;
+            if (bin >= (int)bin_count_) continue;
+
+            double bearing = atan2(dx, dy);
+            if (bearing < min_bearing || bearing > max_bearing) continue;
+
+            std::vector<std::pair<double, int> >::const_iterator it =
+                std::lower_bound(beams.begin(), beams.end(), std::make_pair(bearing, -1));
+            if (it == beams.end() || (it != beams.begin() && bearing - (it - 1)->first < it->first - bearing)) {
+                --it;
+            }
+
+            indices[x] = it->second * bin_count_ + bin;
+            mask[x] = 255;
+        }
+    }
+}
+
+void CartesianTable::project(const std::vector<float>& bins, cv::Mat& dst) const {
+    project((bins.empty()) ? NULL : &bins[0], bins.size(), dst);
+}
+
+void CartesianTable::project(const float *bins, size_t count, cv::Mat& dst) const {
+    dst.create(size_, CV_32FC1);
+
+    const size_t total = indices_.size();
+    if (!bins || count < (size_t)bin_count_ * beam_count_) {
+        dst.setTo(0);
+        return;
+    }
+
+    const int32_t *indices = &indices_[0];
+    const float *src = bins;
+    float *out = dst.ptr<float>();
+    for (size_t i = 0; i < total; i++) {
+        out[i] = (indices[i] >= 0) ? src[indices[i]] : 0.0f;
+    }
+}
+
+CartesianProjection::CartesianProjection(cv::Size size, size_t capacity)
+    : size_(size)
+    , capacity_(std::max<size_t>(capacity, 1))
+    , hits_(0)
+    , misses_(0) {
+}
+
+const cv::Mat& CartesianProjection::project(const base::samples::Sonar& sample) {
+    lookup(sample).project(sample.bins, image_);
+    return image_;
+}
+
+const cv::Mat& CartesianProjection::project(const SonarGeometry& geometry, const float *bins) {
+    lookup(geometry).project(bins, (size_t)geometry.bin_count * geometry.beam_count, image_);
+    return image_;
+}
+
+const CartesianTable& CartesianProjection::lookup(const base::samples::Sonar& sample) {
+    return lookup(sonar_geometry(sample, bearings_));
+}
+
+const CartesianTable& CartesianProjection::lookup(const SonarGeometry& geometry) {
+    cv::Size size = (size_.area()) ? size_ : CartesianTable::default_size(geometry);
+    uint64_t key = CartesianTable::geometry_key(geometry, size);
+
+    for (std::list<CartesianTable>::iterator it = tables_.begin(); it != tables_.end(); ++it) {
+        if (it->matches(geometry, size, key)) {
+            hits_++;
+            if (it != tables_.begin()) tables_.splice(tables_.begin(), tables_, it);
+            return tables_.front();
+        }
+    }
+
+    misses_++;
+    if (tables_.size() >= capacity_) {
+        tables_.splice(tables_.begin(), tables_, --tables_.end());
+    }
+    else {
+        tables_.push_front(CartesianTable());
+    }
+
+    tables_.front().build(geometry, size, key);
+    return tables_.front();
+}
+
+} /* namespace sonarlog_obstacle_detection */
@@ -0,0 +1,152 @@
+#ifndef CartesianProjection_hpp
+#define CartesianProjection_hpp
+
+#include <list>
+#include <vector>
+#include <stdint.h>
+#include <opencv2/opencv.hpp>
+#include <base/samples/Sonar.hpp>
+
+namespace sonarlog_obstacle_detection {
+
+/* the geometry of a ping with its bearings (radians) read in place, e.g. from a SonarView */
+struct SonarGeometry {
+    SonarGeometry(uint32_t bin_count, uint32_t beam_count, const double *bearings, double beam_width)
+        : bin_count(bin_count)
+        , beam_count(beam_count)
+        , bearings(bearings)
+        , beam_width(beam_width) {
+    }
+
+    uint32_t bin_count;
+    uint32_t beam_count;
+
+    // beam_count bearings
+    const double *bearings;
+
+    double beam_width;
+};
+
+/*
+ * Polar to cartesian lookup table of one sonar geometry.
+ *
+ * Every output pixel stores the index of the bin it shows (beam-major, as
+ * in base::samples::Sonar::bins) or -1 outside the field of view, so the
+ * projection of a ping is a single gather pass. The sonar sits at the
+ * bottom center of the image and positive bearings point to the left.
+ */
+class CartesianTable {
+public:
+
+    CartesianTable()
+        : key_(0)
+        , bin_count_(0)
+        , beam_count_(0) {
+    }
+
+    void build(const base::samples::Sonar& sample, cv::Size size, uint64_t key);
+
+    void build(const SonarGeometry& geometry, cv::Size size, uint64_t key);
+
+    /* true if the table was built for the geometry of sample */
+    bool matches(const base::samples::Sonar& sample, cv::Size size, uint64_t key) const;
+
+    bool matches(const SonarGeometry& geometry, cv::Size size, uint64_t key) const;
+
+    void project(const std::vector<float>& bins, cv::Mat& dst) const;
+
+    /* projects count bins read in place (e.g. a SonarView of a mapped log) */
+    void project(const float *bins, size_t count, cv::Mat& dst) const;
+
+    const cv::Mat& mask() const {
+        return mask_;
+    }
+
+    /* the bin of every pixel (row-major, -1 outside the field of view) */
+    const int32_t* indices() const {
+        return indices_.empty() ? NULL : &indices_[0];
+    }
+
+    cv::Size size() const {
+        return size_;
+    }
+
+    uint64_t key() const {
+        return key_;
+    }
+
+    static uint64_t geometry_key(const base::samples::Sonar& sample, cv::Size size);
+
+    static uint64_t geometry_key(const SonarGeometry& geometry, cv::Size size);
+
+    /* the image size with about one pixel per bin along the range */
+    static cv::Size default_size(const base::samples::Sonar& sample);
+
+    static cv::Size default_size(const SonarGeometry& geometry);
+
+private:
+
+    uint64_t key_;
+    uint32_t bin_count_;
+    uint32_t beam_count_;
+    std::vector<double> bearings_;
+    cv::Size size_;
+
+    std::vector<int32_t> indices_;
+    cv::Mat mask_;
+};
+
+/*
+ * Projects pings through a small LRU cache of lookup tables, so a stable
+ * device builds its table once and a log that switches range mid-run keeps
+ * the tables of the recent geometries.
+ */
+class CartesianProjection {
+public:
+
+    CartesianProjection(cv::Size size = cv::Size(), size_t capacity = 4);
+
+    const cv::Mat& project(const base::samples::Sonar& sample);
+
+    /* projects the bins of a ping read in place (e.g. a SonarView of a mapped log) */
+    const cv::Mat& project(const SonarGeometry& geometry, const float *bins);
+
+    /* the table of the geometry of sample, built on a miss */
+    const CartesianTable& lookup(const base::samples::Sonar& sample);
+
+    const CartesianTable& lookup(const SonarGeometry& geometry);
+
+    /* the table used by the last project() call */
+    const CartesianTable& table() const {
+        return tables_.front();
+    }
+
+    const cv::Mat& image() const {
+        return image_;
+    }
+
+    size_t hits() const {
+        return hits_;
+    }
+
+    size_t misses() const {
+        return misses_;
+    }
+
+private:
+
+    cv::Size size_;
+    size_t capacity_;
+    std::list<CartesianTable> tables_;
+    cv::Mat image_;
+
+    // the bearings of the last Sonar sample, in radians
+    std::vector<double> bearings_;
+
+    size_t hits_;
+    size_t misses_;
+};
+
+} /* namespace sonarlog_obstacle_detection */
+
+#endif /* CartesianProjection_hpp */
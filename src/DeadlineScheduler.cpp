@@ -0,0 +1,64 @@
+#include <algorithm>
+#include "sonarlog_obstacle_detection/DeadlineScheduler.hpp"
+
+namespace sonarlog_obstacle_detection {
+
+DeadlineScheduler::DeadlineScheduler(double budget, Policy policy)
+    : budget_(budget)
+    , policy_(policy) {
+    reset();
+}
+
+bool DeadlineScheduler::parse_policy(const std::string& name, Policy& policy) {
+    if (name == "drop") policy = DROP;
+    else if (name == "degrade") policy = DEGRADE;
+    else return false;
+    return true;
+}
+
+const char* DeadlineScheduler::policy_name(Policy policy) {
+    return (policy == DEGRADE) ? "degrade" : "drop";
+}
+
+void DeadlineScheduler::reset() {
+    started_ = false;
+    clock_ = arrival_ = start_ = 0;
+    decision_ = RUN;
+    stats_ = Stats();
+}
+
+DeadlineScheduler::Decision DeadlineScheduler::arrive(const base::Time& time) {
+    if (!started_) {
+        started_ = true;
+        first_ = time;
+    }
+
+    arrival_ = (time - first_).toSeconds();
+    start_ = std::max(clock_, arrival_);
+    stats_.pings++;
+
+    double lateness = start_ - arrival_;
+    if (lateness <= budget_) {
+        decision_ = RUN;
+    }
+    else if (policy_ == DEGRADE && lateness <= 2 * budget_) {
+        decision_ = RUN_DEGRADED;
+        stats_.degraded++;
+    }
+    else {
+        decision_ = SKIP;
+        stats_.dropped++;
+    }
+
+    return decision_;
+}
+
+void DeadlineScheduler::finish(double seconds) {
+    clock_ = start_ + seconds;
+
+    double latency = clock_ - arrival_;
+    if (decision_ != SKIP && latency > budget_) stats_.missed++;
+    stats_.max_latency = std::max(stats_.max_latency, latency);
+}
+
+} /* namespace sonarlog_obstacle_detection */
@@ -0,0 +1,111 @@
+#ifndef DeadlineScheduler_hpp
+#define DeadlineScheduler_hpp
+
+#include <string>
+#include <base/Time.hpp>
+
+namespace sonarlog_obstacle_detection {
+
+/*
+ * Decides what to do with each ping so that the processing keeps up with
+ * the sonar.
+ *
+ * The scheduler runs on the recorded timeline: a ping arrives at its
+ * sample time and starts when the previous one is finished. A ping that
+ * starts more than the latency budget after its arrival is late. Under
+ * DROP, a late ping is only projected and its detection is coalesced into
+ * the next ping that is on time (keep newest). Under DEGRADE, a late ping
+ * skips the expensive stages, and is dropped when it is late by more than
+ * twice the budget.
+ *
+ * The decisions only depend on the sample times and on the costs passed
+ * to finish(), so replaying a log with a deterministic cost reproduces
+ * them exactly.
+ */
+class DeadlineScheduler {
+public:
+
+    enum Policy {
+        DROP,
+        DEGRADE
+    };
+
+    enum Decision {
+        RUN,
+        RUN_DEGRADED,
+        SKIP
+    };
+
+    struct Stats {
+        Stats()
+            : pings(0)
+            , degraded(0)
+            , dropped(0)
+            , missed(0)
+            , max_latency(0) {
+        }
+
+        size_t pings;
+        size_t degraded;
+        size_t dropped;
+
+        // pings run (not dropped) that finished more than the budget after their arrival
+        size_t missed;
+
+        // seconds from arrival to the end of the processing
+        double max_latency;
+    };
+
+    /* budget in seconds */
+    DeadlineScheduler(double budget = 0.1, Policy policy = DROP);
+
+    /* "drop" or "degrade" */
+    static bool parse_policy(const std::string& name, Policy& policy);
+
+    static const char* policy_name(Policy policy);
+
+    void reset();
+
+    /* a ping recorded at time arrives */
+    Decision arrive(const base::Time& time);
+
+    /* the ping given by the last arrive() took seconds */
+    void finish(double seconds);
+
+    /* seconds between the arrival and the start of the last ping */
+    double lateness() const {
+        return start_ - arrival_;
+    }
+
+    double budget() const {
+        return budget_;
+    }
+
+    Policy policy() const {
+        return policy_;
+    }
+
+    const Stats& stats() const {
+        return stats_;
+    }
+
+private:
+
+    double budget_;
+    Policy policy_;
+
+    bool started_;
+    base::Time first_;
+
+    // seconds after the first arrival
+    double clock_;
+    double arrival_;
+    double start_;
+    Decision decision_;
+
+    Stats stats_;
+};
+
+} /* namespace sonarlog_obstacle_detection */
+
+#endif /* DeadlineScheduler_hpp */
@@ -0,0 +1,191 @@
+#include <algorithm>
+#include "sonarlog_obstacle_detection/Detection.hpp"
+
+namespace sonarlog_obstacle_detection {
+
+namespace detection {
+
+cv::Mat removeSymmetricData(const cv::Mat& src) {
+    cv::Mat left  = src(cv::Rect(0, 0, src.cols * 0.5, src.rows));
+    cv::Mat right = src(cv::Rect(src.cols * 0.5, 0, src.cols * 0.5, src.rows));
+
+    cv::Mat left_mirror;
+    cv::flip(left, left_mirror, 1);
+
+    cv::Mat out_right = 1 - (left_mirror + right);
+    cv::medianBlur(out_right, out_right, 3);
+    out_right.setTo(0, out_right < 0.8);
+
+    cv::Mat out_left;
+    cv::flip(out_right, out_left, 1);
+
+    cv::Mat sym;
+    cv::hconcat(out_left, out_right, sym);
+
+    cv::Mat dst = src - sym;
+    dst.setTo(0, dst < 0);
+
+    return dst;
+}
+
+void getRoiRows(int rows, float min_range, float max_range, const base::samples::Sonar& sonar, int& row0, int& row1) {
+    float total_range = sonar.getBinStartDistance(sonar.bin_count);
+    if(max_range > total_range) max_range = total_range;
+
+    float min_bin = sonar.bin_count * min_range / total_range;
+    float max_bin = sonar.bin_count * max_range / total_range;
+
+    float resolution = rows / (float) sonar.bin_count;
+    row0 = rows - resolution * min_bin;
+    row1 = rows - resolution * max_bin;
+}
+
+void extractRoi(const cv::Mat& src, cv::Mat& dst, float min_range, float max_range, const base::samples::Sonar& sonar) {
+    int row0, row1;
+    getRoiRows(src.rows, min_range, max_range, sonar, row0, row1);
+
+    dst = src.clone();
+    dst.rowRange(0, row1).setTo(0);
+    dst.rowRange(row0, dst.rows).setTo(0);
+}
+
+cv::Rect getMaskLimits(const cv::Mat& mask) {
+    // bounding rect of the non-zero pixels, without collecting them
+    int min_x = mask.cols, max_x = -1, min_y = mask.rows, max_y = -1;
+
+    for (int y = 0; y < mask.rows; y++) {
+        const uchar *row = mask.ptr<uchar>(y);
+
+        int x0 = 0;
+        while (x0 < mask.cols && !row[x0]) x0++;
+        if (x0 == mask.cols) continue;
+
+        int x1 = mask.cols - 1;
+        while (!row[x1]) x1--;
+
+        min_x = std::min(min_x, x0);
+        max_x = std::max(max_x, x1);
+        min_y = std::min(min_y, y);
+        max_y = y;
+    }
+
+    if (max_y < 0) return cv::Rect();
+    return cv::Rect(min_x, min_y, max_x - min_x + 1, max_y - min_y + 1);
+}
+
+double euclideanDistance(const cv::Point2f& p1, const cv::Point2f& p2) {
+    cv::Point2f diff = p1 - p2;
+    return cv::sqrt(diff.x * diff.x + diff.y * diff.y);
+}
+
+base::Vector2d getWorldPoint(const cv::Point2f& p, cv::Size size, float range) {
+    // convert from image to cartesian coordinates
+    cv::Point2f origin(size.width / 2, size.height - 1);
+    cv::Point2f q(origin.y - p.y, origin.x - p.x);
+
+    // sonar resolution
+    float sonar_resolution = range / size.height;
+
+    // 2d world coordinates
+    float x = q.x * sonar_resolution;
+    base::Angle angle = base::Angle::fromRad(atan2(q.y, q.x));
+    float y = tan(angle.rad) * x;
+
+    // output
+    return base::Vector2d(x, y);
+}
+
+Target getTargetDistance(const cv::Mat& src, float range) {
+    FramePool pool;
+    return getTargetDistance(src, range, pool);
+}
+
+Target getTargetDistance(const cv::Mat& src, float range, FramePool& pool) {
+    cv::Mat& src_gray = pool.get(BUFFER_BLOB_GRAY, src.size(), CV_8UC1);
+    cv::cvtColor(src, src_gray, CV_BGR2GRAY);
+
+    return getTargetDistance(getMaskLimits(src_gray), src.size(), range);
+}
+
+Target getTargetDistance(const cv::Rect& bbox, cv::Size size, float range) {
+    Target target;
+    target.bbox = bbox;
+    double closest_distance = 100000;
+
+    cv::Point2f origin(size.width / 2, size.height - 1);
+    for (size_t i = 0; i < 3; i++) {
+        cv::Point2f p(target.bbox.x + i * target.bbox.width / 2, target.bbox.y + target.bbox.height);
+        double distance = euclideanDistance(p, origin);
+        if(distance < closest_distance) {
+            closest_distance = distance;
+            target.closest = p;
+        }
+    }
+
+    target.position = getWorldPoint(target.closest, size, range);
+    target.valid = true;
+    return target;
+}
+
+Target getMaskTarget(const BitMask& mask, int minPixels, float range) {
+    // popcount and word scans of the mask, nothing is drawn
+    size_t area = mask.count();
+    if (area <= (size_t)minPixels) return Target();
+
+    Target target = getTargetDistance(mask.bounding_box(), mask.size(), range);
+    target.area = area;
+    target.confidence = (float)area / target.bbox.area();
+    return target;
+}
+
+cv::Mat findBiggestBlob(const cv::Mat& src, int minPxContour, float range, Target& target) {
+    FramePool pool;
+    return findBiggestBlob(src, minPxContour, range, target, pool);
+}
+
+const cv::Mat& findBiggestBlob(const cv::Mat& src, int minPxContour, float range, Target& target, FramePool& pool) {
+    cv::Mat& src_8u = pool.get(BUFFER_BLOB_8U, src.size(), CV_8UC1);
+    src.convertTo(src_8u, CV_8U, 255);
+
+    // findContours modifies its input
+    cv::Mat& contours_input = pool.get(BUFFER_BLOB_CONTOURS, src.size(), CV_8UC1);
+    src_8u.copyTo(contours_input);
+
+    FramePool::Contours& contours = pool.contours();
+    cv::findContours(contours_input, contours, CV_RETR_LIST, CV_CHAIN_APPROX_SIMPLE);
+
+    // indices of the selected contours, the biggest one first
+    std::vector<size_t>& biggest_contour = pool.indices();
+    biggest_contour.clear();
+
+    for (size_t j = 0; j < contours.size(); j++) {
+        size_t pxContour = contours[j].size();
+        if (pxContour > minPxContour) {
+            if(!biggest_contour.empty() && (pxContour > contours[biggest_contour[0]].size())) {
+                biggest_contour[0] = j;
+            } else {
+                biggest_contour.push_back(j);
+            }
+        }
+    }
+
+    cv::Mat& dst = pool.get(BUFFER_BLOB_CANVAS, src.size(), CV_8UC3);
+    dst.setTo(cv::Scalar::all(0));
+    for (size_t j = 0; j < biggest_contour.size(); j++) {
+        cv::drawContours(dst, contours, (int)biggest_contour[j], cv::Scalar(0,0,255), 1);
+    }
+
+    target = Target();
+    if(!biggest_contour.empty()) {
+        cv::Rect bounding_rect = cv::boundingRect(contours[biggest_contour[0]]);
+        cv::rectangle(dst, bounding_rect, cv::Scalar(0,255,0));
+        target = getTargetDistance(dst, range, pool);
+        target.area = cv::contourArea(contours[biggest_contour[0]]);
+        target.confidence = (bounding_rect.area()) ? (float)target.area / bounding_rect.area() : 0;
+    }
+    return dst;
+}
+
+} /* namespace detection */
+
+} /* namespace sonarlog_obstacle_detection */
@@ -0,0 +1,91 @@
+#ifndef Detection_hpp
+#define Detection_hpp
+
+#include <opencv2/opencv.hpp>
+#include <base/Eigen.hpp>
+#include <base/Time.hpp>
+#include <base/samples/Sonar.hpp>
+#include "sonarlog_obstacle_detection/BitMask.hpp"
+#include "sonarlog_obstacle_detection/FramePool.hpp"
+
+namespace sonarlog_obstacle_detection {
+
+namespace detection {
+
+struct Target {
+    Target()
+        : valid(false)
+        , position(0, 0)
+        , area(0)
+        , confidence(0) {
+    }
+
+    bool valid;
+
+    // bounding box of the blob in image coordinates
+    cv::Rect bbox;
+
+    // point of the bounding box closest to the sonar
+    cv::Point closest;
+
+    // closest point in world coordinates (meters)
+    base::Vector2d position;
+
+    // elements of the blob (pixels, or bins on a polar grid)
+    int area;
+
+    // fraction of the bounding box covered by the blob, 1 for a solid echo
+    float confidence;
+};
+
+/* a target found in a ping */
+struct TimedTarget {
+    TimedTarget()
+        : stream(0)
+        , ping(0) {
+    }
+
+    base::Time time;
+
+    // index of the stream in a multi-stream run
+    size_t stream;
+
+    // index of the ping in its stream
+    size_t ping;
+
+    Target target;
+};
+
+cv::Mat removeSymmetricData(const cv::Mat& src);
+
+/* rows of an image with sonar.bin_count bins along its height that fall out of [min_range, max_range] */
+void getRoiRows(int rows, float min_range, float max_range, const base::samples::Sonar& sonar, int& row0, int& row1);
+
+void extractRoi(const cv::Mat& src, cv::Mat& dst, float min_range, float max_range, const base::samples::Sonar& sonar);
+
+cv::Rect getMaskLimits(const cv::Mat& mask);
+
+double euclideanDistance(const cv::Point2f& p1, const cv::Point2f& p2);
+
+base::Vector2d getWorldPoint(const cv::Point2f& p, cv::Size size, float range);
+
+Target getTargetDistance(const cv::Mat& src, float range);
+
+Target getTargetDistance(const cv::Mat& src, float range, FramePool& pool);
+
+/* the target of a bounding box on an image of the given size */
+Target getTargetDistance(const cv::Rect& bbox, cv::Size size, float range);
+
+/* the target of every set pixel of a mask, valid with more than minPixels of them */
+Target getMaskTarget(const BitMask& mask, int minPixels, float range);
+
+cv::Mat findBiggestBlob(const cv::Mat& src, int minPxContour, float range, Target& target);
+
+/* as above, drawing into (and returning) a buffer of the pool */
+const cv::Mat& findBiggestBlob(const cv::Mat& src, int minPxContour, float range, Target& target, FramePool& pool);
+
+} /* namespace detection */
+
+} /* namespace sonarlog_obstacle_detection */
+
+#endif /* Detection_hpp */
@@ -0,0 +1,142 @@
+#include <cstdio>
+#include <cstring>
+#include "sonarlog_obstacle_detection/DetectionEncoder.hpp"
+
+namespace sonarlog_obstacle_detection {
+
+namespace {
+
+const std::string UNKNOWN_STREAM;
+
+template <class T>
+inline void append(std::string& out, T value) {
+    char bytes[sizeof(T)];
+    memcpy(bytes, &value, sizeof(T));
+    out.append(bytes, sizeof(T));
+}
+
+/* the stream name as a JSON string */
+void append_json(std::string& out, const std::string& text) {
+    out += '"';
+    for (size_t i = 0; i < text.size(); i++) {
+        if (text[i] == '"' || text[i] == '\\') out += '\\';
+        out += text[i];
+    }
+    out += '"';
+}
+
+}
+
+const char DetectionEncoder::MAGIC[8] = { 'S', 'L', 'D', 'E', 'T', 'E', 'C', 'T' };
+const uint32_t DetectionEncoder::VERSION;
+const uint32_t DetectionEncoder::RECORD_SIZE;
+
+DetectionRecord DetectionRecord::from(const detection::TimedTarget& detection) {
+    const detection::Target& target = detection.target;
+
+    DetectionRecord record;
+    record.time = detection.time.toMicroseconds();
+    record.ping = detection.ping;
+    record.stream = detection.stream;
+    record.x = target.bbox.x;
+    record.y = target.bbox.y;
+    record.width = target.bbox.width;
+    record.height = target.bbox.height;
+    record.closest_x = target.closest.x;
+    record.closest_y = target.closest.y;
+    record.position_x = target.position.x();
+    record.position_y = target.position.y();
+    record.area = target.area;
+    record.confidence = target.confidence;
+    return record;
+}
+
+DetectionEncoder::DetectionEncoder(Format format, const std::vector<std::string>& streams)
+    : format_(format)
+    , streams_(streams) {
+}
+
+void DetectionEncoder::header(std::string& out) const {
+    if (format_ == CSV) {
+        out += "time,stream,ping,x,y,width,height,closest_x,closest_y,position_x,position_y,area,confidence\n";
+    }
+    else if (format_ == BINARY) {
+        out.append(MAGIC, sizeof(MAGIC));
+        append<uint32_t>(out, VERSION);
+        append<uint32_t>(out, RECORD_SIZE);
+        append<uint32_t>(out, streams_.size());
+        for (size_t i = 0; i < streams_.size(); i++) {
+            append<uint32_t>(out, streams_[i].size());
+            out += streams_[i];
+        }
+    }
+}
+
+void DetectionEncoder::encode(const DetectionRecord& record, std::string& out) const {
+    if (format_ == BINARY) {
+        append(out, record.time);
+        append(out, record.ping);
+        append(out, record.stream);
+        append(out, record.x);
+        append(out, record.y);
+        append(out, record.width);
+        append(out, record.height);
+        append(out, record.closest_x);
+        append(out, record.closest_y);
+        append(out, record.position_x);
+        append(out, record.position_y);
+        append(out, record.area);
+        append(out, record.confidence);
+        return;
+    }
+
+    const std::string& stream = (record.stream < streams_.size()) ? streams_[record.stream] : UNKNOWN_STREAM;
+
+    // snprintf rather than a stream, this runs for every record
+    char line[256];
+    if (format_ == CSV) {
+        snprintf(line, sizeof(line), "%lld,", (long long)record.time);
+        out += line;
+        out += stream;
+        snprintf(line, sizeof(line), ",%llu,%d,%d,%d,%d,%d,%d,%.3f,%.3f,%d,%.3f\n",
+                 (unsigned long long)record.ping, record.x, record.y, record.width, record.height,
+                 record.closest_x, record.closest_y, record.position_x, record.position_y,
+                 record.area, record.confidence);
+        out += line;
+        return;
+    }
+
+    snprintf(line, sizeof(line), "{\"time\":%lld,\"stream\":", (long long)record.time);
+    out += line;
+    append_json(out, stream);
+    snprintf(line, sizeof(line),
+             ",\"ping\":%llu,\"bbox\":[%d,%d,%d,%d],\"closest\":[%d,%d],"
+             "\"position\":[%.3f,%.3f],\"area\":%d,\"confidence\":%.3f}\n",
+             (unsigned long long)record.ping, record.x, record.y, record.width, record.height,
+             record.closest_x, record.closest_y, record.position_x, record.position_y,
+             record.area, record.confidence);
+    out += line;
+}
+
+bool DetectionEncoder::parse_format(const std::string& name, Format& format) {
+    if (name == "csv") format = CSV;
+    else if (name == "jsonl") format = JSON_LINES;
+    else if (name == "binary") format = BINARY;
+    else return false;
+    return true;
+}
+
+const char* DetectionEncoder::format_name(Format format) {
+    switch (format) {
+        case CSV: return "csv";
+        case JSON_LINES: return "jsonl";
+        case BINARY: return "binary";
+    }
+    return "";
+}
+
+const char* DetectionEncoder::extension(Format format) {
+    return (format == BINARY) ? "bin" : format_name(format);
+}
+
+} /* namespace sonarlog_obstacle_detection */
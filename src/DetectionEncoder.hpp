@@ -0,0 +1,111 @@
+#ifndef DetectionEncoder_hpp
+#define DetectionEncoder_hpp
+
+#include <string>
+#include <vector>
+#include <stdint.h>
+#include "sonarlog_obstacle_detection/Detection.hpp"
+
+namespace sonarlog_obstacle_detection {
+
+/* a detection::TimedTarget with fixed-size fields, as stored in the detection files */
+struct DetectionRecord {
+    DetectionRecord()
+        : time(0)
+        , ping(0)
+        , stream(0)
+        , x(0)
+        , y(0)
+        , width(0)
+        , height(0)
+        , closest_x(0)
+        , closest_y(0)
+        , position_x(0)
+        , position_y(0)
+        , area(0)
+        , confidence(0) {
+    }
+
+    // recorded time of the ping (microseconds)
+    int64_t time;
+
+    // index of the ping in its stream
+    uint64_t ping;
+
+    // index of the stream name in the file
+    uint32_t stream;
+
+    // bounding box of the blob in image (or grid) coordinates
+    int32_t x;
+    int32_t y;
+    int32_t width;
+    int32_t height;
+
+    int32_t closest_x;
+    int32_t closest_y;
+
+    // closest point in world coordinates (meters)
+    float position_x;
+    float position_y;
+
+    int32_t area;
+    float confidence;
+
+    static DetectionRecord from(const detection::TimedTarget& detection);
+};
+
+/*
+ * Text and binary encodings of detection records.
+ *
+ * CSV and JSON lines name the stream of every record. The binary format
+ * starts with the magic "SLDETECT", the format version, the record size
+ * and the stream names (each a uint32 length and its characters), followed
+ * by one RECORD_SIZE block per record: the fields of DetectionRecord in
+ * declaration order, without padding, in the byte order of the host.
+ */
+class DetectionEncoder {
+public:
+
+    enum Format {
+        CSV,
+        JSON_LINES,
+        BINARY
+    };
+
+    static const char MAGIC[8];
+    static const uint32_t VERSION = 1;
+    static const uint32_t RECORD_SIZE = 60;
+
+    DetectionEncoder(Format format, const std::vector<std::string>& streams);
+
+    Format format() const {
+        return format_;
+    }
+
+    const std::vector<std::string>& streams() const {
+        return streams_;
+    }
+
+    /* appends the CSV header or the binary file header (nothing for JSON lines) */
+    void header(std::string& out) const;
+
+    /* appends one record */
+    void encode(const DetectionRecord& record, std::string& out) const;
+
+    /* "csv", "jsonl" or "binary" */
+    static bool parse_format(const std::string& name, Format& format);
+
+    static const char* format_name(Format format);
+
+    /* file extension of a format, without the dot */
+    static const char* extension(Format format);
+
+private:
+
+    Format format_;
+    std::vector<std::string> streams_;
+};
+
+} /* namespace sonarlog_obstacle_detection */
+
+#endif /* DetectionEncoder_hpp */
@@ -0,0 +1,101 @@
+#include <cstring>
+#include <stdexcept>
+#include "sonarlog_obstacle_detection/DetectionReader.hpp"
+
+namespace sonarlog_obstacle_detection {
+
+namespace {
+
+// larger records are a corrupted header, not a later version
+const uint32_t MAX_RECORD_SIZE = 4096;
+
+template <class T>
+inline bool read(std::istream& in, T& value) {
+    return in.read(reinterpret_cast<char*>(&value), sizeof(T)).good();
+}
+
+template <class T>
+inline const char* take(const char *bytes, T& value) {
+    memcpy(&value, bytes, sizeof(T));
+    return bytes + sizeof(T);
+}
+
+/* the bytes from the read position to the end of the file */
+uint64_t bytes_left(std::istream& in) {
+    std::streampos position = in.tellg();
+    in.seekg(0, std::ios::end);
+    std::streampos end = in.tellg();
+    in.seekg(position);
+    return (position < 0 || end < position) ? 0 : (uint64_t)(end - position);
+}
+
+}
+
+DetectionReader::DetectionReader(const std::string& path)
+    : in_(path.c_str(), std::ios::in | std::ios::binary)
+    , record_size_(0) {
+    if (!in_) throw std::runtime_error("cannot read the detections of " + path);
+
+    char magic[sizeof(DetectionEncoder::MAGIC)];
+    uint32_t version, stream_count;
+    if (!in_.read(magic, sizeof(magic)) || memcmp(magic, DetectionEncoder::MAGIC, sizeof(magic)) ||
+        !read(in_, version) || !read(in_, record_size_) || !read(in_, stream_count)) {
+        throw std::runtime_error(path + " is not a binary detection file");
+    }
+
+    // a later version may only append fields to the record
+    if (version < 1 || record_size_ < DetectionEncoder::RECORD_SIZE || record_size_ > MAX_RECORD_SIZE) {
+        throw std::runtime_error(path + " has an unsupported detection record");
+    }
+
+    // every name takes at least its length, so the counts are bounded by the file before any allocation
+    uint64_t left = bytes_left(in_);
+    if (stream_count > left / sizeof(uint32_t)) throw std::runtime_error(path + " has a truncated header");
+
+    for (uint32_t i = 0; i < stream_count; i++) {
+        uint32_t length;
+        if (!read(in_, length)) throw std::runtime_error(path + " has a truncated header");
+        left -= sizeof(length);
+
+        if (length > left) throw std::runtime_error(path + " has a truncated header");
+        std::string name(length, '\0');
+        if (length && !in_.read(&name[0], length)) throw std::runtime_error(path + " has a truncated header");
+        left -= length;
+        streams_.push_back(name);
+    }
+
+    buffer_.resize(record_size_);
+}
+
+std::string DetectionReader::stream_name(const DetectionRecord& record) const {
+    return (record.stream < streams_.size()) ? streams_[record.stream] : std::string();
+}
+
+bool DetectionReader::next(DetectionRecord& record) {
+    if (!in_.read(&buffer_[0], record_size_)) return false;
+
+    const char *bytes = &buffer_[0];
+    bytes = take(bytes, record.time);
+    bytes = take(bytes, record.ping);
+    bytes = take(bytes, record.stream);
+    bytes = take(bytes, record.x);
+    bytes = take(bytes, record.y);
+    bytes = take(bytes, record.width);
+    bytes = take(bytes, record.height);
+    bytes = take(bytes, record.closest_x);
+    bytes = take(bytes, record.closest_y);
+    bytes = take(bytes, record.position_x);
+    bytes = take(bytes, record.position_y);
+    bytes = take(bytes, record.area);
+    take(bytes, record.confidence);
+    return true;
+}
+
+std::vector<DetectionRecord> DetectionReader::read_all() {
+    std::vector<DetectionRecord> records;
+    DetectionRecord record;
+    while (next(record)) records.push_back(record);
+    return records;
+}
+
+} /* namespace sonarlog_obstacle_detection */
@@ -0,0 +1,44 @@
+#ifndef DetectionReader_hpp
+#define DetectionReader_hpp
+
+#include <fstream>
+#include <string>
+#include <vector>
+#include "sonarlog_obstacle_detection/DetectionEncoder.hpp"
+
+namespace sonarlog_obstacle_detection {
+
+/*
+ * Reads back a binary detection file (see DetectionEncoder) for offline
+ * analysis.
+ */
+class DetectionReader {
+public:
+
+    /* reads the header, throws std::runtime_error if path is not a detection file or its header is cut or corrupted */
+    DetectionReader(const std::string& path);
+
+    const std::vector<std::string>& streams() const {
+        return streams_;
+    }
+
+    /* name of the stream of record, empty for an unknown index */
+    std::string stream_name(const DetectionRecord& record) const;
+
+    /* reads the next record, returns false at the end of the file (a truncated last record included) */
+    bool next(DetectionRecord& record);
+
+    /* every record left in the file */
+    std::vector<DetectionRecord> read_all();
+
+private:
+
+    std::ifstream in_;
+    std::vector<std::string> streams_;
+    uint32_t record_size_;
+    std::vector<char> buffer_;
+};
+
+} /* namespace sonarlog_obstacle_detection */
+
+#endif /* DetectionReader_hpp */
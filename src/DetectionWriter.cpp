@@ -0,0 +1,110 @@
+#include <algorithm>
+#include <stdexcept>
+#include <boost/bind.hpp>
+#include <boost/date_time/posix_time/posix_time.hpp>
+#include "sonarlog_obstacle_detection/DetectionWriter.hpp"
+
+namespace sonarlog_obstacle_detection {
+
+namespace {
+
+// records taken from the ring at once
+const size_t BATCH_RECORDS = 64;
+
+// sleep of the writer thread on an empty ring
+const int POLL_MILLISECONDS = 10;
+
+// longest time encoded records wait in the buffer while records arrive
+const int FLUSH_MILLISECONDS = 1000;
+
+}
+
+DetectionWriter::DetectionWriter(const std::string& path, DetectionEncoder::Format format,
+                                 const std::vector<std::string>& streams,
+                                 size_t capacity, size_t batch_bytes)
+    : path_(path)
+    , encoder_(format, streams)
+    , batch_bytes_(batch_bytes)
+    , out_(path.c_str(), std::ios::out | std::ios::binary | std::ios::trunc)
+    , queue_(std::max<size_t>(capacity, 1))
+    , stopped_(false)
+    , written_(0)
+    , dropped_(0) {
+    if (!out_) throw std::runtime_error("cannot write the detections to " + path);
+
+    buffer_.reserve(batch_bytes_ + 4096);
+    encoder_.header(buffer_);
+
+    thread_ = boost::thread(boost::bind(&DetectionWriter::write_records, this));
+}
+
+DetectionWriter::~DetectionWriter() {
+    try {
+        close();
+    } catch (std::exception&) {
+        // a destructor cannot report the write error, close() does
+    }
+}
+
+bool DetectionWriter::push(const DetectionRecord& record) {
+    if (queue_.push(record)) return true;
+    dropped_++;
+    return false;
+}
+
+void DetectionWriter::close() {
+    if (!thread_.joinable()) return;
+
+    stopped_.store(true, boost::memory_order_release);
+    thread_.join();
+    out_.close();
+
+    if (!error_.empty()) throw std::runtime_error(error_);
+}
+
+bool DetectionWriter::write_buffer() {
+    if (buffer_.empty()) return true;
+
+    out_.write(buffer_.data(), buffer_.size());
+    buffer_.clear();
+    if (out_) return true;
+
+    error_ = "cannot write the detections to " + path_;
+    return false;
+}
+
+void DetectionWriter::write_records() {
+    DetectionRecord batch[BATCH_RECORDS];
+    boost::posix_time::ptime last_write = boost::posix_time::microsec_clock::universal_time();
+
+    for (;;) {
+        // read before the drain, so the records pushed before close() are written
+        bool stopped = stopped_.load(boost::memory_order_acquire);
+
+        size_t count;
+        while ((count = queue_.pop(batch, BATCH_RECORDS)) > 0) {
+            for (size_t i = 0; i < count; i++) encoder_.encode(batch[i], buffer_);
+            written_ += count;
+
+            if (buffer_.size() >= batch_bytes_) {
+                if (!write_buffer()) return;
+                last_write = boost::posix_time::microsec_clock::universal_time();
+            }
+        }
+
+        if (stopped) break;
+
+        boost::posix_time::ptime now = boost::posix_time::microsec_clock::universal_time();
+        if (!buffer_.empty() && now - last_write >= boost::posix_time::milliseconds(FLUSH_MILLISECONDS)) {
+            if (!write_buffer()) return;
+            out_.flush();
+            last_write = now;
+        }
+
+        boost::this_thread::sleep(boost::posix_time::milliseconds(POLL_MILLISECONDS));
+    }
+
+    if (write_buffer()) out_.flush();
+}
+
+} /* namespace sonarlog_obstacle_detection */
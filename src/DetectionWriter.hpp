@@ -0,0 +1,80 @@
+#ifndef DetectionWriter_hpp
+#define DetectionWriter_hpp
+
+#include <fstream>
+#include <string>
+#include <vector>
+#include <boost/atomic.hpp>
+#include <boost/lockfree/spsc_queue.hpp>
+#include <boost/thread/thread.hpp>
+#include "sonarlog_obstacle_detection/DetectionEncoder.hpp"
+
+namespace sonarlog_obstacle_detection {
+
+/*
+ * Writes detection records to a file from a background thread.
+ *
+ * The processing thread (the single producer) hands records over through a
+ * lock-free ring of the given capacity: push() never blocks, and a record
+ * that finds the ring full is dropped and counted. The writer thread
+ * encodes the records in batches and writes the file in blocks of about
+ * batch_bytes, at least once per second while records arrive.
+ */
+class DetectionWriter {
+public:
+
+    /* opens path, throws std::runtime_error if it cannot be written */
+    DetectionWriter(const std::string& path, DetectionEncoder::Format format,
+                    const std::vector<std::string>& streams,
+                    size_t capacity = 4096, size_t batch_bytes = 64 * 1024);
+
+    ~DetectionWriter();
+
+    /* returns false if the record was dropped */
+    bool push(const DetectionRecord& record);
+
+    bool push(const detection::TimedTarget& detection) {
+        return push(DetectionRecord::from(detection));
+    }
+
+    /* writes the records pushed so far and closes the file, throws on a write error */
+    void close();
+
+    const std::string& path() const {
+        return path_;
+    }
+
+    size_t written() const {
+        return written_;
+    }
+
+    /* records lost to a full ring, only read it from the producer thread */
+    size_t dropped() const {
+        return dropped_;
+    }
+
+private:
+
+    void write_records();
+
+    /* writes the encoded buffer, returns false on error */
+    bool write_buffer();
+
+    std::string path_;
+    DetectionEncoder encoder_;
+    size_t batch_bytes_;
+    std::ofstream out_;
+    std::string buffer_;
+
+    boost::lockfree::spsc_queue<DetectionRecord> queue_;
+    boost::atomic<bool> stopped_;
+    boost::atomic<size_t> written_;
+    size_t dropped_;
+    std::string error_;
+
+    boost::thread thread_;
+};
+
+} /* namespace sonarlog_obstacle_detection */
+
+#endif /* DetectionWriter_hpp */
@@ -0,0 +1,85 @@
+#ifndef DeviceProfile_hpp
+#define DeviceProfile_hpp
+
+#include <cmath>
+#include <stdint.h>
+#include <base/samples/Sonar.hpp>
+
+namespace sonarlog_obstacle_detection {
+
+/*
+ * Compile-time description of the sonar models in our logs: beam count,
+ * horizontal sector and the size of the Cartesian image they are shown on.
+ * DeviceProjector instantiates its kernels with these constants.
+ */
+namespace profiles {
+
+/* Tritech Gemini 720i: 256 beams over 130 degrees */
+struct Gemini {
+    static const uint32_t beam_count = 256;
+    static const bool scanning = false;
+
+    // about one pixel per bin at 400 bins, the width covers the sector
+    static const int width = 728;
+    static const int height = 400;
+
+    static double sector() {
+        return 130 * M_PI / 180;
+    }
+
+    static const char* name() {
+        return "gemini";
+    }
+};
+
+/* Teledyne BlueView M900-130: 768 beams over 130 degrees */
+struct BlueView {
+    static const uint32_t beam_count = 768;
+    static const bool scanning = false;
+
+    static const int width = 1090;
+    static const int height = 600;
+
+    static double sector() {
+        return 130 * M_PI / 180;
+    }
+
+    static const char* name() {
+        return "blueview";
+    }
+};
+
+/* Tritech Micron: one mechanically scanned beam on the +-45 degree sector of a canvas of at most 800 x 800 */
+struct Micron {
+    static const uint32_t beam_count = 1;
+    static const bool scanning = true;
+
+    static const int width = 800;
+    static const int height = 800;
+
+    static double sector() {
+        return 90 * M_PI / 180;
+    }
+
+    static const char* name() {
+        return "micron";
+    }
+};
+
+/* true if sample has the beams of Profile (a multibeam also its sector, within two degrees) */
+template <class Profile>
+bool matches(const base::samples::Sonar& sample) {
+    if (sample.beam_count != Profile::beam_count || sample.bearings.size() != Profile::beam_count) return false;
+    if (Profile::scanning) return true;
+
+    double first = sample.bearings.front().getRad();
+    double last = sample.bearings.back().getRad();
+    double span = fabs(first - last) * Profile::beam_count / (Profile::beam_count - 1);
+    return fabs(span - Profile::sector()) < 2 * M_PI / 180;
+}
+
+} /* namespace profiles */
+
+} /* namespace sonarlog_obstacle_detection */
+
+#endif /* DeviceProfile_hpp */
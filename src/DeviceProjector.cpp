@@ -0,0 +1,165 @@
+#include "sonarlog_obstacle_detection/CartesianProjection.hpp"
+#include "sonarlog_obstacle_detection/DeviceProfile.hpp"
+#include "sonarlog_obstacle_detection/DeviceProjector.hpp"
+#include "sonarlog_obstacle_detection/MappedLog.hpp"
+#include "sonarlog_obstacle_detection/ScanningCanvas.hpp"
+
+namespace sonarlog_obstacle_detection {
+
+namespace {
+
+/* the gather of CartesianTable::project with a trip count known to the compiler */
+template <size_t PIXELS>
+inline void gather(const int32_t *indices, const float *bins, float *out) {
+    for (size_t i = 0; i < PIXELS; i++) {
+        out[i] = (indices[i] >= 0) ? bins[indices[i]] : 0.0f;
+    }
+}
+
+template <class Profile>
+class MultibeamProjector : public DeviceProjector {
+public:
+
+    MultibeamProjector()
+        : projection_(cv::Size(Profile::width, Profile::height))
+        , image_(cv::Mat::zeros(Profile::height, Profile::width, CV_32FC1)) {
+    }
+
+    const char* name() const {
+        return Profile::name();
+    }
+
+    bool scanning() const {
+        return false;
+    }
+
+    cv::Rect project(const base::samples::Sonar& sample) {
+        const CartesianTable& table = projection_.lookup(sample);
+
+        // a ping out of the profile (e.g. a reconfigured device) takes the generic gather
+        if (sample.beam_count != Profile::beam_count || sample.bins.empty() ||
+            sample.bins.size() < (size_t)Profile::beam_count * sample.bin_count) {
+            table.project(sample.bins, image_);
+        }
+        else {
+            gather<Profile::width * Profile::height>(table.indices(), &sample.bins[0], image_.ptr<float>());
+        }
+
+        return cv::Rect(0, 0, Profile::width, Profile::height);
+    }
+
+    cv::Rect project(const SonarView& view) {
+        SonarGeometry geometry(view.bin_count, view.beam_count, view.bearings, view.beam_width.getRad());
+        const CartesianTable& table = projection_.lookup(geometry);
+
+        if (view.beam_count != Profile::beam_count || !view.bin_count) {
+            table.project(view.bins, (size_t)view.bin_count * view.beam_count, image_);
+        }
+        else {
+            gather<Profile::width * Profile::height>(table.indices(), view.bins, image_.ptr<float>());
+        }
+
+        return cv::Rect(0, 0, Profile::width, Profile::height);
+    }
+
+    cv::Mat image() const {
+        return image_;
+    }
+
+private:
+
+    CartesianProjection projection_;
+    cv::Mat image_;
+};
+
+template <class Profile>
+class ScanningProjector : public DeviceProjector {
+public:
+
+    ScanningProjector()
+        : canvas_(base::Angle::fromRad(Profile::sector() / 2), base::Angle::fromRad(-Profile::sector() / 2),
+                  (Profile::width < Profile::height) ? Profile::width : Profile::height) {
+    }
+
+    const char* name() const {
+        return Profile::name();
+    }
+
+    bool scanning() const {
+        return true;
+    }
+
+    cv::Rect project(const base::samples::Sonar& sample) {
+        return canvas_.update(sample);
+    }
+
+    // the canvas draws from a sample
+    cv::Rect project(const SonarView& view) {
+        view.copy_to(sample_);
+        return canvas_.update(sample_);
+    }
+
+    cv::Mat image() const {
+        return canvas_.image();
+    }
+
+private:
+
+    ScanningCanvas canvas_;
+    base::samples::Sonar sample_;
+};
+
+class GenericProjector : public DeviceProjector {
+public:
+
+    const char* name() const {
+        return "generic";
+    }
+
+    bool scanning() const {
+        return false;
+    }
+
+    cv::Rect project(const base::samples::Sonar& sample) {
+        const cv::Mat& image = projection_.project(sample);
+        return cv::Rect(0, 0, image.cols, image.rows);
+    }
+
+    cv::Rect project(const SonarView& view) {
+        SonarGeometry geometry(view.bin_count, view.beam_count, view.bearings, view.beam_width.getRad());
+        const cv::Mat& image = projection_.project(geometry, view.bins);
+        return cv::Rect(0, 0, image.cols, image.rows);
+    }
+
+    cv::Mat image() const {
+        return projection_.image();
+    }
+
+private:
+
+    CartesianProjection projection_;
+};
+
+}
+
+std::auto_ptr<DeviceProjector> DeviceProjector::create(const base::samples::Sonar& sample) {
+    if (profiles::matches<profiles::Micron>(sample)) {
+        return std::auto_ptr<DeviceProjector>(new ScanningProjector<profiles::Micron>());
+    }
+    if (profiles::matches<profiles::Gemini>(sample)) {
+        return std::auto_ptr<DeviceProjector>(new MultibeamProjector<profiles::Gemini>());
+    }
+    if (profiles::matches<profiles::BlueView>(sample)) {
+        return std::auto_ptr<DeviceProjector>(new MultibeamProjector<profiles::BlueView>());
+    }
+    return std::auto_ptr<DeviceProjector>(new GenericProjector());
+}
+
+std::auto_ptr<DeviceProjector> DeviceProjector::create(const SonarView& view) {
+    // once per stream, the profile is matched on a copy
+    base::samples::Sonar sample;
+    view.copy_to(sample);
+    return create(sample);
+}
+
+} /* namespace sonarlog_obstacle_detection */
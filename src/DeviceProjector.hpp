@@ -0,0 +1,48 @@
+#ifndef DeviceProjector_hpp
+#define DeviceProjector_hpp
+
+#include <memory>
+#include <opencv2/opencv.hpp>
+#include <base/samples/Sonar.hpp>
+
+namespace sonarlog_obstacle_detection {
+
+struct SonarView;
+
+/*
+ * Cartesian image of the pings of one device.
+ *
+ * create() picks the profile (see DeviceProfile.hpp) matching a sample:
+ * a multibeam profile gathers into an image of a fixed size with a loop of
+ * fixed length, a scanning profile draws its beams on a ScanningCanvas of
+ * the profile sector, sized after the range of the pings up to the profile
+ * size. An unknown device uses a generic CartesianProjection sized after
+ * its pings.
+ */
+class DeviceProjector {
+public:
+
+    virtual ~DeviceProjector() {}
+
+    /* the profile name, "generic" for the fallback */
+    virtual const char* name() const = 0;
+
+    virtual bool scanning() const = 0;
+
+    /* adds a ping to the image and returns the region that changed */
+    virtual cv::Rect project(const base::samples::Sonar& sample) = 0;
+
+    /* the same for an aligned view, whose bins and bearings a multibeam projector reads in place */
+    virtual cv::Rect project(const SonarView& view) = 0;
+
+    /* CV_32FC1, the sonar at the bottom center (at the center for a scanning sonar) */
+    virtual cv::Mat image() const = 0;
+
+    static std::auto_ptr<DeviceProjector> create(const base::samples::Sonar& sample);
+
+    static std::auto_ptr<DeviceProjector> create(const SonarView& view);
+};
+
+} /* namespace sonarlog_obstacle_detection */
+
+#endif /* DeviceProjector_hpp */
@@ -0,0 +1,57 @@
+#ifndef Display_hpp
+#define Display_hpp
+
+#include <string>
+#include <opencv2/opencv.hpp>
+
+namespace sonarlog_obstacle_detection {
+
+/*
+ * Visualization sinks used inside the processing loops.
+ * Building with SONARLOG_HEADLESS defined (cmake -DHEADLESS=ON) compiles
+ * every call out; otherwise they can still be switched off at runtime,
+ * as Application does for --headless. The per-ping traces of the examples
+ * are only printed while the display is enabled.
+ */
+namespace display {
+
+#ifdef SONARLOG_HEADLESS
+
+inline void set_enabled(bool enabled) {}
+
+inline bool enabled() { return false; }
+
+inline void show(const std::string& name, const cv::Mat& mat) {}
+
+inline int wait(int delay = 0) { return -1; }
+
+#else
+
+inline bool& enabled_flag() {
+    static bool enabled = true;
+    return enabled;
+}
+
+inline void set_enabled(bool enabled) {
+    enabled_flag() = enabled;
+}
+
+inline bool enabled() {
+    return enabled_flag();
+}
+
+inline void show(const std::string& name, const cv::Mat& mat) {
+    if (enabled()) cv::imshow(name, mat);
+}
+
+inline int wait(int delay = 0) {
+    return (enabled()) ? cv::waitKey(delay) : -1;
+}
+
+#endif
+
+} /* namespace display */
+
+} /* namespace sonarlog_obstacle_detection */
+
+#endif /* Display_hpp */
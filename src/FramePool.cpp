@@ -0,0 +1,26 @@
+#include "sonarlog_obstacle_detection/FramePool.hpp"
+
+namespace sonarlog_obstacle_detection {
+
+FramePool::FramePool(size_t contour_capacity)
+    : allocations_(0)
+    , allocated_bytes_(0)
+    , requests_(0) {
+    contours_.reserve(contour_capacity);
+    indices_.reserve(contour_capacity);
+}
+
+cv::Mat& FramePool::get(FrameBuffer id, cv::Size size, int type) {
+    cv::Mat& buffer = buffers_[id];
+    requests_++;
+
+    if (buffer.size() != size || buffer.type() != type) {
+        buffer.create(size, type);
+        allocations_++;
+        allocated_bytes_ += buffer.total() * buffer.elemSize();
+    }
+
+    return buffer;
+}
+
+} /* namespace sonarlog_obstacle_detection */
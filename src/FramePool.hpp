@@ -0,0 +1,82 @@
+#ifndef FramePool_hpp
+#define FramePool_hpp
+
+#include <vector>
+#include <opencv2/opencv.hpp>
+
+namespace sonarlog_obstacle_detection {
+
+/* buffers of a detection pipeline */
+enum FrameBuffer {
+    BUFFER_BLURRED = 0,
+    BUFFER_FILTERED,
+    BUFFER_THRESH,
+    BUFFER_OPENED,
+    BUFFER_BLUR_BLOCK,
+    BUFFER_MORPHOLOGY_BLOCK,
+    BUFFER_BLOB_8U,
+    BUFFER_BLOB_CONTOURS,
+    BUFFER_BLOB_CANVAS,
+    BUFFER_BLOB_GRAY,
+    BUFFER_COUNT
+};
+
+/*
+ * Per-pipeline pool of the images and contour storage used on every ping.
+ *
+ * A buffer is allocated the first time it is requested and again only
+ * when the requested size or type changes, so a replay at a fixed geometry
+ * stops allocating after the first ping. The counters report how often
+ * that happened.
+ */
+class FramePool {
+public:
+
+    typedef std::vector<std::vector<cv::Point> > Contours;
+
+    FramePool(size_t contour_capacity = 256);
+
+    /* the buffer id with the given size and type */
+    cv::Mat& get(FrameBuffer id, cv::Size size, int type);
+
+    Contours& contours() {
+        return contours_;
+    }
+
+    std::vector<size_t>& indices() {
+        return indices_;
+    }
+
+    /* number of buffer (re)allocations since the last reset_counters() */
+    size_t allocations() const {
+        return allocations_;
+    }
+
+    size_t allocated_bytes() const {
+        return allocated_bytes_;
+    }
+
+    size_t requests() const {
+        return requests_;
+    }
+
+    void reset_counters() {
+        allocations_ = 0;
+        allocated_bytes_ = 0;
+        requests_ = 0;
+    }
+
+private:
+
+    cv::Mat buffers_[BUFFER_COUNT];
+    Contours contours_;
+    std::vector<size_t> indices_;
+
+    size_t allocations_;
+    size_t allocated_bytes_;
+    size_t requests_;
+};
+
+} /* namespace sonarlog_obstacle_detection */
+
+#endif /* FramePool_hpp */
@@ -0,0 +1,112 @@
+#include "sonarlog_obstacle_detection/Labeling.hpp"
+
+namespace sonarlog_obstacle_detection {
+
+namespace labeling {
+
+int Labeler::find(int label) {
+    while (parent_[label] != label) {
+        parent_[label] = parent_[parent_[label]];
+        label = parent_[label];
+    }
+    return label;
+}
+
+void Labeler::unite(int a, int b) {
+    a = find(a);
+    b = find(b);
+    if (a < b) parent_[b] = a;
+    else if (b < a) parent_[a] = b;
+}
+
+int Labeler::label(const cv::Mat& mask, const cv::Rect& region) {
+    CV_Assert(mask.type() == CV_8UC1);
+
+    cv::Rect roi = region & cv::Rect(0, 0, mask.cols, mask.rows);
+
+    if (labels_.size() != mask.size()) {
+        labels_.create(mask.size(), CV_32SC1);
+        labels_.setTo(0);
+    }
+    else {
+        labels_(labeled_).setTo(0);
+        labels_(roi).setTo(0);
+    }
+    labeled_ = roi;
+
+    parent_.clear();
+    parent_.push_back(0);
+    components_.clear();
+
+    // first pass: provisional labels from the already visited neighbours
+    for (int y = roi.y; y < roi.y + roi.height; y++) {
+        const uchar *m = mask.ptr<uchar>(y);
+        int *l = labels_.ptr<int>(y);
+        const int *up = (y > roi.y) ? labels_.ptr<int>(y - 1) : NULL;
+
+        for (int x = roi.x; x < roi.x + roi.width; x++) {
+            if (!m[x]) continue;
+
+            int neighbours[4] = {
+                (x > roi.x) ? l[x - 1] : 0,
+                (up && x > roi.x) ? up[x - 1] : 0,
+                (up) ? up[x] : 0,
+                (up && x + 1 < roi.x + roi.width) ? up[x + 1] : 0
+            };
+
+            int current = 0;
+            for (int i = 0; i < 4; i++) {
+                if (!neighbours[i]) continue;
+                if (!current) current = neighbours[i];
+                else if (neighbours[i] != current) unite(current, neighbours[i]);
+            }
+
+            if (!current) {
+                current = parent_.size();
+                parent_.push_back(current);
+            }
+
+            l[x] = current;
+        }
+    }
+
+    // second pass: final labels in order of first appearance and statistics
+    remap_.assign(parent_.size(), 0);
+    for (int y = roi.y; y < roi.y + roi.height; y++) {
+        int *l = labels_.ptr<int>(y);
+
+        for (int x = roi.x; x < roi.x + roi.width; x++) {
+            if (!l[x]) continue;
+
+            int root = find(l[x]);
+            if (!remap_[root]) {
+                Component component;
+                component.label = components_.size() + 1;
+                component.bbox = cv::Rect(x, y, 1, 1);
+                component.first = cv::Point(x, y);
+                components_.push_back(component);
+                remap_[root] = component.label;
+            }
+
+            Component& component = components_[remap_[root] - 1];
+            component.area++;
+            component.bbox |= cv::Rect(x, y, 1, 1);
+            l[x] = component.label;
+        }
+    }
+
+    return components_.size();
+}
+
+int Labeler::largest(int min_area) const {
+    int index = -1;
+    for (size_t i = 0; i < components_.size(); i++) {
+        if (components_[i].area < min_area) continue;
+        if (index < 0 || components_[i].area > components_[index].area) index = i;
+    }
+    return index;
+}
+
+} /* namespace labeling */
+
+} /* namespace sonarlog_obstacle_detection */
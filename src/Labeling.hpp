@@ -0,0 +1,74 @@
+#ifndef Labeling_hpp
+#define Labeling_hpp
+
+#include <vector>
+#include <opencv2/opencv.hpp>
+
+namespace sonarlog_obstacle_detection {
+
+/*
+ * 8-connected component labeling of binary grids (polar bins or image
+ * pixels) with two raster passes and a union-find over provisional labels.
+ * The label image and the work vectors are reused between calls.
+ */
+namespace labeling {
+
+struct Component {
+    Component()
+        : label(0)
+        , area(0) {
+    }
+
+    int label;
+    int area;
+    cv::Rect bbox;
+
+    // first element in raster order (smallest row, then smallest column)
+    cv::Point first;
+};
+
+class Labeler {
+public:
+
+    /*
+     * Labels the non-zero elements of mask (CV_8UC1) inside roi. Labels start
+     * at 1 and index components() - 1; elements outside roi are left at 0.
+     * Only the roi (and the roi of the previous call) is cleared, so a small
+     * roi costs its own area. Returns the number of components.
+     */
+    int label(const cv::Mat& mask, const cv::Rect& roi);
+
+    int label(const cv::Mat& mask) {
+        return label(mask, cv::Rect(0, 0, mask.cols, mask.rows));
+    }
+
+    /* CV_32SC1 label of every element of the last mask */
+    const cv::Mat& labels() const {
+        return labels_;
+    }
+
+    const std::vector<Component>& components() const {
+        return components_;
+    }
+
+    /* index of the component with the largest area, -1 if none reaches min_area */
+    int largest(int min_area = 1) const;
+
+private:
+
+    int find(int label);
+
+    void unite(int a, int b);
+
+    cv::Mat labels_;
+    cv::Rect labeled_;
+    std::vector<int> parent_;
+    std::vector<int> remap_;
+    std::vector<Component> components_;
+};
+
+} /* namespace labeling */
+
+} /* namespace sonarlog_obstacle_detection */
+
+#endif /* Labeling_hpp */
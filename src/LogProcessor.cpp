@@ -0,0 +1,369 @@
+#include <algorithm>
+#include <fstream>
+#include <limits>
+#include <sstream>
+#include <stdexcept>
+#include <boost/bind.hpp>
+#include <boost/filesystem.hpp>
+#include <opencv2/opencv.hpp>
+#include <base/samples/Sonar.hpp>
+#include "sonarlog_obstacle_detection/LogProcessor.hpp"
+#include "sonar_processing/ImageUtil.hpp"
+
+using namespace sonar_processing;
+
+namespace sonarlog_obstacle_detection {
+
+namespace {
+
+/* output of the plot sink, on its thread */
+void draw_plot(base::Plot *plot, const cv::Mat& mat) {
+    (*plot)(image_util::mat2vector<float>(mat));
+}
+
+}
+
+LogProcessor::LogProcessor(const std::string& filename, const std::string& stream_name,
+                           const ProcessingOptions& options)
+    : filename_(filename)
+    , stream_name_(stream_name)
+    , denoiser_(options.denoise_window)
+    , denoised_bins_(0)
+    , sparse_filter_(SparseBinFilter::SPATIO_TEMPORAL)
+    , ping_(0)
+    , detections_dropped_(0)
+    , options_(options)
+    , next_snapshot_(0) {
+    metrics_.add_stage("decode");
+    metrics_.add_stage("denoise");
+    metrics_.add_stage("process");
+    metrics_.add_stage("project");
+    metrics_.add_stage("sweep");
+    metrics_.add_stage("detect");
+
+    if (!options_.sweep.empty()) {
+        sweep_.reset(new ParameterSweep(ParameterSweep::parse(options_.sweep), options_.sweep_jobs));
+    }
+
+    if (options_.latency_budget > 0) {
+        DeadlineScheduler::Policy policy = DeadlineScheduler::DROP;
+        DeadlineScheduler::parse_policy(options_.realtime_policy, policy);
+        scheduler_ = DeadlineScheduler(options_.latency_budget, policy);
+        detector_.reset(new SsivDetector());
+    }
+
+    if (options_.detect()) polar_detector_.reset(new PolarDetector());
+}
+
+void LogProcessor::open_stream() {
+    if (reader_.get()) return;
+    reader_.reset(new rock_util::LogReader(filename_));
+    stream_ = reader_->stream(stream_name_);
+}
+
+void LogProcessor::process_next_sample() {
+    {
+        ScopedLatency latency(metrics_, STAGE_DECODE);
+        stream_.next<base::samples::Sonar>(sample_);
+    }
+    process_sample(sample_);
+}
+
+const base::samples::Sonar& LogProcessor::denoise(const base::samples::Sonar& sample) {
+    ScopedLatency latency(metrics_, STAGE_DENOISE);
+    denoised_bins_ += sample.bins.size();
+    return denoiser_.apply(sample);
+}
+
+void LogProcessor::process_sample(const base::samples::Sonar& raw) {
+    const base::samples::Sonar& sample = (options_.denoise) ? denoise(raw) : raw;
+
+    {
+        ScopedLatency latency(metrics_, STAGE_PROCESS);
+        throughput_.add(sample);
+    }
+
+    if (sweep_.get()) run_sweep(sample);
+    if (detector_.get()) run_realtime(sample);
+    if (polar_detector_.get()) detect(sample);
+    if (!options_.headless) display(sample);
+
+    ping_++;
+    metrics_.count(Metrics::PINGS_PROCESSED);
+
+    if (next_snapshot_ && Metrics::now() >= next_snapshot_) snapshot();
+}
+
+void LogProcessor::process_view(const SonarView& view) {
+    {
+        ScopedLatency latency(metrics_, STAGE_PROCESS);
+        throughput_.add(view);
+    }
+
+    if (sweep_.get()) run_sweep(view);
+    if (detector_.get()) run_realtime(view);
+    if (!options_.headless) display(view);
+
+    ping_++;
+    metrics_.count(Metrics::PINGS_PROCESSED);
+
+    if (next_snapshot_ && Metrics::now() >= next_snapshot_) snapshot();
+}
+
+template <class Ping>
+bool LogProcessor::project(const Ping& ping, cv::Rect& dirty) {
+    ScopedLatency latency(metrics_, STAGE_PROJECT);
+
+    // as test_ssiv_detection, the detectors see the canvas of the filtered pings
+    if (!sparse_filter_.push(ping)) return false;
+    const base::samples::Sonar& filtered = sparse_filter_.output();
+
+    if (!projector_.get()) {
+        projector_ = DeviceProjector::create(filtered);
+        if (!projector_->scanning()) {
+            throw std::runtime_error("the SSIV detector needs a scanning sonar, " + stream_name_ + " is " + projector_->name());
+        }
+    }
+
+    dirty = projector_->project(filtered);
+    return true;
+}
+
+template <class Ping>
+void LogProcessor::display(const Ping& ping) {
+    // the canvas of the detectors is shown as they see it, once the sparse filter is full
+    if (sweep_.get() || detector_.get()) {
+        if (projector_.get()) plot(projector_->image());
+        return;
+    }
+
+    // any other ping (e.g. multibeam) goes through the projection of its device profile
+    ScopedLatency latency(metrics_, STAGE_PROJECT);
+    if (!display_projector_.get()) display_projector_ = DeviceProjector::create(ping);
+    display_projector_->project(ping);
+    plot(display_projector_->image());
+}
+
+template <class Ping>
+void LogProcessor::run_sweep(const Ping& ping) {
+    cv::Rect dirty;
+    if (!project(ping, dirty)) return;
+
+    // the canvas holds the filtered ping, so its range and time go with it
+    ScopedLatency latency(metrics_, STAGE_SWEEP);
+    sweep_->process(projector_->image(), sparse_filter_.output(), dirty);
+}
+
+template <class Ping>
+void LogProcessor::run_realtime(const Ping& ping) {
+    DeadlineScheduler::Decision decision = scheduler_.arrive(ping.time);
+    uint64_t start = Metrics::now();
+
+    // the canvas takes every ping, the detection covers the dropped ones
+    cv::Rect dirty;
+    if (project(ping, dirty)) coalesced_ = (coalesced_.area()) ? (coalesced_ | dirty) : dirty;
+
+    if (decision == DeadlineScheduler::SKIP || !coalesced_.area()) {
+        if (decision == DeadlineScheduler::SKIP) metrics_.count(Metrics::PINGS_DROPPED);
+        scheduler_.finish((options_.pixel_cost > 0) ? 0 : (Metrics::now() - start) * 1e-9);
+        return;
+    }
+
+    detector_->set_skip((decision == DeadlineScheduler::RUN_DEGRADED) ?
+                        (SsivDetector::SKIP_SYMMETRIC_REMOVAL | SsivDetector::SKIP_MORPHOLOGY) :
+                        SsivDetector::SKIP_NONE);
+    // the deadline follows the newest ping, the detection the filtered one on the canvas
+    const base::samples::Sonar& drawn = sparse_filter_.output();
+    {
+        ScopedLatency latency(metrics_, STAGE_DETECT);
+        detector_->process(projector_->image(), drawn, coalesced_);
+    }
+    coalesced_ = cv::Rect();
+
+    if (decision == DeadlineScheduler::RUN_DEGRADED) metrics_.count(Metrics::PINGS_DEGRADED);
+    record(drawn.time, detector_->target());
+
+    size_t missed = scheduler_.stats().missed;
+    if (options_.pixel_cost > 0) scheduler_.finish(detector_->work() * options_.pixel_cost * 1e-9);
+    else scheduler_.finish((Metrics::now() - start) * 1e-9);
+    if (scheduler_.stats().missed > missed) metrics_.count(Metrics::DEADLINES_MISSED);
+}
+
+void LogProcessor::detect(const base::samples::Sonar& sample) {
+    ScopedLatency latency(metrics_, STAGE_DETECT);
+    polar_sweep_.update(sample);
+    record(sample.time, polar_detector_->process(polar_sweep_));
+}
+
+void LogProcessor::record(const base::Time& time, const detection::Target& target) {
+    if (!target.valid) return;
+
+    metrics_.count(Metrics::PINGS_DETECTED);
+    if (!options_.detect()) return;
+
+    detection::TimedTarget detection;
+    detection.time = time;
+    detection.ping = ping_;
+    detection.target = target;
+    detections_.push_back(detection);
+    if (writer_.get()) writer_->push(detection);
+}
+
+void LogProcessor::write_sweep(const std::string& prefix) const {
+    std::ofstream summary((prefix + ".sweep.csv").c_str());
+    std::ofstream tracks((prefix + ".tracks.csv").c_str());
+    if (!summary || !tracks) throw std::runtime_error("cannot write the sweep of " + filename_ + " to " + options_.sweep_output);
+
+    sweep_->write_summary(summary);
+    sweep_->write_tracks(tracks);
+}
+
+void LogProcessor::snapshot() {
+    next_snapshot_ = Metrics::now() + uint64_t(options_.metrics_interval * 1e9);
+
+    // a single write, so snapshots of concurrent files do not interleave
+    std::ostringstream out;
+    if (options_.metrics_format == "csv") metrics_.write_csv(out, filename_);
+    else metrics_.write_json(out, filename_);
+    std::cerr << out.str() << std::flush;
+}
+
+void LogProcessor::select_window(size_t& first, size_t& end) {
+    size_t total = stream_.total_samples();
+    first = std::min(options_.first_index, total);
+    end = (options_.last_index < total) ? options_.last_index + 1 : total;
+
+    if (!options_.time_window()) return;
+
+    index_.open(filename_, stream_name_, stream_);
+    if (index_.empty()) return;
+
+    base::Time start = index_.time(0);
+    first = std::max(first, index_.lower_bound(start + base::Time::fromSeconds(options_.from_time)));
+    if (options_.to_time != std::numeric_limits<double>::infinity()) {
+        end = std::min(end, index_.upper_bound(start + base::Time::fromSeconds(options_.to_time)));
+    }
+}
+
+void LogProcessor::start() {
+    denoiser_.reset();
+    denoised_bins_ = 0;
+
+    if (sweep_.get()) sweep_->reset();
+    scheduler_.reset();
+    sparse_filter_.reset();
+    projector_.reset();
+    display_projector_.reset();
+    coalesced_ = cv::Rect();
+    polar_sweep_.reset();
+    detections_.clear();
+    detections_dropped_ = 0;
+    writer_.reset();
+    ping_ = 0;
+
+    throughput_.start();
+    metrics_.reset();
+    next_snapshot_ = (options_.metrics_interval > 0) ? Metrics::now() + uint64_t(options_.metrics_interval * 1e9) : 0;
+}
+
+void LogProcessor::finish() {
+    throughput_.stop();
+}
+
+void LogProcessor::process_logfile() {
+    open_stream();
+    stream_.reset();
+
+    size_t first, end;
+    select_window(first, end);
+    if (first >= end) first = end = 0;
+
+    start();
+
+    if (options_.detect()) {
+        DetectionEncoder::Format format = DetectionEncoder::CSV;
+        DetectionEncoder::parse_format(options_.detections_format, format);
+        std::string path = (boost::filesystem::path(options_.detections_output) /
+                            boost::filesystem::path(filename_).stem()).string() + ".detections." + DetectionEncoder::extension(format);
+        writer_.reset(new DetectionWriter(path, format, std::vector<std::string>(1, stream_name_)));
+    }
+
+    if (options_.mmap) first = process_mapped(first, end);
+
+    if (first >= end) {
+        // every sample came from the mapped log
+    }
+    else if (!options_.queue_size) {
+        if (first) stream_.set_current_sample_index(first);
+        while (stream_.current_sample_index() < end) process_next_sample();
+    }
+    else {
+        if (first) stream_.set_current_sample_index(first);
+        SampleQueue queue(stream_, options_.queue_size, end);
+        queue.start();
+
+        for (;;) {
+            // with the reader thread ahead, decode only counts the wait for a sample
+            uint64_t start = Metrics::now();
+            const base::samples::Sonar *sample = queue.front();
+            metrics_.record(STAGE_DECODE, Metrics::now() - start);
+
+            if (!sample) break;
+            process_sample(*sample);
+            queue.pop();
+        }
+
+        queue_timing_ = queue.timing();
+    }
+
+    finish();
+
+    std::string prefix = (boost::filesystem::path(options_.sweep_output) /
+                          boost::filesystem::path(filename_).stem()).string();
+    if (sweep_.get()) write_sweep(prefix);
+
+    if (writer_.get()) {
+        writer_->close();
+        detections_dropped_ = writer_->dropped();
+        writer_.reset();
+    }
+}
+
+size_t LogProcessor::process_mapped(size_t first, size_t end) {
+    MappedLog log;
+    if (!log.open(filename_, stream_name_) || !log.uncompressed() || log.size() != stream_.total_samples()) {
+        return first;
+    }
+
+    SonarView view;
+    for (size_t i = first; i < end; i++) {
+        uint64_t start = Metrics::now();
+        bool valid = log.view(i, view);
+
+        // the sparse filter and the projectors read an aligned view, the denoiser and the polar sweep a sample
+        bool in_place = view.aligned && !options_.denoise && !polar_detector_.get();
+        if (valid && !in_place) view.copy_to(sample_);
+        metrics_.record(STAGE_DECODE, Metrics::now() - start);
+
+        // the copying reader continues from a sample it cannot map
+        if (!valid) return i;
+
+        if (in_place) process_view(view);
+        else process_sample(sample_);
+    }
+
+    return end;
+}
+
+void LogProcessor::plot(cv::Mat mat) {
+    if (options_.headless) return;
+
+    // the plot window and its thread start with the first frame
+    if (!plot_sink_.get()) {
+        plot_.reset(new base::Plot());
+        plot_sink_.reset(new PlotSink(boost::bind(&draw_plot, plot_.get(), _1), options_.plot_every, options_.plot_rate));
+    }
+    plot_sink_->push(mat);
+}
+
+} /* namespace sonarlog_obstacle_detection */
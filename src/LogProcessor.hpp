@@ -0,0 +1,235 @@
+#ifndef LogProcessor_hpp
+#define LogProcessor_hpp
+
+#include <iostream>
+#include <memory>
+#include <string>
+#include <opencv2/opencv.hpp>
+#include "rock_util/LogReader.hpp"
+#include "base/Plot.hpp"
+#include "sonarlog_obstacle_detection/BeamDenoiser.hpp"
+#include "sonarlog_obstacle_detection/DeadlineScheduler.hpp"
+#include "sonarlog_obstacle_detection/DetectionWriter.hpp"
+#include "sonarlog_obstacle_detection/DeviceProjector.hpp"
+#include "sonarlog_obstacle_detection/MappedLog.hpp"
+#include "sonarlog_obstacle_detection/Metrics.hpp"
+#include "sonarlog_obstacle_detection/ParameterSweep.hpp"
+#include "sonarlog_obstacle_detection/PlotSink.hpp"
+#include "sonarlog_obstacle_detection/PolarDetector.hpp"
+#include "sonarlog_obstacle_detection/PolarSweep.hpp"
+#include "sonarlog_obstacle_detection/ProcessingOptions.hpp"
+#include "sonarlog_obstacle_detection/SampleIndex.hpp"
+#include "sonarlog_obstacle_detection/SampleQueue.hpp"
+#include "sonarlog_obstacle_detection/SparseBinFilter.hpp"
+#include "sonarlog_obstacle_detection/Throughput.hpp"
+
+namespace sonarlog_obstacle_detection {
+
+/*
+ * Processing context of a single log stream. Every instance owns its
+ * reader, stream and filter state, so instances can run on different
+ * threads.
+ *
+ * process_logfile() reads the stream itself. A caller that reads the log
+ * (see MultiStreamProcessor) instead calls start(), process_sample() for
+ * every sample and finish(); the stream is then never opened.
+ */
+class LogProcessor {
+public:
+
+    LogProcessor(const std::string& filename, const std::string& stream_name,
+                 const ProcessingOptions& options = ProcessingOptions());
+
+    void process_logfile();
+
+    /* resets the filters, counters and throughput before the first sample */
+    void start();
+
+    void finish();
+
+    void process_next_sample();
+
+    void process_sample(const base::samples::Sonar& sample);
+
+    /*
+     * Processes an aligned sample in place in the mapped log: the sparse
+     * filter copies it into its window and the display projects it without
+     * a copy. The denoiser and the polar detector need process_sample().
+     */
+    void process_view(const SonarView& view);
+
+    /* queues mat for the plot sink, decimated and without waiting for gnuplot */
+    void plot(cv::Mat mat);
+
+    const std::string& filename() const {
+        return filename_;
+    }
+
+    const std::string& stream_name() const {
+        return stream_name_;
+    }
+
+    const Throughput& throughput() const {
+        return throughput_;
+    }
+
+    const SampleQueue::Timing& queue_timing() const {
+        return queue_timing_;
+    }
+
+    const Metrics& metrics() const {
+        return metrics_;
+    }
+
+    /* time spent in the denoising stage */
+    double denoise_seconds() const {
+        return metrics_.stage(STAGE_DENOISE).total() * 1e-9;
+    }
+
+    double denoise_bins_per_second() const {
+        double seconds = denoise_seconds();
+        return (seconds > 0) ? denoised_bins_ / seconds : 0;
+    }
+
+    /* the last ping given to the detectors after denoising (empty unless options.denoise) */
+    const base::samples::Sonar& denoised() const {
+        return denoiser_.output();
+    }
+
+    /* the grid of the polar detector (empty unless options.detect()) */
+    const PolarSweep& polar_sweep() const {
+        return polar_sweep_;
+    }
+
+    /* the parameter sweep (NULL unless options.sweep) */
+    const ParameterSweep* sweep() const {
+        return sweep_.get();
+    }
+
+    double sweep_seconds() const {
+        return metrics_.stage(STAGE_SWEEP).total() * 1e-9;
+    }
+
+    /* the real-time detector (NULL unless options.latency_budget) */
+    const SsivDetector* detector() const {
+        return detector_.get();
+    }
+
+    const DeadlineScheduler& scheduler() const {
+        return scheduler_;
+    }
+
+    /* the targets found since start() (empty unless options.detect()) */
+    const std::vector<detection::TimedTarget>& detections() const {
+        return detections_;
+    }
+
+    /* detections the writer of process_logfile() had no room for */
+    size_t detections_dropped() const {
+        return detections_dropped_;
+    }
+
+    /* writes <prefix>.sweep.csv and <prefix>.tracks.csv */
+    void write_sweep(const std::string& prefix) const;
+
+private:
+
+    enum Stage {
+        STAGE_DECODE,
+        STAGE_DENOISE,
+        STAGE_PROCESS,
+        STAGE_PROJECT,
+        STAGE_SWEEP,
+        STAGE_DETECT
+    };
+
+    /* the denoised copy of sample that the detection stages see */
+    const base::samples::Sonar& denoise(const base::samples::Sonar& sample);
+
+    void snapshot();
+
+    /*
+     * The stages below take a base::samples::Sonar or an aligned SonarView.
+     */
+
+    /* adds a scanning sonar ping to the canvas of its device profile; false while the sparse filter fills up */
+    template <class Ping>
+    bool project(const Ping& ping, cv::Rect& dirty);
+
+    /* projects a scanning sonar ping once and runs every sweep configuration on it */
+    template <class Ping>
+    void run_sweep(const Ping& ping);
+
+    /* SSIV detection of a ping within the latency budget */
+    template <class Ping>
+    void run_realtime(const Ping& ping);
+
+    /* plots the cartesian image of a ping, or the canvas of the detectors */
+    template <class Ping>
+    void display(const Ping& ping);
+
+    /* polar detection of a ping */
+    void detect(const base::samples::Sonar& sample);
+
+    void record(const base::Time& time, const detection::Target& target);
+
+    void open_stream();
+
+    /* processes [first, end) from the memory mapped log and returns the first sample left to the stream */
+    size_t process_mapped(size_t first, size_t end);
+
+    /* the samples [first, end) selected by the index and time options */
+    void select_window(size_t& first, size_t& end);
+
+    std::string filename_;
+    std::string stream_name_;
+    std::auto_ptr<rock_util::LogReader> reader_;
+    rock_util::LogStream stream_;
+    BeamDenoiser denoiser_;
+    size_t denoised_bins_;
+
+    // decode buffer reused by every ping
+    base::samples::Sonar sample_;
+
+    // created by the first plot(), so idle processors spawn no gnuplot
+    std::auto_ptr<base::Plot> plot_;
+
+    // draws on plot_ off the processing thread, destroyed before it
+    std::auto_ptr<PlotSink> plot_sink_;
+
+    // canvas shared by the configurations of a sweep or the real-time detector
+    std::auto_ptr<ParameterSweep> sweep_;
+    std::auto_ptr<DeviceProjector> projector_;
+
+    // projects the pings that no detector draws, to plot them
+    std::auto_ptr<DeviceProjector> display_projector_;
+    SparseBinFilter sparse_filter_;
+
+    std::auto_ptr<SsivDetector> detector_;
+    DeadlineScheduler scheduler_;
+
+    // canvas changed by the pings dropped since the last detection
+    cv::Rect coalesced_;
+
+    PolarSweep polar_sweep_;
+    std::auto_ptr<PolarDetector> polar_detector_;
+    std::vector<detection::TimedTarget> detections_;
+    size_t ping_;
+
+    // streams the detections to <log>.detections.<format> in process_logfile()
+    std::auto_ptr<DetectionWriter> writer_;
+    size_t detections_dropped_;
+
+    ProcessingOptions options_;
+    Throughput throughput_;
+    SampleQueue::Timing queue_timing_;
+
+    SampleIndex index_;
+
+    Metrics metrics_;
+    uint64_t next_snapshot_;
+};
+
+} /* namespace sonarlog_obstacle_detection */
+
+#endif /* LogProcessor_hpp */
@@ -0,0 +1,343 @@
+#include <cstring>
+#include <fcntl.h>
+#include <unistd.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include "sonarlog_obstacle_detection/MappedLog.hpp"
+
+namespace sonarlog_obstacle_detection {
+
+namespace {
+
+// pocolog file layout (little endian)
+const char POCOLOG_MAGIC[] = "POCOSIM";
+const size_t PROLOGUE_SIZE = 16;        // magic[7], padding, version, flags
+const size_t BLOCK_HEADER_SIZE = 8;     // type, padding, stream index, payload size
+const size_t DATA_HEADER_SIZE = 21;     // realtime, logical time, data size, compressed
+
+enum BlockType {
+    STREAM_BLOCK = 1,
+    DATA_BLOCK = 2
+};
+
+const uint8_t DATA_STREAM = 1;
+
+template <typename T>
+T read(const char *p) {
+    T value;
+    memcpy(&value, p, sizeof(T));
+    return value;
+}
+
+/* sequential reader over a bounded buffer */
+class Cursor {
+public:
+
+    Cursor(const char *data, size_t size)
+        : data_(data)
+        , size_(size)
+        , offset_(0)
+        , valid_(true) {
+    }
+
+    template <typename T>
+    T next() {
+        if (!skip(sizeof(T))) return T();
+        return read<T>(data_ + offset_ - sizeof(T));
+    }
+
+    const char* span(size_t bytes) {
+        if (!skip(bytes)) return NULL;
+        return data_ + offset_ - bytes;
+    }
+
+    bool skip(size_t bytes) {
+        if (!valid_ || bytes > size_ - offset_) {
+            valid_ = false;
+            return false;
+        }
+        offset_ += bytes;
+        return true;
+    }
+
+    std::string string() {
+        uint32_t length = next<uint32_t>();
+        const char *p = span(length);
+        return (p) ? std::string(p, length) : std::string();
+    }
+
+    bool valid() const {
+        return valid_;
+    }
+
+    bool finished() const {
+        return valid_ && offset_ == size_;
+    }
+
+private:
+
+    const char *data_;
+    size_t size_;
+    size_t offset_;
+    bool valid_;
+};
+
+/* value of attribute name in the XML tag, with the entities of typelib names decoded */
+std::string attribute(const std::string& tag, const std::string& name) {
+    std::string key = " " + name + "=\"";
+    size_t begin = tag.find(key);
+    if (begin == std::string::npos) return std::string();
+    begin += key.size();
+
+    size_t end = tag.find('"', begin);
+    if (end == std::string::npos) return std::string();
+
+    std::string value = tag.substr(begin, end - begin);
+    const char *entities[][2] = { { "&lt;", "<" }, { "&gt;", ">" }, { "&amp;", "&" } };
+    for (size_t i = 0; i < 3; i++) {
+        size_t pos;
+        while ((pos = value.find(entities[i][0])) != std::string::npos) value.replace(pos, strlen(entities[i][0]), entities[i][1]);
+    }
+    return value;
+}
+
+/* "name:type" of every field of the compound type_name in a typelib XML registry, empty if it is not declared */
+std::vector<std::string> compound_fields(const std::string& registry, const std::string& type_name) {
+    std::vector<std::string> fields;
+
+    size_t begin = 0;
+    while ((begin = registry.find("<compound ", begin)) != std::string::npos) {
+        size_t end = registry.find('>', begin);
+        if (end == std::string::npos) break;
+
+        if (attribute(registry.substr(begin, end - begin), "name") == type_name) {
+            size_t close = registry.find("</compound>", end);
+            if (close == std::string::npos) break;
+
+            size_t field = end;
+            while ((field = registry.find("<field ", field)) != std::string::npos && field < close) {
+                size_t field_end = registry.find('>', field);
+                std::string tag = registry.substr(field, field_end - field);
+                fields.push_back(attribute(tag, "name") + ":" + attribute(tag, "type"));
+                field = field_end;
+            }
+            break;
+        }
+        begin = end;
+    }
+
+    return fields;
+}
+
+bool same_fields(const std::vector<std::string>& fields, const char * const *expected, size_t count) {
+    return fields == std::vector<std::string>(expected, expected + count);
+}
+
+template <typename T>
+void append(std::vector<char>& data, const T& value) {
+    const char *p = reinterpret_cast<const char*>(&value);
+    data.insert(data.end(), p, p + sizeof(T));
+}
+
+}
+
+bool SonarView::parse(const char *data, size_t size) {
+    Cursor cursor(data, size);
+
+    time = base::Time::fromMicroseconds(cursor.next<int64_t>());
+    uint64_t timestamp_count = cursor.next<uint64_t>();
+    if (timestamp_count > size || !cursor.skip(timestamp_count * sizeof(int64_t))) return false;
+    bin_duration = base::Time::fromMicroseconds(cursor.next<int64_t>());
+    beam_width = base::Angle::fromRad(cursor.next<double>());
+    beam_height = base::Angle::fromRad(cursor.next<double>());
+
+    uint64_t bearing_count = cursor.next<uint64_t>();
+    if (bearing_count > size) return false;
+    bearings = reinterpret_cast<const double*>(cursor.span(bearing_count * sizeof(double)));
+
+    speed_of_sound = cursor.next<float>();
+    bin_count = cursor.next<uint32_t>();
+    beam_count = cursor.next<uint32_t>();
+
+    uint64_t bin_size = cursor.next<uint64_t>();
+    if (bin_size > size) return false;
+    bins = reinterpret_cast<const float*>(cursor.span(bin_size * sizeof(float)));
+
+    // spans are only handed out when the whole payload is a Sonar sample
+    if (!cursor.finished() ||
+        bearing_count != beam_count ||
+        bin_size != (uint64_t)bin_count * beam_count) {
+        return false;
+    }
+
+    // pocolog does not pad payloads, so the spans may be unaligned
+    aligned = !(reinterpret_cast<uintptr_t>(bins) % sizeof(float)) &&
+              !(reinterpret_cast<uintptr_t>(bearings) % sizeof(double));
+
+    return true;
+}
+
+void SonarView::copy_to(base::samples::Sonar& sample) const {
+    sample.time = time;
+    sample.timestamps.clear();
+    sample.bin_duration = bin_duration;
+    sample.beam_width = beam_width;
+    sample.beam_height = beam_height;
+    sample.speed_of_sound = speed_of_sound;
+    sample.bin_count = bin_count;
+    sample.beam_count = beam_count;
+
+    const char *bearing_data = reinterpret_cast<const char*>(bearings);
+    sample.bearings.resize(beam_count);
+    for (uint32_t i = 0; i < beam_count; i++) {
+        sample.bearings[i] = base::Angle::fromRad(read<double>(bearing_data + i * sizeof(double)));
+    }
+
+    sample.bins.resize((size_t)bin_count * beam_count);
+    if (!sample.bins.empty()) memcpy(&sample.bins[0], bins, sample.bins.size() * sizeof(float));
+}
+
+void SonarView::marshal(const base::samples::Sonar& sample, std::vector<char>& data) {
+    data.clear();
+    append(data, (int64_t)sample.time.toMicroseconds());
+    append(data, (uint64_t)sample.timestamps.size());
+    for (size_t i = 0; i < sample.timestamps.size(); i++) append(data, (int64_t)sample.timestamps[i].toMicroseconds());
+    append(data, (int64_t)sample.bin_duration.toMicroseconds());
+    append(data, sample.beam_width.getRad());
+    append(data, sample.beam_height.getRad());
+    append(data, (uint64_t)sample.bearings.size());
+    for (size_t i = 0; i < sample.bearings.size(); i++) append(data, sample.bearings[i].getRad());
+    append(data, sample.speed_of_sound);
+    append(data, sample.bin_count);
+    append(data, sample.beam_count);
+    append(data, (uint64_t)sample.bins.size());
+    for (size_t i = 0; i < sample.bins.size(); i++) append(data, sample.bins[i]);
+}
+
+bool SonarView::matches_layout(const std::string& type_name, const std::string& registry) {
+    static const char * const sonar[] = {
+        "time:/base/Time",
+        "timestamps:/std/vector</base/Time>",
+        "bin_duration:/base/Time",
+        "beam_width:/base/Angle",
+        "beam_height:/base/Angle",
+        "bearings:/std/vector</base/Angle>",
+        "speed_of_sound:/float",
+        "bin_count:/uint32_t",
+        "beam_count:/uint32_t",
+        "bins:/std/vector</float>"
+    };
+    static const char * const time[] = { "microseconds:/int64_t" };
+    static const char * const angle[] = { "rad:/double" };
+
+    return type_name == "/base/samples/Sonar" &&
+           same_fields(compound_fields(registry, "/base/samples/Sonar"), sonar, sizeof(sonar) / sizeof(sonar[0])) &&
+           same_fields(compound_fields(registry, "/base/Time"), time, 1) &&
+           same_fields(compound_fields(registry, "/base/Angle"), angle, 1);
+}
+
+MappedLog::MappedLog()
+    : data_(NULL)
+    , size_(0)
+    , uncompressed_(false) {
+}
+
+MappedLog::~MappedLog() {
+    close();
+}
+
+bool MappedLog::open(const std::string& filename, const std::string& stream_name) {
+    close();
+
+    int fd = ::open(filename.c_str(), O_RDONLY);
+    if (fd < 0) return false;
+
+    struct stat st;
+    if (fstat(fd, &st) < 0 || (size_t)st.st_size < PROLOGUE_SIZE) {
+        ::close(fd);
+        return false;
+    }
+
+    void *data = mmap(NULL, st.st_size, PROT_READ, MAP_PRIVATE, fd, 0);
+    ::close(fd);
+    if (data == MAP_FAILED) return false;
+
+    // samples are read in order
+    madvise(data, st.st_size, MADV_SEQUENTIAL);
+
+    data_ = static_cast<const char*>(data);
+    size_ = st.st_size;
+
+    if (!index_blocks(stream_name)) {
+        close();
+        return false;
+    }
+
+    return true;
+}
+
+void MappedLog::close() {
+    if (data_) munmap(const_cast<char*>(data_), size_);
+    data_ = NULL;
+    size_ = 0;
+    samples_.clear();
+    uncompressed_ = false;
+}
+
+bool MappedLog::index_blocks(const std::string& stream_name) {
+    if (memcmp(data_, POCOLOG_MAGIC, sizeof(POCOLOG_MAGIC) - 1)) return false;
+
+    uint32_t version = read<uint32_t>(data_ + 8);
+    uint32_t big_endian = read<uint32_t>(data_ + 12);
+    if (version < 1 || version > 2 || big_endian) return false;
+
+    bool found = false;
+    uint16_t stream_index = 0;
+    uncompressed_ = true;
+
+    size_t offset = PROLOGUE_SIZE;
+    while (offset + BLOCK_HEADER_SIZE <= size_) {
+        uint8_t type = read<uint8_t>(data_ + offset);
+        uint16_t index = read<uint16_t>(data_ + offset + 2);
+        uint32_t payload_size = read<uint32_t>(data_ + offset + 4);
+
+        const char *payload = data_ + offset + BLOCK_HEADER_SIZE;
+        if (payload_size > size_ - offset - BLOCK_HEADER_SIZE) break;   // truncated log
+
+        if (type == STREAM_BLOCK && !found) {
+            // stream type, name, type name, typelib registry and (version 2) metadata
+            Cursor cursor(payload, payload_size);
+            if (cursor.next<uint8_t>() == DATA_STREAM && cursor.string() == stream_name && cursor.valid()) {
+                std::string type_name = cursor.string();
+                std::string registry = cursor.string();
+
+                // samples of an unexpected layout are left to the decoder
+                if (!cursor.valid() || !SonarView::matches_layout(type_name, registry)) return false;
+
+                stream_index = index;
+                found = true;
+            }
+        }
+        else if (type == DATA_BLOCK && found && index == stream_index && payload_size >= DATA_HEADER_SIZE) {
+            Sample sample;
+            sample.size = read<uint32_t>(payload + 16);
+            sample.compressed = read<uint8_t>(payload + 20) != 0;
+            sample.offset = (payload - data_) + DATA_HEADER_SIZE;
+            if (sample.size > payload_size - DATA_HEADER_SIZE) return false;
+
+            uncompressed_ = uncompressed_ && !sample.compressed;
+            samples_.push_back(sample);
+        }
+
+        offset += BLOCK_HEADER_SIZE + payload_size;
+    }
+
+    return found;
+}
+
+bool MappedLog::view(size_t index, SonarView& view) const {
+    if (index >= samples_.size() || samples_[index].compressed) return false;
+    return view.parse(data_ + samples_[index].offset, samples_[index].size);
+}
+
+} /* namespace sonarlog_obstacle_detection */
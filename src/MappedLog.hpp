@@ -0,0 +1,118 @@
+#ifndef MappedLog_hpp
+#define MappedLog_hpp
+
+#include <string>
+#include <vector>
+#include <stdint.h>
+#include <base/Time.hpp>
+#include <base/Angle.hpp>
+#include <base/samples/Sonar.hpp>
+
+namespace sonarlog_obstacle_detection {
+
+/*
+ * Read-only view of a marshalled base::samples::Sonar. The header fields
+ * are decoded; bins and bearings point into the buffer the view was
+ * parsed from and stay valid as long as that buffer.
+ */
+struct SonarView {
+    SonarView()
+        : speed_of_sound(0)
+        , bin_count(0)
+        , beam_count(0)
+        , bins(NULL)
+        , bearings(NULL)
+        , aligned(false) {
+    }
+
+    base::Time time;
+    base::Time bin_duration;
+    base::Angle beam_width;
+    base::Angle beam_height;
+    float speed_of_sound;
+    uint32_t bin_count;
+    uint32_t beam_count;
+
+    // bin_count * beam_count bins, beam-major
+    const float *bins;
+
+    // beam_count bearings in radians
+    const double *bearings;
+
+    // bins and bearings can be read in place; otherwise use copy_to()
+    bool aligned;
+
+    /* decodes a typelib marshalled sample, returns false if the layout does not match */
+    bool parse(const char *data, size_t size);
+
+    /* copies the view into sample, reusing its storage */
+    void copy_to(base::samples::Sonar& sample) const;
+
+    /* typelib marshalling of sample, as written in uncompressed pocolog logs */
+    static void marshal(const base::samples::Sonar& sample, std::vector<char>& data);
+
+    /*
+     * True if type_name is /base/samples/Sonar and the typelib registry of
+     * its stream declares the fields, in marshalling order, that parse()
+     * reads. Typelib marshals the fields of a compound in order without
+     * their padding, and a container as its uint64 size then its elements.
+     */
+    static bool matches_layout(const std::string& type_name, const std::string& registry);
+};
+
+/*
+ * Memory mapped pocolog file. The stream declarations and data blocks are
+ * located once, then every sample of an uncompressed stream is exposed as
+ * a SonarView over the mapping, without copying its bins.
+ *
+ * A stream whose declared type layout differs from the one SonarView
+ * parses is not opened. Compressed samples, unknown format versions or a
+ * payload that does not match the Sonar layout make view() fail; callers
+ * then fall back to the rock_util reader.
+ */
+class MappedLog {
+public:
+
+    MappedLog();
+
+    ~MappedLog();
+
+    /* maps the file and indexes the samples of stream_name */
+    bool open(const std::string& filename, const std::string& stream_name);
+
+    void close();
+
+    bool is_open() const {
+        return data_ != NULL;
+    }
+
+    size_t size() const {
+        return samples_.size();
+    }
+
+    /* true if every sample of the stream is stored uncompressed */
+    bool uncompressed() const {
+        return uncompressed_;
+    }
+
+    bool view(size_t index, SonarView& view) const;
+
+private:
+
+    struct Sample {
+        size_t offset;
+        size_t size;
+        bool compressed;
+    };
+
+    bool index_blocks(const std::string& stream_name);
+
+    const char *data_;
+    size_t size_;
+    std::vector<Sample> samples_;
+    bool uncompressed_;
+};
+
+} /* namespace sonarlog_obstacle_detection */
+
+#endif /* MappedLog_hpp */
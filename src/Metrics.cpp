@@ -0,0 +1,122 @@
+#include <algorithm>
+#include <cstring>
+#include <iomanip>
+#include "sonarlog_obstacle_detection/Metrics.hpp"
+
+namespace sonarlog_obstacle_detection {
+
+void LatencyHistogram::reset() {
+    memset(buckets_, 0, sizeof(buckets_));
+    count_ = 0;
+    total_ = 0;
+    max_ = 0;
+}
+
+void LatencyHistogram::merge(const LatencyHistogram& other) {
+    for (size_t i = 0; i < BUCKET_COUNT; i++) buckets_[i] += other.buckets_[i];
+    count_ += other.count_;
+    total_ += other.total_;
+    if (other.max_ > max_) max_ = other.max_;
+}
+
+uint64_t LatencyHistogram::bucket_limit(size_t index) {
+    // values below SUB_BUCKETS have a bucket each, the next indices are unused
+    if (index < 2 * SUB_BUCKETS) return std::min<uint64_t>(index, SUB_BUCKETS - 1);
+    size_t octave = index / SUB_BUCKETS;
+    size_t sub = index % SUB_BUCKETS;
+    uint64_t step = 1ULL << (octave - 2);
+    return (1ULL << octave) + (sub + 1) * step - 1;
+}
+
+uint64_t LatencyHistogram::percentile(double p) const {
+    if (!count_) return 0;
+
+    uint64_t rank = uint64_t(p * count_ + 0.5);
+    if (rank < 1) rank = 1;
+    if (rank > count_) rank = count_;
+
+    uint64_t seen = 0;
+    for (size_t i = 0; i < BUCKET_COUNT; i++) {
+        seen += buckets_[i];
+        if (seen >= rank) return std::min(bucket_limit(i), max_);
+    }
+    return max_;
+}
+
+Metrics::Metrics() {
+    reset();
+}
+
+size_t Metrics::add_stage(const std::string& name) {
+    names_.push_back(name);
+    stages_.push_back(LatencyHistogram());
+    return stages_.size() - 1;
+}
+
+void Metrics::reset() {
+    for (size_t i = 0; i < stages_.size(); i++) stages_[i].reset();
+    memset(counters_, 0, sizeof(counters_));
+}
+
+const char* Metrics::counter_name(Counter counter) {
+    switch (counter) {
+        case PINGS_PROCESSED: return "pings_processed";
+        case PINGS_DROPPED: return "pings_dropped";
+        case PINGS_DETECTED: return "pings_detected";
+        case PINGS_DEGRADED: return "pings_degraded";
+        case DEADLINES_MISSED: return "deadlines_missed";
+        default: return "unknown";
+    }
+}
+
+void Metrics::write_json(std::ostream& out, const std::string& label) const {
+    std::ios::fmtflags flags = out.flags();
+    out << std::fixed << std::setprecision(3);
+
+    out << "{\"file\": \"" << label << "\"";
+    for (size_t i = 0; i < COUNTER_COUNT; i++) {
+        out << ", \"" << counter_name(Counter(i)) << "\": " << counters_[i];
+    }
+
+    out << ", \"stages\": {";
+    for (size_t i = 0; i < stages_.size(); i++) {
+        const LatencyHistogram& h = stages_[i];
+        out << ((i) ? ", " : "") << "\"" << names_[i] << "\": {"
+            << "\"count\": " << h.count()
+            << ", \"mean_us\": " << h.mean() / 1e3
+            << ", \"p50_us\": " << h.percentile(0.50) / 1e3
+            << ", \"p95_us\": " << h.percentile(0.95) / 1e3
+            << ", \"p99_us\": " << h.percentile(0.99) / 1e3
+            << ", \"max_us\": " << h.max() / 1e3 << "}";
+    }
+    out << "}}" << std::endl;
+
+    out.flags(flags);
+}
+
+void Metrics::write_csv_header(std::ostream& out) {
+    out << "file,metric,count,mean_us,p50_us,p95_us,p99_us,max_us" << std::endl;
+}
+
+void Metrics::write_csv(std::ostream& out, const std::string& label) const {
+    std::ios::fmtflags flags = out.flags();
+    out << std::fixed << std::setprecision(3);
+
+    for (size_t i = 0; i < COUNTER_COUNT; i++) {
+        out << label << "," << counter_name(Counter(i)) << "," << counters_[i] << ",,,,," << std::endl;
+    }
+
+    for (size_t i = 0; i < stages_.size(); i++) {
+        const LatencyHistogram& h = stages_[i];
+        out << label << "," << names_[i] << "," << h.count() << ","
+            << h.mean() / 1e3 << ","
+            << h.percentile(0.50) / 1e3 << ","
+            << h.percentile(0.95) / 1e3 << ","
+            << h.percentile(0.99) / 1e3 << ","
+            << h.max() / 1e3 << std::endl;
+    }
+
+    out.flags(flags);
+}
+
+} /* namespace sonarlog_obstacle_detection */
@@ -0,0 +1,172 @@
+#ifndef Metrics_hpp
+#define Metrics_hpp
+
+#include <iostream>
+#include <string>
+#include <vector>
+#include <stdint.h>
+#include <time.h>
+
+namespace sonarlog_obstacle_detection {
+
+/*
+ * Latency histogram with fixed log-linear buckets: every power of two of
+ * nanoseconds is split in four, so a percentile is known within 25% and
+ * recording a value is a count-leading-zeros and an increment.
+ */
+class LatencyHistogram {
+public:
+
+    static const size_t SUB_BUCKETS = 4;
+    static const size_t BUCKET_COUNT = 64 * SUB_BUCKETS;
+
+    LatencyHistogram() {
+        reset();
+    }
+
+    void record(uint64_t nanoseconds) {
+        buckets_[bucket(nanoseconds)]++;
+        count_++;
+        total_ += nanoseconds;
+        if (nanoseconds > max_) max_ = nanoseconds;
+    }
+
+    void reset();
+
+    void merge(const LatencyHistogram& other);
+
+    uint64_t count() const {
+        return count_;
+    }
+
+    uint64_t max() const {
+        return max_;
+    }
+
+    /* sum of the recorded values */
+    uint64_t total() const {
+        return total_;
+    }
+
+    double mean() const {
+        return (count_) ? double(total_) / count_ : 0;
+    }
+
+    /* upper bound (nanoseconds) of the bucket holding the p-th quantile, p in [0, 1] */
+    uint64_t percentile(double p) const;
+
+    static size_t bucket(uint64_t nanoseconds) {
+        if (nanoseconds < SUB_BUCKETS) return nanoseconds;
+        size_t octave = 63 - __builtin_clzll(nanoseconds);
+        size_t sub = (nanoseconds >> (octave - 2)) & (SUB_BUCKETS - 1);
+        return octave * SUB_BUCKETS + sub;
+    }
+
+    /* largest value that falls into bucket index */
+    static uint64_t bucket_limit(size_t index);
+
+private:
+
+    uint64_t buckets_[BUCKET_COUNT];
+    uint64_t count_;
+    uint64_t total_;
+    uint64_t max_;
+};
+
+/*
+ * Hot-path instrumentation of a processing loop: one latency histogram per
+ * named stage and a few counters, summarized as JSON or CSV.
+ *
+ * An instance belongs to one thread; snapshots are written by that thread.
+ */
+class Metrics {
+public:
+
+    enum Counter {
+        PINGS_PROCESSED,
+        PINGS_DROPPED,
+        PINGS_DETECTED,
+        PINGS_DEGRADED,
+        DEADLINES_MISSED,
+        COUNTER_COUNT
+    };
+
+    Metrics();
+
+    /* registers a stage and returns its index */
+    size_t add_stage(const std::string& name);
+
+    void record(size_t stage, uint64_t nanoseconds) {
+        stages_[stage].record(nanoseconds);
+    }
+
+    void count(Counter counter, uint64_t n = 1) {
+        counters_[counter] += n;
+    }
+
+    uint64_t counter(Counter counter) const {
+        return counters_[counter];
+    }
+
+    size_t stage_count() const {
+        return stages_.size();
+    }
+
+    const std::string& stage_name(size_t stage) const {
+        return names_[stage];
+    }
+
+    const LatencyHistogram& stage(size_t stage) const {
+        return stages_[stage];
+    }
+
+    void reset();
+
+    /* one JSON object in a single line */
+    void write_json(std::ostream& out, const std::string& label) const;
+
+    /* one row per stage and per counter */
+    void write_csv(std::ostream& out, const std::string& label) const;
+
+    static void write_csv_header(std::ostream& out);
+
+    static const char* counter_name(Counter counter);
+
+    /* monotonic clock in nanoseconds */
+    static uint64_t now() {
+        timespec ts;
+        clock_gettime(CLOCK_MONOTONIC, &ts);
+        return uint64_t(ts.tv_sec) * 1000000000ULL + ts.tv_nsec;
+    }
+
+private:
+
+    std::vector<std::string> names_;
+    std::vector<LatencyHistogram> stages_;
+    uint64_t counters_[COUNTER_COUNT];
+};
+
+/* records the lifetime of the instance into a stage */
+class ScopedLatency {
+public:
+
+    ScopedLatency(Metrics& metrics, size_t stage)
+        : metrics_(metrics)
+        , stage_(stage)
+        , start_(Metrics::now()) {
+    }
+
+    ~ScopedLatency() {
+        metrics_.record(stage_, Metrics::now() - start_);
+    }
+
+private:
+
+    Metrics& metrics_;
+    size_t stage_;
+    uint64_t start_;
+};
+
+} /* namespace sonarlog_obstacle_detection */
+
+#endif /* Metrics_hpp */
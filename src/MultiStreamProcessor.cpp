@@ -0,0 +1,229 @@
+#include <algorithm>
+#include <limits>
+#include <stdexcept>
+#include <boost/bind.hpp>
+#include <boost/filesystem.hpp>
+#include "sonarlog_obstacle_detection/DetectionWriter.hpp"
+#include "sonarlog_obstacle_detection/MultiStreamProcessor.hpp"
+
+namespace sonarlog_obstacle_detection {
+
+namespace {
+
+bool earlier(const detection::TimedTarget& a, const detection::TimedTarget& b) {
+    return a.time < b.time;
+}
+
+}
+
+MultiStreamProcessor::MultiStreamProcessor(const std::string& filename, const std::vector<std::string>& stream_names,
+                                           const ProcessingOptions& options)
+    : filename_(filename)
+    , stream_names_(stream_names)
+    , options_(options) {
+    for (size_t i = 0; i < stream_names_.size(); i++) {
+        processors_.push_back(boost::shared_ptr<LogProcessor>(new LogProcessor(filename_, stream_names_[i], options_)));
+
+        // one more slot than queue_size holds the sample waiting for the merge
+        boost::shared_ptr<Channel> channel(new Channel());
+        channel->slots.resize(std::max<size_t>(options_.queue_size, 1) + 1);
+        channels_.push_back(channel);
+    }
+}
+
+MultiStreamProcessor::~MultiStreamProcessor() {
+    close_channels();
+    workers_.join_all();
+}
+
+bool MultiStreamProcessor::read_next(size_t stream) {
+    rock_util::LogStream& log_stream = streams_[stream];
+    if (log_stream.current_sample_index() >= ends_[stream]) return false;
+
+    Channel& channel = *channels_[stream];
+    {
+        boost::mutex::scoped_lock lock(channel.mutex);
+        if (channel.count == channel.slots.size()) {
+            base::Time start = base::Time::now();
+            while (channel.count == channel.slots.size()) channel.not_full.wait(lock);
+            reader_wait_ = reader_wait_ + (base::Time::now() - start);
+        }
+    }
+
+    // the worker never touches the slot after the published ones
+    base::Time start = base::Time::now();
+    log_stream.next<base::samples::Sonar>(channel.slots[channel.tail]);
+    decode_time_ = decode_time_ + (base::Time::now() - start);
+    return true;
+}
+
+void MultiStreamProcessor::publish(size_t stream) {
+    Channel& channel = *channels_[stream];
+    channel.tail = (channel.tail + 1) % channel.slots.size();
+    {
+        boost::mutex::scoped_lock lock(channel.mutex);
+        channel.count++;
+    }
+    channel.not_empty.notify_one();
+}
+
+void MultiStreamProcessor::close_channels() {
+    for (size_t i = 0; i < channels_.size(); i++) {
+        {
+            boost::mutex::scoped_lock lock(channels_[i]->mutex);
+            channels_[i]->finished = true;
+        }
+        channels_[i]->not_empty.notify_one();
+    }
+}
+
+void MultiStreamProcessor::run_worker(size_t stream) {
+    Channel& channel = *channels_[stream];
+    LogProcessor& processor = *processors_[stream];
+
+    for (;;) {
+        const base::samples::Sonar *sample;
+        {
+            boost::mutex::scoped_lock lock(channel.mutex);
+            while (!channel.count && !channel.finished) channel.not_empty.wait(lock);
+            if (!channel.count) break;
+            sample = &channel.slots[channel.head];
+        }
+
+        // after an error the samples are only drained, so the reader never blocks
+        if (channel.error.empty()) {
+            try {
+                processor.process_sample(*sample);
+            } catch (std::exception& e) {
+                channel.error = e.what();
+            }
+        }
+
+        {
+            boost::mutex::scoped_lock lock(channel.mutex);
+            channel.head = (channel.head + 1) % channel.slots.size();
+            channel.count--;
+        }
+        channel.not_full.notify_one();
+    }
+
+    processor.finish();
+}
+
+void MultiStreamProcessor::process_logfile() {
+    reader_.reset(new rock_util::LogReader(filename_));
+    streams_.clear();
+    ends_.clear();
+    for (size_t i = 0; i < stream_names_.size(); i++) {
+        streams_.push_back(reader_->stream(stream_names_[i]));
+
+        size_t total = streams_[i].total_samples();
+        size_t first = std::min(options_.first_index, total);
+        ends_.push_back((options_.last_index < total) ? options_.last_index + 1 : total);
+        if (first) streams_[i].set_current_sample_index(first);
+    }
+
+    throughput_.start();
+    decode_time_ = reader_wait_ = base::Time();
+
+    for (size_t i = 0; i < processors_.size(); i++) {
+        Channel& channel = *channels_[i];
+        channel.head = channel.tail = channel.count = 0;
+        channel.finished = false;
+        channel.error.clear();
+
+        processors_[i]->start();
+        workers_.create_thread(boost::bind(&MultiStreamProcessor::run_worker, this, i));
+    }
+
+    std::string error;
+    try {
+        std::vector<bool> pending(streams_.size());
+        for (size_t i = 0; i < streams_.size(); i++) pending[i] = read_next(i);
+
+        // the time window starts at the first sample of any stream
+        base::Time first_time;
+        bool has_first = false;
+        for (size_t i = 0; i < streams_.size(); i++) {
+            if (!pending[i]) continue;
+            const base::Time& time = next_sample(i).time;
+            if (!has_first || time < first_time) first_time = time;
+            has_first = true;
+        }
+        base::Time from = first_time + base::Time::fromSeconds(options_.from_time);
+        bool limited = options_.to_time != std::numeric_limits<double>::infinity();
+        base::Time to = limited ? first_time + base::Time::fromSeconds(options_.to_time) : base::Time();
+
+        for (;;) {
+            // the stream whose next sample is the oldest
+            size_t next = streams_.size();
+            base::Time next_time;
+            for (size_t i = 0; i < streams_.size(); i++) {
+                if (!pending[i]) continue;
+                if (next == streams_.size() || next_sample(i).time < next_time) {
+                    next = i;
+                    next_time = next_sample(i).time;
+                }
+            }
+            if (next == streams_.size()) break;
+
+            if (limited && next_time > to) {
+                pending[next] = false;
+                continue;
+            }
+
+            // a sample before the window is decoded again into the same slot
+            if (!(next_time < from)) {
+                throughput_.add(next_sample(next));
+                publish(next);
+            }
+            pending[next] = read_next(next);
+        }
+    } catch (std::exception& e) {
+        error = e.what();
+    }
+
+    close_channels();
+    workers_.join_all();
+    throughput_.stop();
+
+    if (!error.empty()) throw std::runtime_error(error);
+    for (size_t i = 0; i < channels_.size(); i++) {
+        if (!channels_[i]->error.empty()) throw std::runtime_error(stream_names_[i] + ": " + channels_[i]->error);
+    }
+
+    merge_detections();
+
+    std::string prefix = (boost::filesystem::path(options_.sweep_output) /
+                          boost::filesystem::path(filename_).stem()).string();
+    for (size_t i = 0; i < processors_.size(); i++) {
+        if (processors_[i]->sweep()) processors_[i]->write_sweep(prefix + "." + stream_names_[i]);
+    }
+
+    if (options_.detect()) {
+        DetectionEncoder::Format format = DetectionEncoder::CSV;
+        DetectionEncoder::parse_format(options_.detections_format, format);
+        std::string path = (boost::filesystem::path(options_.detections_output) /
+                            boost::filesystem::path(filename_).stem()).string() + ".detections." + DetectionEncoder::extension(format);
+
+        // the merge needs every stream, so the writer takes them all at the end (a ring that fits them)
+        DetectionWriter writer(path, format, stream_names_, detections_.size() + 1);
+        for (size_t i = 0; i < detections_.size(); i++) writer.push(detections_[i]);
+        writer.close();
+    }
+}
+
+void MultiStreamProcessor::merge_detections() {
+    detections_.clear();
+    for (size_t i = 0; i < processors_.size(); i++) {
+        const std::vector<detection::TimedTarget>& detections = processors_[i]->detections();
+        size_t middle = detections_.size();
+        detections_.insert(detections_.end(), detections.begin(), detections.end());
+        for (size_t j = middle; j < detections_.size(); j++) detections_[j].stream = i;
+
+        // every stream is in time order, so a merge of the sorted runs is enough
+        std::inplace_merge(detections_.begin(), detections_.begin() + middle, detections_.end(), earlier);
+    }
+}
+
+} /* namespace sonarlog_obstacle_detection */
@@ -0,0 +1,137 @@
+#ifndef MultiStreamProcessor_hpp
+#define MultiStreamProcessor_hpp
+
+#include <memory>
+#include <string>
+#include <vector>
+#include <boost/shared_ptr.hpp>
+#include <boost/thread/thread.hpp>
+#include <boost/thread/mutex.hpp>
+#include <boost/thread/condition_variable.hpp>
+#include <base/Time.hpp>
+#include <base/samples/Sonar.hpp>
+#include "rock_util/LogReader.hpp"
+#include "sonarlog_obstacle_detection/Detection.hpp"
+#include "sonarlog_obstacle_detection/LogProcessor.hpp"
+#include "sonarlog_obstacle_detection/ProcessingOptions.hpp"
+#include "sonarlog_obstacle_detection/Throughput.hpp"
+
+namespace sonarlog_obstacle_detection {
+
+/*
+ * Processes several sonar streams of one log in a single pass.
+ *
+ * The calling thread reads the streams merged in timestamp order: it keeps
+ * the next decoded sample of every stream and hands out the oldest one.
+ * Every stream has its own LogProcessor on a worker thread, fed through a
+ * bounded ring of sample buffers that the reader decodes into. The
+ * detections of all streams are merged by time at the end.
+ *
+ * The sample window options count the samples of every stream; the time
+ * window starts at the first sample of any stream.
+ */
+class MultiStreamProcessor {
+public:
+
+    MultiStreamProcessor(const std::string& filename, const std::vector<std::string>& stream_names,
+                         const ProcessingOptions& options = ProcessingOptions());
+
+    ~MultiStreamProcessor();
+
+    void process_logfile();
+
+    const std::string& filename() const {
+        return filename_;
+    }
+
+    size_t stream_count() const {
+        return stream_names_.size();
+    }
+
+    const std::vector<std::string>& stream_names() const {
+        return stream_names_;
+    }
+
+    const LogProcessor& processor(size_t stream) const {
+        return *processors_[stream];
+    }
+
+    /* the detections of every stream ordered by time */
+    const std::vector<detection::TimedTarget>& detections() const {
+        return detections_;
+    }
+
+    /* the pings of every stream over the time of the whole pass */
+    const Throughput& throughput() const {
+        return throughput_;
+    }
+
+    /* time spent decoding and waiting for a full ring in the reader thread */
+    const base::Time& decode_time() const {
+        return decode_time_;
+    }
+
+    const base::Time& reader_wait() const {
+        return reader_wait_;
+    }
+
+private:
+
+    struct Channel {
+        Channel()
+            : head(0)
+            , tail(0)
+            , count(0)
+            , finished(false) {
+        }
+
+        std::vector<base::samples::Sonar> slots;
+        size_t head;
+
+        // slots[tail] holds the next sample of the merge (reader thread only)
+        size_t tail;
+        size_t count;
+        bool finished;
+        std::string error;
+
+        boost::mutex mutex;
+        boost::condition_variable not_empty;
+        boost::condition_variable not_full;
+    };
+
+    /* decodes the next sample of stream into its free slot, false at the end of the stream */
+    bool read_next(size_t stream);
+
+    void publish(size_t stream);
+
+    const base::samples::Sonar& next_sample(size_t stream) const {
+        return channels_[stream]->slots[channels_[stream]->tail];
+    }
+
+    void close_channels();
+
+    void run_worker(size_t stream);
+
+    void merge_detections();
+
+    std::string filename_;
+    std::vector<std::string> stream_names_;
+    ProcessingOptions options_;
+
+    std::auto_ptr<rock_util::LogReader> reader_;
+    std::vector<rock_util::LogStream> streams_;
+    std::vector<size_t> ends_;
+
+    std::vector<boost::shared_ptr<LogProcessor> > processors_;
+    std::vector<boost::shared_ptr<Channel> > channels_;
+    boost::thread_group workers_;
+
+    std::vector<detection::TimedTarget> detections_;
+    Throughput throughput_;
+    base::Time decode_time_;
+    base::Time reader_wait_;
+};
+
+} /* namespace sonarlog_obstacle_detection */
+
+#endif /* MultiStreamProcessor_hpp */
@@ -0,0 +1,284 @@
+#include <cmath>
+#include <cstdlib>
+#include <sstream>
+#include <stdexcept>
+#include <boost/bind.hpp>
+#include "sonarlog_obstacle_detection/ParameterSweep.hpp"
+
+namespace sonarlog_obstacle_detection {
+
+namespace {
+
+double parse_number(const std::string& text, const std::string& name) {
+    char *end;
+    double value = strtod(text.c_str(), &end);
+    if (text.empty() || *end) throw std::invalid_argument("invalid value " + text + " of " + name);
+    return value;
+}
+
+/* "v1,v2,..." or "first:last:step" */
+std::vector<double> parse_values(const std::string& text, const std::string& name) {
+    std::vector<double> values;
+
+    size_t colon = text.find(':');
+    if (colon != std::string::npos) {
+        size_t colon2 = text.find(':', colon + 1);
+        if (colon2 == std::string::npos) throw std::invalid_argument("range of " + name + " is not first:last:step");
+
+        double first = parse_number(text.substr(0, colon), name);
+        double last = parse_number(text.substr(colon + 1, colon2 - colon - 1), name);
+        double step = parse_number(text.substr(colon2 + 1), name);
+        if (step <= 0 || last < first) throw std::invalid_argument("empty range of " + name);
+
+        // the last value is included despite rounding of the step
+        size_t count = (size_t)floor((last - first) / step + 1e-6) + 1;
+        for (size_t i = 0; i < count; i++) values.push_back(first + i * step);
+        return values;
+    }
+
+    std::istringstream in(text);
+    std::string value;
+    while (std::getline(in, value, ',')) values.push_back(parse_number(value, name));
+    if (values.empty()) throw std::invalid_argument("no values of " + name);
+    return values;
+}
+
+/* the grid parameters, in the order of the summary columns */
+enum Parameter {
+    MIN_RANGE,
+    MAX_RANGE,
+    THRESHOLD,
+    MORPH_SIZE,
+    MORPH_ITERATIONS,
+    MIN_CONTOUR,
+    TRACK_BLOBS,
+    PARAMETER_COUNT
+};
+
+const char* const PARAMETER_NAMES[PARAMETER_COUNT] = {
+    "min_range",
+    "max_range",
+    "threshold",
+    "morph_size",
+    "morph_iterations",
+    "min_contour",
+    "track_blobs"
+};
+
+Parameter find_parameter(const std::string& name) {
+    for (int i = 0; i < PARAMETER_COUNT; i++) {
+        if (name == PARAMETER_NAMES[i]) return (Parameter)i;
+    }
+    throw std::invalid_argument("unknown sweep parameter " + name);
+}
+
+void set_parameter(SsivParameters& parameters, Parameter parameter, double value) {
+    switch (parameter) {
+        case MIN_RANGE: parameters.min_range = value; break;
+        case MAX_RANGE: parameters.max_range = value; break;
+        case THRESHOLD: parameters.threshold = value; break;
+        case MORPH_SIZE: parameters.morph_size = (int)value; break;
+        case MORPH_ITERATIONS: parameters.morph_iterations = (int)value; break;
+        case MIN_CONTOUR: parameters.min_contour_pixels = parameters.tracker.min_area = (int)value; break;
+        case TRACK_BLOBS: parameters.track_blobs = (value != 0); break;
+        case PARAMETER_COUNT: break;
+    }
+}
+
+double get_parameter(const SsivParameters& parameters, Parameter parameter) {
+    switch (parameter) {
+        case MIN_RANGE: return parameters.min_range;
+        case MAX_RANGE: return parameters.max_range;
+        case THRESHOLD: return parameters.threshold;
+        case MORPH_SIZE: return parameters.morph_size;
+        case MORPH_ITERATIONS: return parameters.morph_iterations;
+        case MIN_CONTOUR: return parameters.min_contour_pixels;
+        case TRACK_BLOBS: return parameters.track_blobs;
+        case PARAMETER_COUNT: break;
+    }
+    return 0;
+}
+
+}
+
+std::vector<SsivParameters> ParameterSweep::parse(const std::string& spec, const SsivParameters& base) {
+    std::vector<SsivParameters> configs(1, base);
+
+    std::istringstream in(spec);
+    std::string entry;
+    while (std::getline(in, entry, ';')) {
+        if (entry.empty()) continue;
+
+        size_t equal = entry.find('=');
+        if (equal == std::string::npos) throw std::invalid_argument("sweep entry " + entry + " is not name=values");
+
+        std::string name = entry.substr(0, equal);
+        Parameter parameter = find_parameter(name);
+        std::vector<double> values = parse_values(entry.substr(equal + 1), name);
+
+        std::vector<SsivParameters> product;
+        product.reserve(configs.size() * values.size());
+        for (size_t i = 0; i < configs.size(); i++) {
+            for (size_t j = 0; j < values.size(); j++) {
+                product.push_back(configs[i]);
+                set_parameter(product.back(), parameter, values[j]);
+            }
+        }
+        configs.swap(product);
+    }
+
+    for (size_t i = 0; i < configs.size(); i++) {
+        if (configs[i].min_range >= configs[i].max_range) throw std::invalid_argument("sweep with min_range >= max_range");
+        if (configs[i].morph_size < 1 || configs[i].morph_iterations < 0) throw std::invalid_argument("sweep with an invalid morphology");
+    }
+
+    return configs;
+}
+
+ParameterSweep::ParameterSweep(const std::vector<SsivParameters>& configs, size_t jobs)
+    : tracks_(configs.size())
+    , latency_(configs.size())
+    , pings_(0)
+    , cart_(NULL)
+    , sample_(NULL)
+    , generation_(0)
+    , pending_(0)
+    , stopping_(false) {
+    for (size_t i = 0; i < configs.size(); i++) {
+        detectors_.push_back(boost::shared_ptr<SsivDetector>(new SsivDetector(configs[i])));
+    }
+
+    if (!jobs) jobs = boost::thread::hardware_concurrency();
+    jobs = std::max<size_t>(1, std::min(jobs, configs.size()));
+
+    // the calling thread is worker 0
+    for (size_t i = 1; i < jobs; i++) {
+        threads_.create_thread(boost::bind(&ParameterSweep::run_worker, this, i));
+    }
+}
+
+ParameterSweep::~ParameterSweep() {
+    {
+        boost::mutex::scoped_lock lock(mutex_);
+        stopping_ = true;
+    }
+    start_.notify_all();
+    threads_.join_all();
+}
+
+void ParameterSweep::reset() {
+    for (size_t i = 0; i < detectors_.size(); i++) {
+        tracks_[i].clear();
+        latency_[i].reset();
+    }
+    pings_ = 0;
+}
+
+void ParameterSweep::process(const cv::Mat& cart, const base::samples::Sonar& sample, const cv::Rect& dirty) {
+    cart_ = &cart;
+    sample_ = &sample;
+    dirty_ = dirty;
+
+    {
+        boost::mutex::scoped_lock lock(mutex_);
+        generation_++;
+        pending_ = threads_.size();
+    }
+    start_.notify_all();
+
+    std::string error;
+    try {
+        run_share(0);
+    } catch (std::exception& e) {
+        error = e.what();
+    }
+
+    {
+        boost::mutex::scoped_lock lock(mutex_);
+        while (pending_) done_.wait(lock);
+        if (error.empty()) error.swap(error_);
+        error_.clear();
+    }
+
+    pings_++;
+    if (!error.empty()) throw std::runtime_error(error);
+}
+
+void ParameterSweep::run_worker(size_t worker) {
+    uint64_t generation = 0;
+
+    for (;;) {
+        {
+            boost::mutex::scoped_lock lock(mutex_);
+            while (generation_ == generation && !stopping_) start_.wait(lock);
+            if (stopping_) return;
+            generation = generation_;
+        }
+
+        std::string error;
+        try {
+            run_share(worker);
+        } catch (std::exception& e) {
+            error = e.what();
+        }
+
+        {
+            boost::mutex::scoped_lock lock(mutex_);
+            if (!error.empty()) error_ = error;
+            if (--pending_ == 0) done_.notify_one();
+        }
+    }
+}
+
+void ParameterSweep::run_share(size_t worker) {
+    // every worker owns a fixed stride of configurations, so no config is shared
+    for (size_t i = worker; i < detectors_.size(); i += jobs()) {
+        uint64_t start = Metrics::now();
+        detectors_[i]->process(*cart_, *sample_, dirty_);
+        latency_[i].record(Metrics::now() - start);
+
+        const detection::Target& target = detectors_[i]->target();
+        if (target.valid) {
+            Detection detection;
+            detection.ping = pings_;
+            detection.time = sample_->time;
+            detection.target = target;
+            tracks_[i].push_back(detection);
+        }
+    }
+}
+
+void ParameterSweep::write_tracks(std::ostream& out) const {
+    out << "config,ping,time,x,y,width,height,closest_x,closest_y,position_x,position_y" << std::endl;
+    for (size_t i = 0; i < tracks_.size(); i++) {
+        for (size_t j = 0; j < tracks_[i].size(); j++) {
+            const Detection& d = tracks_[i][j];
+            out << i << "," << d.ping << "," << d.time.toMicroseconds() << ","
+                << d.target.bbox.x << "," << d.target.bbox.y << ","
+                << d.target.bbox.width << "," << d.target.bbox.height << ","
+                << d.target.closest.x << "," << d.target.closest.y << ","
+                << d.target.position.x() << "," << d.target.position.y() << "\n";
+        }
+    }
+    out << std::flush;
+}
+
+void ParameterSweep::write_summary(std::ostream& out) const {
+    // the parameter columns are the names parse() takes
+    out << "config";
+    for (int j = 0; j < PARAMETER_COUNT; j++) out << "," << PARAMETER_NAMES[j];
+    out << ",pings,detections,mean_us,p50_us,p99_us,max_us,total_s" << std::endl;
+
+    for (size_t i = 0; i < detectors_.size(); i++) {
+        const SsivParameters& p = detectors_[i]->parameters();
+        const LatencyHistogram& latency = latency_[i];
+        out << i;
+        for (int j = 0; j < PARAMETER_COUNT; j++) out << "," << get_parameter(p, (Parameter)j);
+        out << "," << latency.count() << "," << tracks_[i].size() << ","
+            << latency.mean() * 1e-3 << "," << latency.percentile(0.5) * 1e-3 << ","
+            << latency.percentile(0.99) * 1e-3 << "," << latency.max() * 1e-3 << ","
+            << latency.total() * 1e-9 << std::endl;
+    }
+}
+
+} /* namespace sonarlog_obstacle_detection */
@@ -0,0 +1,118 @@
+#ifndef ParameterSweep_hpp
+#define ParameterSweep_hpp
+
+#include <iostream>
+#include <string>
+#include <vector>
+#include <boost/shared_ptr.hpp>
+#include <boost/thread/thread.hpp>
+#include <boost/thread/mutex.hpp>
+#include <boost/thread/condition_variable.hpp>
+#include <opencv2/opencv.hpp>
+#include <base/Time.hpp>
+#include <base/samples/Sonar.hpp>
+#include "sonarlog_obstacle_detection/Metrics.hpp"
+#include "sonarlog_obstacle_detection/SsivDetector.hpp"
+
+namespace sonarlog_obstacle_detection {
+
+/*
+ * Runs many SsivDetector configurations on the same canvas.
+ *
+ * The caller decodes and projects every ping once; process() hands the
+ * canvas to one detector per configuration, spread over a pool of worker
+ * threads (the calling thread takes the first share), and returns when all
+ * of them are done. Every configuration keeps its own track of detections
+ * and a latency histogram of its detector.
+ */
+class ParameterSweep {
+public:
+
+    struct Detection {
+        size_t ping;
+        base::Time time;
+        detection::Target target;
+    };
+
+    /*
+     * The product of a grid of parameters, e.g.
+     * "threshold=0.05:0.2:0.05;morph_size=3,5,7". Every entry is a name and
+     * a list of values or an inclusive first:last:step range. The names
+     * are min_range, max_range, threshold, morph_size, morph_iterations,
+     * min_contour (both the contour and tracker minimum) and track_blobs
+     * (0 or 1). Parameters out of the grid keep the values of base. Throws
+     * std::invalid_argument.
+     */
+    static std::vector<SsivParameters> parse(const std::string& spec,
+                                             const SsivParameters& base = SsivParameters());
+
+    /* jobs is the number of threads (0 uses every core) */
+    ParameterSweep(const std::vector<SsivParameters>& configs, size_t jobs = 0);
+
+    ~ParameterSweep();
+
+    /* runs every configuration on the canvas of sample; dirty as in SsivDetector::process */
+    void process(const cv::Mat& cart, const base::samples::Sonar& sample, const cv::Rect& dirty);
+
+    /* forgets the tracks and timings */
+    void reset();
+
+    size_t size() const {
+        return detectors_.size();
+    }
+
+    size_t jobs() const {
+        return threads_.size() + 1;
+    }
+
+    size_t pings() const {
+        return pings_;
+    }
+
+    const SsivDetector& detector(size_t config) const {
+        return *detectors_[config];
+    }
+
+    const std::vector<Detection>& track(size_t config) const {
+        return tracks_[config];
+    }
+
+    const LatencyHistogram& latency(size_t config) const {
+        return latency_[config];
+    }
+
+    /* one line per detection: config, ping, time and target */
+    void write_tracks(std::ostream& out) const;
+
+    /* one line per configuration: a column per grid parameter of parse(), detections and latency */
+    void write_summary(std::ostream& out) const;
+
+private:
+
+    void run_worker(size_t worker);
+
+    void run_share(size_t worker);
+
+    std::vector<boost::shared_ptr<SsivDetector> > detectors_;
+    std::vector<std::vector<Detection> > tracks_;
+    std::vector<LatencyHistogram> latency_;
+    size_t pings_;
+
+    // the ping being processed, shared by the workers
+    const cv::Mat *cart_;
+    const base::samples::Sonar *sample_;
+    cv::Rect dirty_;
+
+    boost::thread_group threads_;
+    boost::mutex mutex_;
+    boost::condition_variable start_;
+    boost::condition_variable done_;
+    uint64_t generation_;
+    size_t pending_;
+    bool stopping_;
+    std::string error_;
+};
+
+} /* namespace sonarlog_obstacle_detection */
+
+#endif /* ParameterSweep_hpp */
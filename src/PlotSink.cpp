@@ -0,0 +1,105 @@
+#include <algorithm>
+#include <iostream>
+#include <boost/bind.hpp>
+#include "sonarlog_obstacle_detection/PlotSink.hpp"
+
+namespace sonarlog_obstacle_detection {
+
+PlotSink::PlotSink(const Output& output, size_t every, double max_rate)
+    : output_(output)
+    , every_(std::max<size_t>(every, 1))
+    , min_period_((max_rate > 0) ? base::Time::fromSeconds(1 / max_rate) : base::Time())
+    , has_last_(false)
+    , full_(false)
+    , busy_(false)
+    , stopped_(false) {
+    thread_ = boost::thread(boost::bind(&PlotSink::draw_frames, this));
+}
+
+PlotSink::~PlotSink() {
+    stop();
+}
+
+bool PlotSink::push(const cv::Mat& mat) {
+    return push(mat, base::Time::now());
+}
+
+bool PlotSink::push(const cv::Mat& mat, const base::Time& time) {
+    {
+        boost::mutex::scoped_lock lock(mutex_);
+        if (stopped_) return false;
+
+        stats_.pushed++;
+        if (decimate(time)) {
+            stats_.decimated++;
+            return false;
+        }
+
+        // latest wins, the copy reuses the buffer of the mailbox
+        if (full_) stats_.replaced++;
+        mat.copyTo(mailbox_);
+        full_ = true;
+    }
+    not_empty_.notify_one();
+    return true;
+}
+
+bool PlotSink::decimate(const base::Time& time) {
+    if ((stats_.pushed - 1) % every_) return true;
+    if (has_last_ && !min_period_.isNull() && time - last_time_ < min_period_) return true;
+
+    has_last_ = true;
+    last_time_ = time;
+    return false;
+}
+
+void PlotSink::flush() {
+    boost::mutex::scoped_lock lock(mutex_);
+    while (full_ || busy_) idle_.wait(lock);
+}
+
+void PlotSink::stop() {
+    {
+        boost::mutex::scoped_lock lock(mutex_);
+        stopped_ = true;
+    }
+    not_empty_.notify_all();
+    if (thread_.joinable()) thread_.join();
+}
+
+PlotSink::Stats PlotSink::stats() const {
+    boost::mutex::scoped_lock lock(mutex_);
+    return stats_;
+}
+
+void PlotSink::draw_frames() {
+    for (;;) {
+        {
+            boost::mutex::scoped_lock lock(mutex_);
+            busy_ = false;
+            idle_.notify_all();
+
+            while (!full_ && !stopped_) not_empty_.wait(lock);
+            if (!full_) break;
+
+            // the frame pushed meanwhile goes into the buffer just drawn
+            std::swap(mailbox_, drawing_);
+            full_ = false;
+            busy_ = true;
+            stats_.drawn++;
+        }
+
+        try {
+            output_(drawing_);
+        } catch (std::exception& e) {
+            // a broken output (e.g. gnuplot exited) must not stop the processing
+            std::cerr << "plotting disabled: " << e.what() << std::endl;
+
+            boost::mutex::scoped_lock lock(mutex_);
+            stopped_ = true;
+            full_ = false;
+        }
+    }
+}
+
+} /* namespace sonarlog_obstacle_detection */
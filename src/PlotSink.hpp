@@ -0,0 +1,96 @@
+#ifndef PlotSink_hpp
+#define PlotSink_hpp
+
+#include <boost/function.hpp>
+#include <boost/thread/thread.hpp>
+#include <boost/thread/mutex.hpp>
+#include <boost/thread/condition_variable.hpp>
+#include <opencv2/opencv.hpp>
+#include <base/Time.hpp>
+
+namespace sonarlog_obstacle_detection {
+
+/*
+ * Hands frames to a slow output (e.g. gnuplot through base::Plot) on a
+ * background thread.
+ *
+ * push() keeps every Nth frame and at most max_rate frames per second,
+ * copies it into a single-slot mailbox and returns. A frame still in the
+ * mailbox when the next one arrives is replaced, so the output always
+ * draws the latest frame and the processing thread never waits on it.
+ */
+class PlotSink {
+public:
+
+    typedef boost::function<void (const cv::Mat&)> Output;
+
+    struct Stats {
+        Stats()
+            : pushed(0)
+            , decimated(0)
+            , replaced(0)
+            , drawn(0) {
+        }
+
+        // frames given to push()
+        size_t pushed;
+
+        // frames skipped by the every Nth / max rate decimation
+        size_t decimated;
+
+        // frames overwritten in the mailbox before the output took them
+        size_t replaced;
+
+        // frames passed to the output
+        size_t drawn;
+    };
+
+    /* every: keep one frame out of every (0 or 1 keeps all); max_rate: Hz, 0 for no limit */
+    PlotSink(const Output& output, size_t every = 1, double max_rate = 0);
+
+    ~PlotSink();
+
+    /* returns true if the frame was queued for the output */
+    bool push(const cv::Mat& mat);
+
+    /* the same with the time of the frame for the max rate (e.g. a recorded time) */
+    bool push(const cv::Mat& mat, const base::Time& time);
+
+    /* waits until the output took the frame in the mailbox and returned */
+    void flush();
+
+    /* draws what is left in the mailbox and joins the thread */
+    void stop();
+
+    Stats stats() const;
+
+private:
+
+    bool decimate(const base::Time& time);
+
+    void draw_frames();
+
+    Output output_;
+    size_t every_;
+    base::Time min_period_;
+    bool has_last_;
+    base::Time last_time_;
+
+    // the mailbox, and the frame being drawn (swapped, so buffers are reused)
+    cv::Mat mailbox_;
+    cv::Mat drawing_;
+    bool full_;
+    bool busy_;
+    bool stopped_;
+
+    Stats stats_;
+
+    mutable boost::mutex mutex_;
+    boost::condition_variable not_empty_;
+    boost::condition_variable idle_;
+    boost::thread thread_;
+};
+
+} /* namespace sonarlog_obstacle_detection */
+
+#endif /* PlotSink_hpp */
@@ -0,0 +1,87 @@
+#include <cmath>
+#include <algorithm>
+#include "sonarlog_obstacle_detection/PolarDetector.hpp"
+
+namespace sonarlog_obstacle_detection {
+
+PolarDetector::PolarDetector(const PolarParameters& parameters)
+    : parameters_(parameters) {
+}
+
+const detection::Target& PolarDetector::process(const PolarSweep& sweep) {
+    const cv::Mat& grid = sweep.grid();
+    target_ = detection::Target();
+    if (grid.empty() || sweep.bin_size() <= 0) return target_;
+
+    cv::blur(grid, blurred_, cv::Size(3, 3));
+
+    // the mirror of a column is only another column when their count is even
+    if (parameters_.remove_symmetric && grid.cols % 2 == 0) symmetric_.apply(blurred_, filtered_);
+    else blurred_.copyTo(filtered_);
+
+    int row0 = std::min<int>(grid.rows, ceil(parameters_.min_range / sweep.bin_size()));
+    int row1 = std::min<int>(grid.rows, floor(parameters_.max_range / sweep.bin_size()) + 1);
+    cv::Rect roi(0, row0, grid.cols, std::max(row1 - row0, 0));
+
+    mask_.create(grid.size(), CV_8UC1);
+    mask_.setTo(0);
+    for (int y = roi.y; y < roi.y + roi.height; y++) {
+        const float *f = filtered_.ptr<float>(y);
+        uchar *m = mask_.ptr<uchar>(y);
+        for (int x = 0; x < grid.cols; x++) m[x] = (f[x] > parameters_.threshold) ? 1 : 0;
+    }
+
+    suppress_isolated(roi);
+
+    labeler_.label(clean_, roi);
+    int index = labeler_.largest(parameters_.min_bins);
+    if (index < 0) return target_;
+
+    const labeling::Component& component = labeler_.components()[index];
+
+    // the closest run of the component starts at its first bin
+    const int *labels = labeler_.labels().ptr<int>(component.first.y);
+    int last = component.first.x;
+    while (last + 1 < grid.cols && labels[last + 1] == component.label) last++;
+
+    int column = (component.first.x + last) / 2;
+    double range = component.first.y * sweep.bin_size();
+    double bearing = sweep.bearings()[column];
+
+    target_.valid = true;
+    target_.bbox = component.bbox;
+    target_.closest = cv::Point(column, component.first.y);
+    target_.position = base::Vector2d(range * cos(bearing), range * sin(bearing));
+    target_.area = component.area;
+    target_.confidence = (float)component.area / component.bbox.area();
+    return target_;
+}
+
+void PolarDetector::suppress_isolated(const cv::Rect& roi) {
+    clean_.create(mask_.size(), CV_8UC1);
+    clean_.setTo(0);
+
+    const int rows = mask_.rows, cols = mask_.cols;
+    for (int y = roi.y; y < roi.y + roi.height; y++) {
+        const uchar *m = mask_.ptr<uchar>(y);
+        const uchar *up = (y > 0) ? mask_.ptr<uchar>(y - 1) : NULL;
+        const uchar *down = (y + 1 < rows) ? mask_.ptr<uchar>(y + 1) : NULL;
+        uchar *c = clean_.ptr<uchar>(y);
+
+        for (int x = 0; x < cols; x++) {
+            if (!m[x]) continue;
+
+            int x0 = std::max(x - 1, 0), x1 = std::min(x + 1, cols - 1);
+            int neighbours = -1;
+            for (int i = x0; i <= x1; i++) {
+                neighbours += m[i];
+                if (up) neighbours += up[i];
+                if (down) neighbours += down[i];
+            }
+
+            c[x] = (neighbours >= parameters_.min_neighbours) ? 255 : 0;
+        }
+    }
+}
+
+} /* namespace sonarlog_obstacle_detection */
@@ -0,0 +1,98 @@
+#ifndef PolarDetector_hpp
+#define PolarDetector_hpp
+
+#include <opencv2/opencv.hpp>
+#include "sonarlog_obstacle_detection/Detection.hpp"
+#include "sonarlog_obstacle_detection/Labeling.hpp"
+#include "sonarlog_obstacle_detection/PolarSweep.hpp"
+#include "sonarlog_obstacle_detection/SymmetricRemoval.hpp"
+
+namespace sonarlog_obstacle_detection {
+
+struct PolarParameters {
+    PolarParameters()
+        : min_range(1)
+        , max_range(7)
+        , threshold(0.1)
+        , min_neighbours(2)
+        , min_bins(10)
+        , remove_symmetric(true) {
+    }
+
+    // range limits (meters) of the region of interest
+    float min_range;
+    float max_range;
+
+    // binarization threshold of the filtered grid
+    float threshold;
+
+    // bins with fewer 8-connected neighbours above the threshold are dropped
+    int min_neighbours;
+
+    // components with fewer bins are ignored
+    int min_bins;
+
+    // symmetric reflection removal (needs a grid symmetric around bearing zero)
+    bool remove_symmetric;
+};
+
+/*
+ * Obstacle detection on the bin x bearing grid of a PolarSweep, without
+ * rendering a Cartesian image: blur, symmetric reflection removal, range
+ * ROI, threshold, isolated-bin suppression (in place of the opening) and
+ * the largest 8-connected component. Only the closest bin of that
+ * component is converted to world coordinates.
+ *
+ * Target::bbox and Target::closest are in grid coordinates (x = column,
+ * y = bin). The position is the start of the closest bin of the component
+ * at the bearing of the middle of its closest run of columns. It matches
+ * the SsivDetector position within one bin plus the arc of one column at
+ * that range, plus the pixel size of the Cartesian canvas.
+ */
+class PolarDetector {
+public:
+
+    PolarDetector(const PolarParameters& parameters = PolarParameters());
+
+    const detection::Target& process(const PolarSweep& sweep);
+
+    const cv::Mat& filtered() const {
+        return filtered_;
+    }
+
+    /* the bins left after the isolated-bin suppression */
+    const cv::Mat& mask() const {
+        return clean_;
+    }
+
+    const labeling::Labeler& labeler() const {
+        return labeler_;
+    }
+
+    const detection::Target& target() const {
+        return target_;
+    }
+
+    const PolarParameters& parameters() const {
+        return parameters_;
+    }
+
+private:
+
+    void suppress_isolated(const cv::Rect& roi);
+
+    PolarParameters parameters_;
+    SymmetricRemoval symmetric_;
+    labeling::Labeler labeler_;
+
+    cv::Mat blurred_;
+    cv::Mat filtered_;
+    cv::Mat mask_;
+    cv::Mat clean_;
+
+    detection::Target target_;
+};
+
+} /* namespace sonarlog_obstacle_detection */
+
+#endif /* PolarDetector_hpp */
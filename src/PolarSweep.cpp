@@ -0,0 +1,87 @@
+#include <cmath>
+#include <algorithm>
+#include "sonarlog_obstacle_detection/PolarSweep.hpp"
+
+namespace sonarlog_obstacle_detection {
+
+PolarSweep::PolarSweep(base::Angle left_limit, base::Angle right_limit, base::Angle resolution)
+    : left_limit_(left_limit.getRad())
+    , right_limit_(right_limit.getRad())
+    , resolution_(resolution.getRad())
+    , multibeam_(false)
+    , bin_size_(0) {
+}
+
+void PolarSweep::reset() {
+    grid_.release();
+    bearings_.clear();
+    bin_size_ = 0;
+}
+
+int PolarSweep::column(double bearing) const {
+    int columns = bearings_.size();
+    int column = floor((left_limit_ - bearing) / resolution_ + 1e-6);
+    return std::min(std::max(column, 0), columns - 1);
+}
+
+void PolarSweep::resample(int bin_count, double bin_size) {
+    cv::Mat grid(bin_count, grid_.cols, CV_32FC1, cv::Scalar(0));
+    if (bin_size_ <= 0) {
+        grid_ = grid;
+        return;
+    }
+
+    // each new row takes the old row at the same distance, rows past the old range stay empty
+    for (int bin = 0; bin < bin_count; bin++) {
+        int row = floor(bin * bin_size / bin_size_ + 0.5);
+        if (row >= grid_.rows) break;
+        grid_.row(row).copyTo(grid.row(bin));
+    }
+    grid_ = grid;
+}
+
+cv::Range PolarSweep::update(const base::samples::Sonar& sample) {
+    const int bin_count = sample.bin_count;
+    const int beam_count = sample.beam_count;
+    if (!bin_count || !beam_count || sample.bins.size() < (size_t)bin_count * beam_count) return cv::Range(0, -1);
+
+    bool multibeam = beam_count > 1;
+    double bin_size = sample.getBinStartDistance(1);
+    if (multibeam != multibeam_ || grid_.empty() || (multibeam && (grid_.rows != bin_count || grid_.cols != beam_count))) {
+        multibeam_ = multibeam;
+
+        if (multibeam) {
+            bearings_.resize(beam_count);
+        }
+        else {
+            // an even number of columns, centered around bearing zero when the limits are symmetric
+            int columns = std::max<int>(1, floor((left_limit_ - right_limit_) / resolution_ + 0.5));
+            bearings_.resize(columns);
+            for (int i = 0; i < columns; i++) bearings_[i] = left_limit_ - (i + 0.5) * resolution_;
+        }
+
+        grid_.create(bin_count, bearings_.size(), CV_32FC1);
+        grid_.setTo(0);
+    }
+    else if (!multibeam && (grid_.rows != bin_count || bin_size != bin_size_)) {
+        resample(bin_count, bin_size);
+    }
+
+    bin_size_ = bin_size;
+
+    if (multibeam) {
+        // beam-major bins to one column per beam
+        for (int beam = 0; beam < beam_count; beam++) {
+            bearings_[beam] = sample.bearings[beam].getRad();
+            const float *bins = &sample.bins[beam * bin_count];
+            for (int bin = 0; bin < bin_count; bin++) grid_.at<float>(bin, beam) = bins[bin];
+        }
+        return cv::Range(0, beam_count - 1);
+    }
+
+    int col = column(sample.bearings[0].getRad());
+    for (int bin = 0; bin < bin_count; bin++) grid_.at<float>(bin, col) = sample.bins[bin];
+    return cv::Range(col, col);
+}
+
+} /* namespace sonarlog_obstacle_detection */
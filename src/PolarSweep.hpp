@@ -0,0 +1,68 @@
+#ifndef PolarSweep_hpp
+#define PolarSweep_hpp
+
+#include <vector>
+#include <opencv2/opencv.hpp>
+#include <base/Angle.hpp>
+#include <base/samples/Sonar.hpp>
+
+namespace sonarlog_obstacle_detection {
+
+/*
+ * The latest intensities of a sonar on a bin x bearing grid (CV_32FC1, one
+ * row per bin, row 0 at the sonar).
+ *
+ * A multibeam ping replaces the whole grid with one column per beam, in
+ * the order of the sample. A single beam sonar writes its ping into the
+ * column of its bearing; the columns cover [right_limit, left_limit] with
+ * the given resolution, positive bearings (left) first, and are symmetric
+ * around bearing zero. When the bin count or the range of a single beam
+ * sonar changes, the columns already swept are resampled to the new bins
+ * at the same distance. A change of the kind of sonar clears the grid.
+ */
+class PolarSweep {
+public:
+
+    PolarSweep(base::Angle left_limit = base::Angle::fromDeg(45),
+               base::Angle right_limit = base::Angle::fromDeg(-45),
+               base::Angle resolution = base::Angle::fromDeg(1.8));
+
+    /* returns the column range [first, last] written by sample */
+    cv::Range update(const base::samples::Sonar& sample);
+
+    void reset();
+
+    const cv::Mat& grid() const {
+        return grid_;
+    }
+
+    /* bearing (radians) of every column */
+    const std::vector<double>& bearings() const {
+        return bearings_;
+    }
+
+    /* meters covered by one row */
+    double bin_size() const {
+        return bin_size_;
+    }
+
+    /* column of a single beam bearing (radians) */
+    int column(double bearing) const;
+
+private:
+
+    void resample(int bin_count, double bin_size);
+
+    double left_limit_;
+    double right_limit_;
+    double resolution_;
+    bool multibeam_;
+    double bin_size_;
+
+    cv::Mat grid_;
+    std::vector<double> bearings_;
+};
+
+} /* namespace sonarlog_obstacle_detection */
+
+#endif /* PolarSweep_hpp */
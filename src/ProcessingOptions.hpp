@@ -0,0 +1,107 @@
+#ifndef ProcessingOptions_hpp
+#define ProcessingOptions_hpp
+
+#include <cstddef>
+#include <limits>
+#include <string>
+
+namespace sonarlog_obstacle_detection {
+
+struct ProcessingOptions {
+    ProcessingOptions()
+        : headless(false)
+        , queue_size(4)
+        , mmap(false)
+        , denoise(false)
+        , denoise_window(4)
+        , metrics_interval(0)
+        , first_index(0)
+        , last_index(std::numeric_limits<size_t>::max())
+        , from_time(0)
+        , to_time(std::numeric_limits<double>::infinity())
+        , sweep_jobs(0)
+        , sweep_output(".")
+        , latency_budget(0)
+        , realtime_policy("drop")
+        , pixel_cost(0)
+        , detections_format("csv")
+        , plot_every(1)
+        , plot_rate(0) {
+    }
+
+    // run without any visualization sink
+    bool headless;
+
+    // number of samples decoded ahead by the reader thread (0 decodes inline)
+    size_t queue_size;
+
+    // read uncompressed logs through a memory mapping instead of the decoder,
+    // when the declared type of the stream has the layout SonarView parses
+    bool mmap;
+
+    // RLS denoising of every beam over the earlier pings at its bearing (see
+    // BeamDenoiser), ahead of the detection stages, and its window size
+    bool denoise;
+    unsigned int denoise_window;
+
+    // format of the per-file metrics summary: "json", "csv" or empty for none
+    std::string metrics_format;
+
+    // seconds between metrics snapshots written to stderr (0 disables them)
+    double metrics_interval;
+
+    // samples [first_index, last_index] of the stream are processed
+    size_t first_index;
+    size_t last_index;
+
+    // seconds after the first sample of the stream; limiting them builds (or
+    // reuses) the sample index sidecar of the log
+    double from_time;
+    double to_time;
+
+    // grid of SSIV parameters (see ParameterSweep::parse) evaluated on the
+    // scanning sonar canvas of every ping; empty disables the sweep
+    std::string sweep;
+
+    // threads running the configurations of a sweep (0 uses every core)
+    size_t sweep_jobs;
+
+    // directory of the <log>.sweep.csv summary and <log>.tracks.csv detections
+    std::string sweep_output;
+
+    // seconds from the recorded time of a ping to the end of its SSIV
+    // detection; a positive budget runs the detection in real-time mode
+    double latency_budget;
+
+    // what a late ping gives up: "drop" (keep newest) or "degrade"
+    std::string realtime_policy;
+
+    // nanoseconds per pixel of SsivDetector::work() charged to a ping in
+    // real-time mode, for a deterministic replay (0 charges the measured time)
+    double pixel_cost;
+
+    // directory of the <log>.detections.<format> of the polar detector (and
+    // of the real-time SSIV detector); empty disables the detection
+    std::string detections_output;
+
+    // "csv", "jsonl" or "binary" (see DetectionEncoder); the file is written
+    // from a background thread while the log is processed
+    std::string detections_format;
+
+    // frames of the plot sink: one out of plot_every, at most plot_rate per
+    // second (0 for no limit); the plotting runs on its own thread
+    size_t plot_every;
+    double plot_rate;
+
+    bool detect() const {
+        return !detections_output.empty();
+    }
+
+    bool time_window() const {
+        return from_time > 0 || to_time != std::numeric_limits<double>::infinity();
+    }
+};
+
+} /* namespace sonarlog_obstacle_detection */
+
+#endif /* ProcessingOptions_hpp */
@@ -0,0 +1,45 @@
+#include <algorithm>
+#include "sonarlog_obstacle_detection/RangeRoi.hpp"
+#include "sonarlog_obstacle_detection/Detection.hpp"
+
+namespace sonarlog_obstacle_detection {
+
+RangeRoi::RangeRoi(float min_range, float max_range)
+    : min_range_(min_range)
+    , max_range_(max_range)
+    , bin_count_(0)
+    , bin_duration_(0)
+    , speed_of_sound_(0)
+    , row0_(0)
+    , row1_(0) {
+}
+
+bool RangeRoi::update(const base::samples::Sonar& sample, cv::Size size) {
+    if (size == size_ &&
+        sample.bin_count == bin_count_ &&
+        sample.bin_duration.toMicroseconds() == bin_duration_ &&
+        sample.speed_of_sound == speed_of_sound_) {
+        return false;
+    }
+
+    bool changed = (size != size_);
+    size_ = size;
+    bin_count_ = sample.bin_count;
+    bin_duration_ = sample.bin_duration.toMicroseconds();
+    speed_of_sound_ = sample.speed_of_sound;
+
+    int row0, row1;
+    detection::getRoiRows(size.height, min_range_, max_range_, sample, row0, row1);
+
+    changed = changed || row0 != row0_ || row1 != row1_;
+    row0_ = row0;
+    row1_ = row1;
+
+    int top = std::min(std::max(row1_, 0), size.height);
+    int bottom = std::min(std::max(row0_, top), size.height);
+    rect_ = cv::Rect(0, top, size.width, bottom - top);
+
+    return changed;
+}
+
+} /* namespace sonarlog_obstacle_detection */
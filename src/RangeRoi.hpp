@@ -0,0 +1,56 @@
+#ifndef RangeRoi_hpp
+#define RangeRoi_hpp
+
+#include <opencv2/opencv.hpp>
+#include <base/samples/Sonar.hpp>
+
+namespace sonarlog_obstacle_detection {
+
+/*
+ * Rows of a cartesian frame that lie inside [min_range, max_range].
+ *
+ * The rows only depend on the frame size and on the range of the sonar,
+ * so they are computed again only when one of them changes. Stages that
+ * work on rect() skip the rows extractRoi would have zeroed.
+ */
+class RangeRoi {
+public:
+
+    RangeRoi(float min_range = 1, float max_range = 7);
+
+    /* returns true if the rows or the frame size changed */
+    bool update(const base::samples::Sonar& sample, cv::Size size);
+
+    /* the rows inside the range, over the whole frame width */
+    const cv::Rect& rect() const {
+        return rect_;
+    }
+
+    /* first row below the range (as in extractRoi) */
+    int row0() const {
+        return row0_;
+    }
+
+    /* first row inside the range (as in extractRoi) */
+    int row1() const {
+        return row1_;
+    }
+
+private:
+
+    float min_range_;
+    float max_range_;
+
+    cv::Size size_;
+    uint32_t bin_count_;
+    int64_t bin_duration_;
+    float speed_of_sound_;
+
+    int row0_;
+    int row1_;
+    cv::Rect rect_;
+};
+
+} /* namespace sonarlog_obstacle_detection */
+
+#endif /* RangeRoi_hpp */
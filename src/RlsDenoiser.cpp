@@ -0,0 +1,123 @@
+#include <algorithm>
+#include "sonarlog_obstacle_detection/RlsDenoiser.hpp"
+
+#if defined(__GNUC__) && (defined(__x86_64__) || defined(__i386__))
+#define RLS_X86
+#include <immintrin.h>
+#endif
+
+namespace sonarlog_obstacle_detection {
+
+namespace {
+
+void update_scalar(float *w, float *p, const float *x, size_t begin, size_t size, float lambda, float inv_lambda) {
+    for (size_t i = begin; i < size; i++) {
+        float k = p[i] / (lambda + p[i]);
+        w[i] = w[i] + k * (x[i] - w[i]);
+        p[i] = (p[i] - k * p[i]) * inv_lambda;
+    }
+}
+
+#ifdef RLS_X86
+
+__attribute__((target("sse2")))
+void update_sse2(float *w, float *p, const float *x, size_t size, float lambda, float inv_lambda) {
+    const __m128 l = _mm_set1_ps(lambda);
+    const __m128 il = _mm_set1_ps(inv_lambda);
+
+    size_t i = 0;
+    for (; i + 4 <= size; i += 4) {
+        __m128 pv = _mm_loadu_ps(p + i);
+        __m128 wv = _mm_loadu_ps(w + i);
+        __m128 k = _mm_div_ps(pv, _mm_add_ps(l, pv));
+        _mm_storeu_ps(w + i, _mm_add_ps(wv, _mm_mul_ps(k, _mm_sub_ps(_mm_loadu_ps(x + i), wv))));
+        _mm_storeu_ps(p + i, _mm_mul_ps(_mm_sub_ps(pv, _mm_mul_ps(k, pv)), il));
+    }
+
+    update_scalar(w, p, x, i, size, lambda, inv_lambda);
+}
+
+__attribute__((target("avx2")))
+void update_avx2(float *w, float *p, const float *x, size_t size, float lambda, float inv_lambda) {
+    const __m256 l = _mm256_set1_ps(lambda);
+    const __m256 il = _mm256_set1_ps(inv_lambda);
+
+    size_t i = 0;
+    for (; i + 8 <= size; i += 8) {
+        __m256 pv = _mm256_loadu_ps(p + i);
+        __m256 wv = _mm256_loadu_ps(w + i);
+        __m256 k = _mm256_div_ps(pv, _mm256_add_ps(l, pv));
+        _mm256_storeu_ps(w + i, _mm256_add_ps(wv, _mm256_mul_ps(k, _mm256_sub_ps(_mm256_loadu_ps(x + i), wv))));
+        _mm256_storeu_ps(p + i, _mm256_mul_ps(_mm256_sub_ps(pv, _mm256_mul_ps(k, pv)), il));
+    }
+
+    update_scalar(w, p, x, i, size, lambda, inv_lambda);
+}
+
+#endif
+
+}
+
+RlsDenoiser::RlsDenoiser(unsigned int window_size)
+    : isa_(sparse_bins::best_isa())
+    , row_size_(0) {
+    set_window_size(window_size);
+}
+
+void RlsDenoiser::set_window_size(unsigned int window_size) {
+    window_size_ = std::max(window_size, 2u);
+    lambda_ = float(window_size_ - 1) / window_size_;
+    inv_lambda_ = 1.0f / lambda_;
+    reset();
+}
+
+void RlsDenoiser::reset() {
+    estimate_.clear();
+    covariance_.clear();
+    started_.clear();
+    row_size_ = 0;
+}
+
+const float* RlsDenoiser::apply(size_t slot, size_t slots, const float *src, size_t size) {
+    if (!size || slot >= slots) return NULL;
+
+    // a new geometry restarts every row
+    if (row_size_ != size || started_.size() != slots) {
+        estimate_.assign(slots * size, 0.0f);
+        covariance_.assign(slots * size, 1.0f);
+        started_.assign(slots, false);
+        row_size_ = size;
+    }
+
+    float *w = &estimate_[slot * size];
+    float *p = &covariance_[slot * size];
+
+    // the first frame of a row starts its estimate
+    if (!started_[slot]) {
+        std::copy(src, src + size, w);
+        started_[slot] = true;
+        return w;
+    }
+
+#ifdef RLS_X86
+    if (isa_ == sparse_bins::ISA_AVX2) {
+        update_avx2(w, p, src, size, lambda_, inv_lambda_);
+        return w;
+    }
+
+    if (isa_ == sparse_bins::ISA_SSE2) {
+        update_sse2(w, p, src, size, lambda_, inv_lambda_);
+        return w;
+    }
+#endif
+
+    update_scalar(w, p, src, 0, size, lambda_, inv_lambda_);
+    return w;
+}
+
+void RlsDenoiser::apply(const std::vector<float>& src, std::vector<float>& dst) {
+    const float *estimate = apply(src);
+    dst.assign(estimate, estimate + src.size());
+}
+
+} /* namespace sonarlog_obstacle_detection */
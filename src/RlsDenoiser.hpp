@@ -0,0 +1,86 @@
+#ifndef RlsDenoiser_hpp
+#define RlsDenoiser_hpp
+
+#include <cstddef>
+#include <vector>
+#include "sonarlog_obstacle_detection/SparseBinKernel.hpp"
+
+namespace sonarlog_obstacle_detection {
+
+/*
+ * Streaming recursive least squares denoiser of a frame sequence (the bins
+ * of a ping, or an image).
+ *
+ * Every element tracks its own estimate w and error covariance p with a
+ * forgetting factor of (window_size - 1) / window_size, which weights the
+ * last window_size frames like the sliding window of denoising::RLS:
+ *
+ *     k = p / (lambda + p)
+ *     w = w + k * (x - w)
+ *     p = (p - k * p) / lambda
+ *
+ * The state lives in contiguous buffers sized on the first frame and
+ * reset when the frame size changes, so steady-state filtering does not
+ * allocate. The vectorized updates give the same result as the scalar one.
+ */
+class RlsDenoiser {
+public:
+
+    RlsDenoiser(unsigned int window_size = 4);
+
+    void set_window_size(unsigned int window_size);
+
+    unsigned int window_size() const {
+        return window_size_;
+    }
+
+    /* filters a frame of size values and returns the estimate (size values) */
+    const float* apply(const float *src, size_t size) {
+        return apply(0, 1, src, size);
+    }
+
+    /*
+     * Filters src as row slot of a frame of slots rows of size values, and
+     * returns the estimate of that row. The other rows keep their state, so
+     * rows updated at different times (the bearings of a scanning sonar)
+     * are each filtered over their own history; the first update of a row
+     * starts its estimate.
+     */
+    const float* apply(size_t slot, size_t slots, const float *src, size_t size);
+
+    const float* apply(const std::vector<float>& src) {
+        return apply((src.empty()) ? NULL : &src[0], src.size());
+    }
+
+    void apply(const std::vector<float>& src, std::vector<float>& dst);
+
+    const std::vector<float>& estimate() const {
+        return estimate_;
+    }
+
+    void reset();
+
+    void set_isa(sparse_bins::Isa isa) {
+        isa_ = isa;
+    }
+
+    sparse_bins::Isa isa() const {
+        return isa_;
+    }
+
+private:
+
+    unsigned int window_size_;
+    float lambda_;
+    float inv_lambda_;
+    sparse_bins::Isa isa_;
+
+    std::vector<float> estimate_;
+    std::vector<float> covariance_;
+    std::vector<bool> started_;
+    size_t row_size_;
+};
+
+} /* namespace sonarlog_obstacle_detection */
+
+#endif /* RlsDenoiser_hpp */
@@ -0,0 +1,145 @@
+#include <algorithm>
+#include <cstring>
+#include <fstream>
+#include <iostream>
+#include <stdexcept>
+#include <boost/filesystem.hpp>
+#include "sonarlog_obstacle_detection/SampleIndex.hpp"
+
+namespace sonarlog_obstacle_detection {
+
+namespace {
+
+const char MAGIC[8] = { 'S', 'L', 'O', 'D', 'I', 'D', 'X', '1' };
+
+bool entry_before_time(const SampleIndex::Entry& entry, int64_t time) {
+    return entry.time < time;
+}
+
+bool time_before_entry(int64_t time, const SampleIndex::Entry& entry) {
+    return time < entry.time;
+}
+
+template <typename T>
+void write_value(std::ostream& out, const T& value) {
+    out.write(reinterpret_cast<const char*>(&value), sizeof(T));
+}
+
+template <typename T>
+bool read_value(std::istream& in, T& value) {
+    return in.read(reinterpret_cast<char*>(&value), sizeof(T)).good();
+}
+
+}
+
+std::string SampleIndex::sidecar_path(const std::string& logfile, const std::string& stream_name) {
+    std::string suffix = stream_name;
+    std::replace(suffix.begin(), suffix.end(), '/', '_');
+    return logfile + "." + suffix + ".sidx";
+}
+
+SampleIndex::Entry SampleIndex::entry(const base::samples::Sonar& sample) {
+    Entry entry;
+    entry.time = sample.time.toMicroseconds();
+    entry.bin_count = sample.bin_count;
+    entry.range = sample.bin_count * sample.bin_duration.toSeconds() * sample.speed_of_sound / 2;
+    return entry;
+}
+
+void SampleIndex::stat_log(const std::string& logfile) {
+    log_size_ = boost::filesystem::file_size(logfile);
+    log_mtime_ = boost::filesystem::last_write_time(logfile);
+}
+
+void SampleIndex::build(const std::string& logfile, const std::string& stream_name, rock_util::LogStream& stream) {
+    path_ = sidecar_path(logfile, stream_name);
+    stream_name_ = stream_name;
+    stat_log(logfile);
+
+    size_t position = stream.current_sample_index();
+    stream.reset();
+
+    entries_.clear();
+    entries_.reserve(stream.total_samples());
+
+    base::samples::Sonar sample;
+    while (stream.current_sample_index() < stream.total_samples()) {
+        stream.next<base::samples::Sonar>(sample);
+        entries_.push_back(entry(sample));
+    }
+
+    stream.set_current_sample_index(position);
+}
+
+bool SampleIndex::load(const std::string& logfile, const std::string& stream_name) {
+    path_ = sidecar_path(logfile, stream_name);
+    stream_name_ = stream_name;
+    stat_log(logfile);
+    entries_.clear();
+
+    std::ifstream in(path_.c_str(), std::ios::binary);
+    if (!in) return false;
+    const uint64_t file_size = boost::filesystem::file_size(path_);
+
+    char magic[sizeof(MAGIC)];
+    uint64_t log_size, count;
+    int64_t log_mtime;
+    uint32_t name_size;
+
+    if (!in.read(magic, sizeof(magic)) || memcmp(magic, MAGIC, sizeof(MAGIC))) return false;
+    if (!read_value(in, log_size) || !read_value(in, log_mtime) || !read_value(in, name_size)) return false;
+
+    // a rewritten log invalidates its sidecar
+    if (log_size != log_size_ || log_mtime != log_mtime_) return false;
+
+    // the sizes read from a damaged sidecar must fit in what is left of it before anything is allocated
+    if (name_size != stream_name_.size()) return false;
+    std::string name(name_size, '\0');
+    if (name_size && !in.read(&name[0], name_size)) return false;
+    if (name != stream_name_ || !read_value(in, count)) return false;
+    if (count > (file_size - (uint64_t)in.tellg()) / sizeof(Entry)) return false;
+
+    std::vector<Entry> entries(count);
+    if (count && !in.read(reinterpret_cast<char*>(&entries[0]), count * sizeof(Entry))) return false;
+
+    entries_.swap(entries);
+    return true;
+}
+
+void SampleIndex::save() const {
+    std::ofstream out(path_.c_str(), std::ios::binary | std::ios::trunc);
+    if (!out) throw std::runtime_error("cannot write sample index " + path_);
+
+    out.write(MAGIC, sizeof(MAGIC));
+    write_value(out, log_size_);
+    write_value(out, log_mtime_);
+    write_value(out, uint32_t(stream_name_.size()));
+    out.write(stream_name_.data(), stream_name_.size());
+    write_value(out, uint64_t(entries_.size()));
+    if (!entries_.empty()) out.write(reinterpret_cast<const char*>(&entries_[0]), entries_.size() * sizeof(Entry));
+
+    if (!out) throw std::runtime_error("cannot write sample index " + path_);
+}
+
+void SampleIndex::open(const std::string& logfile, const std::string& stream_name, rock_util::LogStream& stream) {
+    if (load(logfile, stream_name) && entries_.size() == stream.total_samples()) return;
+
+    build(logfile, stream_name, stream);
+
+    // a read-only log directory only costs the rebuild next time
+    try {
+        save();
+    } catch (std::exception& e) {
+        std::cerr << "WARNING: " << e.what() << std::endl;
+    }
+}
+
+size_t SampleIndex::lower_bound(base::Time time) const {
+    return std::lower_bound(entries_.begin(), entries_.end(), time.toMicroseconds(), entry_before_time) - entries_.begin();
+}
+
+size_t SampleIndex::upper_bound(base::Time time) const {
+    return std::upper_bound(entries_.begin(), entries_.end(), time.toMicroseconds(), time_before_entry) - entries_.begin();
+}
+
+} /* namespace sonarlog_obstacle_detection */
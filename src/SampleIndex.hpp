@@ -0,0 +1,90 @@
+#ifndef SampleIndex_hpp
+#define SampleIndex_hpp
+
+#include <string>
+#include <vector>
+#include <stdint.h>
+#include <base/Time.hpp>
+#include <base/samples/Sonar.hpp>
+#include "rock_util/LogReader.hpp"
+
+namespace sonarlog_obstacle_detection {
+
+/*
+ * Per-sample metadata of one log stream, kept in a sidecar file next to
+ * the log (see sidecar_path), so time windows and range changes are found
+ * without decoding the log again.
+ *
+ * Entries are stored in stream order: the entry position is the sample
+ * index passed to LogStream::set_current_sample_index, which pocolog
+ * resolves to the file offset through its own stream index.
+ */
+class SampleIndex {
+public:
+
+    struct Entry {
+        int64_t time;       // microseconds
+        uint32_t bin_count;
+        float range;        // meters
+    };
+
+    SampleIndex()
+        : log_size_(0)
+        , log_mtime_(0) {
+    }
+
+    /* decodes every sample of the stream once and restores its position */
+    void build(const std::string& logfile, const std::string& stream_name, rock_util::LogStream& stream);
+
+    /* loads the sidecar if it exists and matches the log, returns false otherwise */
+    bool load(const std::string& logfile, const std::string& stream_name);
+
+    void save() const;
+
+    /* loads the sidecar of the stream or builds and saves it */
+    void open(const std::string& logfile, const std::string& stream_name, rock_util::LogStream& stream);
+
+    /* first sample at or after time (size() if none) */
+    size_t lower_bound(base::Time time) const;
+
+    /* one past the last sample at or before time */
+    size_t upper_bound(base::Time time) const;
+
+    size_t size() const {
+        return entries_.size();
+    }
+
+    bool empty() const {
+        return entries_.empty();
+    }
+
+    const Entry& operator[](size_t index) const {
+        return entries_[index];
+    }
+
+    base::Time time(size_t index) const {
+        return base::Time::fromMicroseconds(entries_[index].time);
+    }
+
+    const std::string& path() const {
+        return path_;
+    }
+
+    static std::string sidecar_path(const std::string& logfile, const std::string& stream_name);
+
+    static Entry entry(const base::samples::Sonar& sample);
+
+private:
+
+    void stat_log(const std::string& logfile);
+
+    std::string path_;
+    std::string stream_name_;
+    uint64_t log_size_;
+    int64_t log_mtime_;
+    std::vector<Entry> entries_;
+};
+
+} /* namespace sonarlog_obstacle_detection */
+
+#endif /* SampleIndex_hpp */
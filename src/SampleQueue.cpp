@@ -0,0 +1,114 @@
+#include <algorithm>
+#include <stdexcept>
+#include <boost/bind.hpp>
+#include "sonarlog_obstacle_detection/SampleQueue.hpp"
+
+namespace sonarlog_obstacle_detection {
+
+SampleQueue::SampleQueue(rock_util::LogStream& stream, size_t capacity, size_t end)
+    : stream_(stream)
+    , slots_(std::max<size_t>(capacity, 1))
+    , end_(end)
+    , head_(0)
+    , tail_(0)
+    , count_(0)
+    , finished_(false)
+    , stopped_(false) {
+}
+
+SampleQueue::~SampleQueue() {
+    stop();
+}
+
+void SampleQueue::start() {
+    stop();
+
+    head_ = tail_ = count_ = 0;
+    finished_ = stopped_ = false;
+    error_.clear();
+    timing_ = Timing();
+
+    thread_ = boost::thread(boost::bind(&SampleQueue::read_samples, this));
+}
+
+void SampleQueue::stop() {
+    {
+        boost::mutex::scoped_lock lock(mutex_);
+        stopped_ = true;
+    }
+    not_full_.notify_all();
+    if (thread_.joinable()) thread_.join();
+}
+
+const base::samples::Sonar* SampleQueue::front() {
+    boost::mutex::scoped_lock lock(mutex_);
+
+    if (!count_ && !finished_) {
+        base::Time start = base::Time::now();
+        while (!count_ && !finished_) not_empty_.wait(lock);
+        timing_.consumer_wait = timing_.consumer_wait + (base::Time::now() - start);
+    }
+
+    if (count_) return &slots_[head_];
+    if (!error_.empty()) throw std::runtime_error(error_);
+    return NULL;
+}
+
+void SampleQueue::pop() {
+    {
+        boost::mutex::scoped_lock lock(mutex_);
+        if (!count_) return;
+        head_ = (head_ + 1) % slots_.size();
+        count_--;
+    }
+    not_full_.notify_one();
+}
+
+SampleQueue::Timing SampleQueue::timing() const {
+    boost::mutex::scoped_lock lock(mutex_);
+    return timing_;
+}
+
+void SampleQueue::read_samples() {
+    try {
+        size_t end = std::min(end_, stream_.total_samples());
+        while (stream_.current_sample_index() < end) {
+            size_t slot;
+            {
+                boost::mutex::scoped_lock lock(mutex_);
+                if (count_ == slots_.size() && !stopped_) {
+                    base::Time start = base::Time::now();
+                    while (count_ == slots_.size() && !stopped_) not_full_.wait(lock);
+                    timing_.reader_wait = timing_.reader_wait + (base::Time::now() - start);
+                }
+                if (stopped_) break;
+                slot = tail_;
+            }
+
+            // the slot is owned by this thread until count_ is incremented
+            base::Time start = base::Time::now();
+            stream_.next<base::samples::Sonar>(slots_[slot]);
+            base::Time elapsed = base::Time::now() - start;
+
+            {
+                boost::mutex::scoped_lock lock(mutex_);
+                timing_.decode = timing_.decode + elapsed;
+                timing_.samples++;
+                tail_ = (tail_ + 1) % slots_.size();
+                count_++;
+            }
+            not_empty_.notify_one();
+        }
+    } catch (std::exception& e) {
+        boost::mutex::scoped_lock lock(mutex_);
+        error_ = e.what();
+    }
+
+    {
+        boost::mutex::scoped_lock lock(mutex_);
+        finished_ = true;
+    }
+    not_empty_.notify_all();
+}
+
+} /* namespace sonarlog_obstacle_detection */
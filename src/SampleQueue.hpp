@@ -0,0 +1,96 @@
+#ifndef SampleQueue_hpp
+#define SampleQueue_hpp
+
+#include <limits>
+#include <string>
+#include <vector>
+#include <boost/thread/thread.hpp>
+#include <boost/thread/mutex.hpp>
+#include <boost/thread/condition_variable.hpp>
+#include <base/Time.hpp>
+#include <base/samples/Sonar.hpp>
+#include "rock_util/LogReader.hpp"
+
+namespace sonarlog_obstacle_detection {
+
+/*
+ * Decodes the samples of a log stream ahead of the processing thread.
+ *
+ * A reader thread deserializes the samples into a bounded ring of
+ * preallocated buffers. The processing thread takes them in stream order
+ * with front() and gives the buffer back with pop(). The reader blocks
+ * while the ring is full, so memory stays bounded.
+ */
+class SampleQueue {
+public:
+
+    struct Timing {
+        Timing()
+            : samples(0) {
+        }
+
+        // time spent deserializing samples in the reader thread
+        base::Time decode;
+
+        // time the reader thread waited for a free buffer (backpressure)
+        base::Time reader_wait;
+
+        // time the processing thread waited for a decoded sample
+        base::Time consumer_wait;
+
+        size_t samples;
+
+        // decode latency that overlapped with processing
+        base::Time hidden() const {
+            return (decode < consumer_wait) ? base::Time() : decode - consumer_wait;
+        }
+    };
+
+    /* decodes from the current sample of stream up to (excluding) end */
+    SampleQueue(rock_util::LogStream& stream, size_t capacity = 4,
+                size_t end = std::numeric_limits<size_t>::max());
+
+    ~SampleQueue();
+
+    void start();
+
+    void stop();
+
+    /* returns the oldest decoded sample or NULL at the end of the stream */
+    const base::samples::Sonar* front();
+
+    /* releases the buffer returned by front() */
+    void pop();
+
+    size_t capacity() const {
+        return slots_.size();
+    }
+
+    Timing timing() const;
+
+private:
+
+    void read_samples();
+
+    rock_util::LogStream& stream_;
+    std::vector<base::samples::Sonar> slots_;
+    size_t end_;
+
+    size_t head_;
+    size_t tail_;
+    size_t count_;
+    bool finished_;
+    bool stopped_;
+    std::string error_;
+
+    Timing timing_;
+
+    mutable boost::mutex mutex_;
+    boost::condition_variable not_empty_;
+    boost::condition_variable not_full_;
+    boost::thread thread_;
+};
+
+} /* namespace sonarlog_obstacle_detection */
+
+#endif /* SampleQueue_hpp */
@@ -0,0 +1,100 @@
+#include <algorithm>
+#include <cmath>
+#include "sonarlog_obstacle_detection/ScanningCanvas.hpp"
+
+namespace sonarlog_obstacle_detection {
+
+ScanningCanvas::ScanningCanvas(base::Angle left_limit, base::Angle right_limit, int max_size,
+                               double min_pixel_size, base::Angle resolution)
+    : max_size_(max_size)
+    , min_pixel_size_(min_pixel_size)
+    , sweep_(left_limit, right_limit, resolution)
+    , wedge_(0, 0)
+    , left_limit_(left_limit.getRad())
+    , resolution_(resolution.getRad())
+    , bin_count_(0)
+    , range_(0)
+    , retargets_(0) {
+}
+
+int ScanningCanvas::canvas_size(uint32_t bin_count, double range, int max_size, double min_pixel_size) {
+    double half = bin_count;
+    if (min_pixel_size > 0) half = std::min(half, ceil(range / min_pixel_size));
+    return 2 * std::max(std::min((int)half, max_size / 2), 1);
+}
+
+void ScanningCanvas::reset() {
+    sweep_.reset();
+    wedge_ = ScanningWedge(0, 0);
+    bin_count_ = 0;
+    range_ = 0;
+    indices_.clear();
+    image_.release();
+}
+
+cv::Rect ScanningCanvas::update(const base::samples::Sonar& sample) {
+    cv::Range columns = sweep_.update(sample);
+    if (columns.end < columns.start) return cv::Rect();
+
+    double range = sample.getBinStartDistance(sample.bin_count);
+    bool retargeted = indices_.empty() || sample.bin_count != bin_count_ || range != range_;
+    if (retargeted) retarget(sample.bin_count, range);
+
+    // a single beam only changes the wedge of its column
+    cv::Rect dirty(0, 0, image_.cols, image_.rows);
+    if (!retargeted && columns.start == columns.end) {
+        double bearing = sweep_.bearings()[columns.start];
+        dirty = wedge_.wedge(bearing - resolution_ / 2, bearing + resolution_ / 2);
+    }
+
+    render(dirty);
+    return dirty;
+}
+
+void ScanningCanvas::retarget(uint32_t bin_count, double range) {
+    bin_count_ = bin_count;
+    range_ = range;
+    retargets_++;
+
+    const int size = canvas_size(bin_count, range, max_size_, min_pixel_size_);
+    const int half = size / 2;
+    const int columns = sweep_.grid().cols;
+
+    image_ = cv::Mat::zeros(size, size, CV_32FC1);
+    wedge_ = ScanningWedge(size, size);
+    indices_.assign(size * size, -1);
+
+    double bins_per_pixel = bin_count / (double)half;
+    for (int y = 0; y < size; y++) {
+        int32_t *indices = &indices_[y * size];
+
+        for (int x = 0; x < size; x++) {
+            double dx = half - (x + 0.5);
+            double dy = half - (y + 0.5);
+
+            int bin = sqrt(dx * dx + dy * dy) * bins_per_pixel;
+            if (bin >= (int)bin_count) continue;
+
+            // positive bearings point to the left of the canvas
+            double column = floor((left_limit_ - atan2(dx, dy)) / resolution_);
+            if (column < 0 || column >= columns) continue;
+
+            indices[x] = bin * columns + (int)column;
+        }
+    }
+}
+
+void ScanningCanvas::render(const cv::Rect& rect) {
+    const float *grid = sweep_.grid().ptr<float>();
+    const int width = image_.cols;
+
+    for (int y = rect.y; y < rect.y + rect.height; y++) {
+        const int32_t *indices = &indices_[y * width];
+        float *out = image_.ptr<float>(y);
+        for (int x = rect.x; x < rect.x + rect.width; x++) {
+            out[x] = (indices[x] >= 0) ? grid[indices[x]] : 0.0f;
+        }
+    }
+}
+
+} /* namespace sonarlog_obstacle_detection */
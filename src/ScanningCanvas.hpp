@@ -0,0 +1,97 @@
+#ifndef ScanningCanvas_hpp
+#define ScanningCanvas_hpp
+
+#include <vector>
+#include <stdint.h>
+#include <opencv2/opencv.hpp>
+#include <base/Angle.hpp>
+#include <base/samples/Sonar.hpp>
+#include "sonarlog_obstacle_detection/PolarSweep.hpp"
+#include "sonarlog_obstacle_detection/ScanningWedge.hpp"
+
+namespace sonarlog_obstacle_detection {
+
+/*
+ * Cartesian canvas of a mechanically scanned sonar, sized after its range.
+ *
+ * The canvas is square with the sonar at its center, as a ScanningHolder
+ * canvas, but its side follows the pings: about one pixel per bin at the
+ * far edge, no finer than min_pixel_size meters and at most max_size
+ * pixels. Half the side always covers the range of the last ping, so
+ * detection::getWorldPoint on the forward half keeps the metric scale of
+ * meters_per_pixel().
+ *
+ * The sweep is kept on a PolarSweep, so a range change resamples the beams
+ * already swept and renders them again on the new canvas instead of
+ * starting from an empty one.
+ */
+class ScanningCanvas {
+public:
+
+    ScanningCanvas(base::Angle left_limit = base::Angle::fromDeg(45),
+                   base::Angle right_limit = base::Angle::fromDeg(-45),
+                   int max_size = 800,
+                   double min_pixel_size = 0.01,
+                   base::Angle resolution = base::Angle::fromDeg(1.8));
+
+    /* adds a ping and returns the region of the canvas that changed */
+    cv::Rect update(const base::samples::Sonar& sample);
+
+    void reset();
+
+    /* CV_32FC1, size() x size() */
+    const cv::Mat& image() const {
+        return image_;
+    }
+
+    int size() const {
+        return image_.cols;
+    }
+
+    /* meters covered by half the canvas */
+    double range() const {
+        return range_;
+    }
+
+    double meters_per_pixel() const {
+        return (image_.cols) ? range_ / (image_.cols / 2) : 0;
+    }
+
+    /* canvas resizes and rescales since the construction */
+    size_t retargets() const {
+        return retargets_;
+    }
+
+    const PolarSweep& sweep() const {
+        return sweep_;
+    }
+
+    /* the side (even) of the canvas for a sonar of bin_count bins over range meters */
+    static int canvas_size(uint32_t bin_count, double range, int max_size, double min_pixel_size);
+
+private:
+
+    void retarget(uint32_t bin_count, double range);
+
+    void render(const cv::Rect& rect);
+
+    int max_size_;
+    double min_pixel_size_;
+
+    PolarSweep sweep_;
+    ScanningWedge wedge_;
+    double left_limit_;
+    double resolution_;
+
+    uint32_t bin_count_;
+    double range_;
+    size_t retargets_;
+
+    // the grid element of every pixel (row-major, -1 outside the sector)
+    std::vector<int32_t> indices_;
+    cv::Mat image_;
+};
+
+} /* namespace sonarlog_obstacle_detection */
+
+#endif /* ScanningCanvas_hpp */
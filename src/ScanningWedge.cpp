@@ -0,0 +1,87 @@
+#include <algorithm>
+#include <cmath>
+#include "sonarlog_obstacle_detection/ScanningWedge.hpp"
+
+namespace sonarlog_obstacle_detection {
+
+namespace {
+
+// margin in pixels around the wedge, for the rasterization of the beam edges
+const int WEDGE_MARGIN = 2;
+
+inline double normalize_angle(double angle) {
+    while (angle > M_PI) angle -= 2 * M_PI;
+    while (angle <= -M_PI) angle += 2 * M_PI;
+    return angle;
+}
+
+}
+
+ScanningWedge::ScanningWedge(int width, int height, base::Angle max_step)
+    : size_(width, height)
+    , max_step_(fabs(max_step.getRad()))
+    , has_last_(false)
+    , last_bearing_(0)
+    , last_bin_count_(0) {
+}
+
+cv::Rect ScanningWedge::update(const base::samples::Sonar& sample) {
+    cv::Rect full(0, 0, size_.width, size_.height);
+    if (sample.bearings.empty()) return full;
+
+    double bearing = sample.bearings[0].getRad();
+    double step = normalize_angle(bearing - last_bearing_);
+    bool changed = !has_last_ || sample.bin_count != last_bin_count_ || fabs(step) > max_step_;
+
+    double from = last_bearing_;
+    has_last_ = true;
+    last_bearing_ = bearing;
+    last_bin_count_ = sample.bin_count;
+
+    if (changed) return full;
+
+    // the bearing unwrapped next to the last one, so a scan across +-pi keeps from < to
+    double to = from + step;
+    double half_beam = sample.beam_width.getRad() / 2;
+    if (step < 0) {
+        return wedge(to - half_beam, from + half_beam);
+    }
+    return wedge(from - half_beam, to + half_beam);
+}
+
+cv::Rect ScanningWedge::wedge(double from, double to) const {
+    cv::Rect full(0, 0, size_.width, size_.height);
+    if (to - from >= M_PI) return full;
+
+    double cx = size_.width / 2.0;
+    double cy = size_.height / 2.0;
+    double radius = std::min(size_.width, size_.height) / 2.0;
+
+    // the origin, both arc ends and every axis crossing inside the arc (two at most, the arc is under half a turn)
+    double min_x = cx, max_x = cx, min_y = cy, max_y = cy;
+
+    double angles[4];
+    size_t count = 0;
+    angles[count++] = from;
+    angles[count++] = to;
+    for (double axis = ceil(from / M_PI_2) * M_PI_2; axis < to && count < 4; axis += M_PI_2) {
+        if (axis > from) angles[count++] = axis;
+    }
+
+    for (size_t i = 0; i < count; i++) {
+        // positive bearings point to the left of the canvas
+        double x = cx - radius * sin(angles[i]);
+        double y = cy - radius * cos(angles[i]);
+        min_x = std::min(min_x, x);
+        max_x = std::max(max_x, x);
+        min_y = std::min(min_y, y);
+        max_y = std::max(max_y, y);
+    }
+
+    cv::Rect rect(floor(min_x) - WEDGE_MARGIN, floor(min_y) - WEDGE_MARGIN,
+                  ceil(max_x) - floor(min_x) + 2 * WEDGE_MARGIN + 1,
+                  ceil(max_y) - floor(min_y) + 2 * WEDGE_MARGIN + 1);
+    return rect & full;
+}
+
+} /* namespace sonarlog_obstacle_detection */
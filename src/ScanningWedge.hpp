@@ -0,0 +1,49 @@
+#ifndef ScanningWedge_hpp
+#define ScanningWedge_hpp
+
+#include <opencv2/opencv.hpp>
+#include <base/Angle.hpp>
+#include <base/samples/Sonar.hpp>
+
+namespace sonarlog_obstacle_detection {
+
+/*
+ * Tracks the part of a ScanningHolder canvas touched by each update.
+ *
+ * A mechanically scanned sonar adds one beam per ping, so the canvas only
+ * changes inside the angular wedge between the previous and the current
+ * bearing. update() returns the bounding rect of that wedge, widened by half
+ * a beam on each side. It returns the whole canvas on the first ping, after
+ * a range change, or when the bearing jumps by more than max_step.
+ */
+class ScanningWedge {
+public:
+
+    ScanningWedge(int width, int height, base::Angle max_step = base::Angle::fromDeg(30));
+
+    cv::Rect update(const base::samples::Sonar& sample);
+
+    void reset() {
+        has_last_ = false;
+    }
+
+    cv::Size size() const {
+        return size_;
+    }
+
+    /* bounding rect of the wedge between two bearings (radians) */
+    cv::Rect wedge(double from, double to) const;
+
+private:
+
+    cv::Size size_;
+    double max_step_;
+
+    bool has_last_;
+    double last_bearing_;
+    uint32_t last_bin_count_;
+};
+
+} /* namespace sonarlog_obstacle_detection */
+
+#endif /* ScanningWedge_hpp */
@@ -0,0 +1,66 @@
+#include "sonarlog_obstacle_detection/MappedLog.hpp"
+#include "sonarlog_obstacle_detection/SparseBinFilter.hpp"
+#include "sonarlog_obstacle_detection/SparseBinKernel.hpp"
+
+namespace sonarlog_obstacle_detection {
+
+SparseBinFilter::SparseBinFilter(Mode mode)
+    : newest_(0)
+    , output_(0)
+    , count_(0)
+    , mode_(mode) {
+}
+
+bool SparseBinFilter::push(const base::samples::Sonar& sample) {
+    next_slot(sample.bin_count, sample.beam_count) = sample;
+    return filter_window();
+}
+
+bool SparseBinFilter::push(const SonarView& view) {
+    view.copy_to(next_slot(view.bin_count, view.beam_count));
+    return filter_window();
+}
+
+base::samples::Sonar& SparseBinFilter::next_slot(uint32_t bin_count, uint32_t beam_count) {
+    const base::samples::Sonar& newest = slots_[newest_];
+    if (count_ && (newest.bin_count != bin_count || newest.beam_count != beam_count)) {
+        count_ = 0;
+    }
+
+    // the free slot is the one handed out by the previous push
+    newest_ = (newest_ + 1) % WINDOW_SIZE;
+    count_++;
+    return slots_[newest_];
+}
+
+bool SparseBinFilter::filter_window() {
+    if (count_ < WINDOW_SIZE) return false;
+
+    size_t middle = (newest_ + WINDOW_SIZE - 1) % WINDOW_SIZE;
+    size_t oldest = (newest_ + WINDOW_SIZE - 2) % WINDOW_SIZE;
+    filter(slots_[middle], slots_[newest_], slots_[oldest]);
+
+    output_ = oldest;
+    count_--;
+    return true;
+}
+
+void SparseBinFilter::filter(base::samples::Sonar& current, const base::samples::Sonar& last, const base::samples::Sonar& next) const {
+    const size_t bin_count = current.bin_count;
+    if (current.bins.size() < bin_count * current.beam_count) return;
+
+    for (size_t beam = 0; beam < current.beam_count; beam++) {
+        float *c = &current.bins[beam * bin_count];
+        const float *l = &last.bins[beam * bin_count];
+        const float *n = &next.bins[beam * bin_count];
+
+        if (mode_ == TEMPORAL) {
+            sparse_bins::remove_temporal(c, l, n, bin_count);
+        }
+        else {
+            sparse_bins::remove_spatio_temporal(c, l, n, bin_count);
+        }
+    }
+}
+
+} /* namespace sonarlog_obstacle_detection */
@@ -0,0 +1,81 @@
+#ifndef SparseBinFilter_hpp
+#define SparseBinFilter_hpp
+
+#include <base/samples/Sonar.hpp>
+
+namespace sonarlog_obstacle_detection {
+
+struct SonarView;
+
+/*
+ * Removes isolated bins using a window of three consecutive pings.
+ *
+ * The window is a fixed ring of sample buffers: push() copies the new ping
+ * into the free buffer (reusing its storage), filters the middle ping in
+ * place and hands out the oldest one, which was filtered on the previous
+ * push. Once the buffers are sized, no memory is allocated.
+ */
+class SparseBinFilter {
+public:
+
+    enum Mode {
+        // drop a bin absent in the previous and in the next ping
+        TEMPORAL,
+
+        // also drop a bin whose neighbours in the same beam are empty
+        SPATIO_TEMPORAL
+    };
+
+    SparseBinFilter(Mode mode = TEMPORAL);
+
+    /*
+     * Adds a ping to the window. Returns true when output() holds a
+     * filtered ping, which stays valid until the next call.
+     */
+    bool push(const base::samples::Sonar& sample);
+
+    /* the same for a view of a mapped log, copied straight into the window */
+    bool push(const SonarView& view);
+
+    const base::samples::Sonar& output() const {
+        return slots_[output_];
+    }
+
+    void reset() {
+        count_ = 0;
+    }
+
+    size_t size() const {
+        return count_;
+    }
+
+    Mode mode() const {
+        return mode_;
+    }
+
+    void set_mode(Mode mode) {
+        mode_ = mode;
+    }
+
+private:
+
+    static const size_t WINDOW_SIZE = 3;
+
+    /* the free slot for a ping of this size, restarting the window if the size changed */
+    base::samples::Sonar& next_slot(uint32_t bin_count, uint32_t beam_count);
+
+    /* filters the middle ping once the window is full */
+    bool filter_window();
+
+    void filter(base::samples::Sonar& current, const base::samples::Sonar& last, const base::samples::Sonar& next) const;
+
+    base::samples::Sonar slots_[WINDOW_SIZE];
+    size_t newest_;
+    size_t output_;
+    size_t count_;
+    Mode mode_;
+};
+
+} /* namespace sonarlog_obstacle_detection */
+
+#endif /* SparseBinFilter_hpp */
@@ -0,0 +1,194 @@
+#include "sonarlog_obstacle_detection/SparseBinKernel.hpp"
+
+#if defined(__GNUC__) && (defined(__x86_64__) || defined(__i386__))
+#define SPARSE_BINS_X86
+#include <immintrin.h>
+#endif
+
+namespace sonarlog_obstacle_detection {
+
+namespace sparse_bins {
+
+namespace {
+
+void temporal_scalar(float *c, const float *l, const float *n, size_t begin, size_t end) {
+    for (size_t i = begin; i < end; i++) {
+        if (c[i] && !l[i] && !n[i]) {
+            c[i] = 0;
+        }
+    }
+}
+
+void spatio_temporal_scalar(float *c, const float *l, const float *n, size_t begin, size_t end) {
+    for (size_t i = begin; i < end; i++) {
+        if (c[i] && ((!l[i] && !n[i]) || (!c[i - 1] && !c[i + 1]))) {
+            c[i] = 0;
+        }
+    }
+}
+
+#ifdef SPARSE_BINS_X86
+
+/*
+ * The spatial rule reads c[i - 1] after it was updated. A bin is only
+ * cleared when c[i] is set, and then c[i - 1] was cleared by the temporal
+ * rule alone, so the updated neighbour is (c[i - 1] && !A[i - 1]), where A
+ * is the temporal condition. The first lane reads the stored result of the
+ * previous block, for which that expression is already exact.
+ */
+
+__attribute__((target("sse2")))
+void temporal_sse2(float *c, const float *l, const float *n, size_t size) {
+    const __m128 zero = _mm_setzero_ps();
+
+    size_t i = 0;
+    for (; i + 4 <= size; i += 4) {
+        __m128 cur = _mm_loadu_ps(c + i);
+        __m128 kill = _mm_and_ps(_mm_cmpneq_ps(cur, zero),
+                      _mm_and_ps(_mm_cmpeq_ps(_mm_loadu_ps(l + i), zero),
+                                 _mm_cmpeq_ps(_mm_loadu_ps(n + i), zero)));
+        _mm_storeu_ps(c + i, _mm_andnot_ps(kill, cur));
+    }
+
+    temporal_scalar(c, l, n, i, size);
+}
+
+__attribute__((target("sse2")))
+void spatio_temporal_sse2(float *c, const float *l, const float *n, size_t size) {
+    const __m128 zero = _mm_setzero_ps();
+
+    spatio_temporal_scalar(c, l, n, 1, 2);
+
+    size_t i = 2;
+    for (; i + 4 < size; i += 4) {
+        __m128 cur = _mm_loadu_ps(c + i);
+        __m128 prev = _mm_loadu_ps(c + i - 1);
+        __m128 next = _mm_loadu_ps(c + i + 1);
+
+        __m128 temporal = _mm_and_ps(_mm_cmpeq_ps(_mm_loadu_ps(l + i), zero),
+                                     _mm_cmpeq_ps(_mm_loadu_ps(n + i), zero));
+        __m128 prev_temporal = _mm_and_ps(_mm_cmpeq_ps(_mm_loadu_ps(l + i - 1), zero),
+                                          _mm_cmpeq_ps(_mm_loadu_ps(n + i - 1), zero));
+
+        __m128 prev_set = _mm_andnot_ps(prev_temporal, _mm_cmpneq_ps(prev, zero));
+        __m128 isolated = _mm_andnot_ps(prev_set, _mm_cmpeq_ps(next, zero));
+        __m128 kill = _mm_and_ps(_mm_cmpneq_ps(cur, zero), _mm_or_ps(temporal, isolated));
+
+        _mm_storeu_ps(c + i, _mm_andnot_ps(kill, cur));
+    }
+
+    spatio_temporal_scalar(c, l, n, i, size - 1);
+}
+
+__attribute__((target("avx2")))
+void temporal_avx2(float *c, const float *l, const float *n, size_t size) {
+    const __m256 zero = _mm256_setzero_ps();
+
+    size_t i = 0;
+    for (; i + 8 <= size; i += 8) {
+        __m256 cur = _mm256_loadu_ps(c + i);
+        __m256 kill = _mm256_and_ps(_mm256_cmp_ps(cur, zero, _CMP_NEQ_UQ),
+                      _mm256_and_ps(_mm256_cmp_ps(_mm256_loadu_ps(l + i), zero, _CMP_EQ_OQ),
+                                    _mm256_cmp_ps(_mm256_loadu_ps(n + i), zero, _CMP_EQ_OQ)));
+        _mm256_storeu_ps(c + i, _mm256_andnot_ps(kill, cur));
+    }
+
+    temporal_scalar(c, l, n, i, size);
+}
+
+__attribute__((target("avx2")))
+void spatio_temporal_avx2(float *c, const float *l, const float *n, size_t size) {
+    const __m256 zero = _mm256_setzero_ps();
+
+    spatio_temporal_scalar(c, l, n, 1, 2);
+
+    size_t i = 2;
+    for (; i + 8 < size; i += 8) {
+        __m256 cur = _mm256_loadu_ps(c + i);
+        __m256 prev = _mm256_loadu_ps(c + i - 1);
+        __m256 next = _mm256_loadu_ps(c + i + 1);
+
+        __m256 temporal = _mm256_and_ps(_mm256_cmp_ps(_mm256_loadu_ps(l + i), zero, _CMP_EQ_OQ),
+                                        _mm256_cmp_ps(_mm256_loadu_ps(n + i), zero, _CMP_EQ_OQ));
+        __m256 prev_temporal = _mm256_and_ps(_mm256_cmp_ps(_mm256_loadu_ps(l + i - 1), zero, _CMP_EQ_OQ),
+                                             _mm256_cmp_ps(_mm256_loadu_ps(n + i - 1), zero, _CMP_EQ_OQ));
+
+        __m256 prev_set = _mm256_andnot_ps(prev_temporal, _mm256_cmp_ps(prev, zero, _CMP_NEQ_UQ));
+        __m256 isolated = _mm256_andnot_ps(prev_set, _mm256_cmp_ps(next, zero, _CMP_EQ_OQ));
+        __m256 kill = _mm256_and_ps(_mm256_cmp_ps(cur, zero, _CMP_NEQ_UQ), _mm256_or_ps(temporal, isolated));
+
+        _mm256_storeu_ps(c + i, _mm256_andnot_ps(kill, cur));
+    }
+
+    spatio_temporal_scalar(c, l, n, i, size - 1);
+}
+
+#endif
+
+} /* namespace */
+
+Isa best_isa() {
+    static const Isa isa = isa_supported(ISA_AVX2) ? ISA_AVX2 : (isa_supported(ISA_SSE2) ? ISA_SSE2 : ISA_SCALAR);
+    return isa;
+}
+
+bool isa_supported(Isa isa) {
+    switch (isa) {
+        case ISA_SCALAR:
+            return true;
+#ifdef SPARSE_BINS_X86
+        case ISA_SSE2:
+            __builtin_cpu_init();
+            return __builtin_cpu_supports("sse2");
+        case ISA_AVX2:
+            __builtin_cpu_init();
+            return __builtin_cpu_supports("avx2");
+#endif
+        default:
+            return false;
+    }
+}
+
+const char* isa_name(Isa isa) {
+    switch (isa) {
+        case ISA_SSE2: return "sse2";
+        case ISA_AVX2: return "avx2";
+        default: return "scalar";
+    }
+}
+
+void remove_temporal(float *current, const float *last, const float *next, size_t size, Isa isa) {
+#ifdef SPARSE_BINS_X86
+    if (isa == ISA_AVX2) {
+        temporal_avx2(current, last, next, size);
+        return;
+    }
+
+    if (isa == ISA_SSE2) {
+        temporal_sse2(current, last, next, size);
+        return;
+    }
+#endif
+    temporal_scalar(current, last, next, 0, size);
+}
+
+void remove_spatio_temporal(float *current, const float *last, const float *next, size_t size, Isa isa) {
+    if (size < 3) return;
+
+#ifdef SPARSE_BINS_X86
+    if (isa == ISA_AVX2) {
+        spatio_temporal_avx2(current, last, next, size);
+        return;
+    }
+
+    if (isa == ISA_SSE2) {
+        spatio_temporal_sse2(current, last, next, size);
+        return;
+    }
+#endif
+    spatio_temporal_scalar(current, last, next, 1, size - 1);
+}
+
+} /* namespace sparse_bins */
+
+} /* namespace sonarlog_obstacle_detection */
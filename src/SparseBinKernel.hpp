@@ -0,0 +1,48 @@
+#ifndef SparseBinKernel_hpp
+#define SparseBinKernel_hpp
+
+#include <cstddef>
+
+namespace sonarlog_obstacle_detection {
+
+/*
+ * Isolated-bin suppression kernels used by SparseBinFilter.
+ *
+ * Each rule clears current[i] in place, using the previous (last) and the
+ * following (next) ping of the same beam. The vectorized versions are
+ * branch-free and produce bit-identical results to the scalar loops.
+ */
+namespace sparse_bins {
+
+enum Isa {
+    ISA_SCALAR = 0,
+    ISA_SSE2,
+    ISA_AVX2
+};
+
+/* the widest instruction set supported by the running cpu */
+Isa best_isa();
+
+bool isa_supported(Isa isa);
+
+const char* isa_name(Isa isa);
+
+/* current[i] && !last[i] && !next[i] */
+void remove_temporal(float *current, const float *last, const float *next, size_t size, Isa isa);
+
+/* as remove_temporal, or when both neighbours in the beam are empty (bins 1 to size - 2) */
+void remove_spatio_temporal(float *current, const float *last, const float *next, size_t size, Isa isa);
+
+inline void remove_temporal(float *current, const float *last, const float *next, size_t size) {
+    remove_temporal(current, last, next, size, best_isa());
+}
+
+inline void remove_spatio_temporal(float *current, const float *last, const float *next, size_t size) {
+    remove_spatio_temporal(current, last, next, size, best_isa());
+}
+
+} /* namespace sparse_bins */
+
+} /* namespace sonarlog_obstacle_detection */
+
+#endif /* SparseBinKernel_hpp */
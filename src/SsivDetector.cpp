@@ -0,0 +1,182 @@
+#include "sonarlog_obstacle_detection/SsivDetector.hpp"
+
+namespace sonarlog_obstacle_detection {
+
+namespace {
+
+inline cv::Rect expand(const cv::Rect& rect, int margin, const cv::Rect& bounds) {
+    return cv::Rect(rect.x - margin, rect.y - margin, rect.width + 2 * margin, rect.height + 2 * margin) & bounds;
+}
+
+/* columns [x, x + width) of the left half mirrored into the right half, and back */
+inline cv::Rect mirror(const cv::Rect& rect, int half) {
+    return cv::Rect(half - rect.x - rect.width, rect.y, rect.width, rect.height);
+}
+
+}
+
+SsivDetector::SsivDetector(const SsivParameters& parameters)
+    : parameters_(parameters)
+    , range_roi_(parameters.min_range, parameters.max_range)
+    , tracker_(parameters.tracker)
+    , processed_pixels_(0)
+    , work_(0)
+    , skip_(SKIP_NONE) {
+    kernel_ = cv::getStructuringElement(cv::MORPH_ELLIPSE, cv::Size(parameters_.morph_size, parameters_.morph_size));
+    bit_kernel_ = BitMask::kernel(kernel_);
+    morph_margin_ = (parameters_.morph_size / 2) * 2 * parameters_.morph_iterations;
+    changed_.reserve(2);
+}
+
+void SsivDetector::process(const cv::Mat& cart, const base::samples::Sonar& sample) {
+    process(cart, sample, cv::Rect(0, 0, cart.cols, cart.rows));
+}
+
+void SsivDetector::process(const cv::Mat& cart, const base::samples::Sonar& sample, const cv::Rect& dirty) {
+    cv::Rect frame(0, 0, cart.cols, cart.rows * 0.5);
+
+    cv::Rect region = dirty & frame;
+    if (range_roi_.update(sample, frame.size()) || blurred_.size() != frame.size()) {
+        blurred_ = pool_.get(BUFFER_BLURRED, frame.size(), CV_32FC1);
+        filtered_ = pool_.get(BUFFER_FILTERED, frame.size(), CV_32FC1);
+        thresh_ = pool_.get(BUFFER_THRESH, frame.size(), CV_32FC1);
+        opened_ = pool_.get(BUFFER_OPENED, frame.size(), CV_32FC1);
+
+        // rows out of range stay empty in the binary images
+        thresh_.setTo(0);
+        opened_.setTo(0);
+        mask_.create(frame.height, frame.width);
+        roi_ = filtered_(range_roi_.rect());
+        region = frame;
+        tracker_.reset();
+    }
+
+    processed_pixels_ = 0;
+    work_ = 0;
+
+    if (region.area()) {
+        blur_region(cart, region);
+
+        changed_.clear();
+        if (skip_ & SKIP_SYMMETRIC_REMOVAL) {
+            cv::Rect rect = expand(region, 1, frame);
+            blurred_(rect).copyTo(filtered_(rect));
+            changed_.push_back(rect);
+            work_ += rect.area();
+        }
+        else {
+            remove_symmetric_region(expand(region, 1, frame), changed_);
+        }
+
+        // the bit-packed opening thresholds the filtered image itself
+        if (!parameters_.bit_morphology || (skip_ & SKIP_MORPHOLOGY)) {
+            for (size_t i = 0; i < changed_.size(); i++) threshold_region(changed_[i]);
+        }
+
+        for (size_t i = 0; i < changed_.size(); i++) {
+            if (skip_ & SKIP_MORPHOLOGY) {
+                cv::Rect rect = changed_[i] & range_roi_.rect();
+                thresh_(rect).copyTo(opened_(rect));
+                if (parameters_.bit_morphology) {
+                    bits_.threshold(thresh_(rect), 0.5f);
+                    bits_.copy_to(mask_, cv::Rect(0, 0, rect.width, rect.height), rect.tl());
+                }
+                work_ += rect.area();
+            }
+            else {
+                morphology_region(changed_[i]);
+            }
+        }
+    }
+
+    work_ += processed_pixels_;
+
+    // the forward half of the canvas covers the range of the ping
+    float range = (parameters_.world_range > 0) ? parameters_.world_range : sample.getBinStartDistance(sample.bin_count);
+    if (parameters_.track_blobs) {
+        target_ = tracker_.update(opened_, range);
+    }
+    else if (parameters_.bit_morphology) {
+        target_ = detection::getMaskTarget(mask_, parameters_.min_contour_pixels, range);
+    }
+    else {
+        blobs_ = detection::findBiggestBlob(opened_, parameters_.min_contour_pixels, range, target_, pool_);
+    }
+}
+
+void SsivDetector::blur_region(const cv::Mat& cart, const cv::Rect& region) {
+    cv::Rect frame(0, 0, blurred_.cols, blurred_.rows);
+    cv::Rect output = expand(region, 1, frame);
+
+    // like a blur on a view of the canvas, pixels below the frame are read
+    cv::Rect input = expand(output, 1, cv::Rect(0, 0, cart.cols, cart.rows));
+
+    cv::Mat& buffer = pool_.get(BUFFER_BLUR_BLOCK, cv::Size(cart.cols, frame.height + 2), CV_32FC1);
+    cv::Mat block = buffer(cv::Rect(0, 0, input.width, input.height));
+    cv::blur(cart(input), block, cv::Size(3, 3));
+    block(output - input.tl()).copyTo(blurred_(output));
+
+    processed_pixels_ += input.area();
+}
+
+void SsivDetector::remove_symmetric_region(const cv::Rect& region, std::vector<cv::Rect>& changed) {
+    const int half = blurred_.cols / 2;
+    cv::Rect half_frame(0, 0, half, blurred_.rows);
+
+    // region in right half coordinates, including the mirror of its left part
+    cv::Rect right = (region - cv::Point(half, 0)) & half_frame;
+    cv::Rect left = mirror(region & half_frame, half) & half_frame;
+    cv::Rect target = (right.area() && left.area()) ? (right | left) : (right.area() ? right : left);
+
+    // the median 3x3 spreads the change by one pixel
+    target = expand(target, 1, half_frame);
+    symmetric_.apply(blurred_, filtered_, target);
+    work_ += 2 * target.area();
+
+    cv::Rect dst_right = target + cv::Point(half, 0);
+    cv::Rect dst_left = mirror(target, half);
+
+    changed.push_back(dst_left);
+    changed.push_back(dst_right);
+}
+
+void SsivDetector::threshold_region(const cv::Rect& region) {
+    cv::Rect rect = region & range_roi_.rect();
+    if (!rect.area()) return;
+
+    cv::Mat thresh = thresh_(rect);
+    cv::threshold(filtered_(rect), thresh, parameters_.threshold, 1.0, CV_THRESH_BINARY);
+    work_ += rect.area();
+}
+
+void SsivDetector::morphology_region(const cv::Rect& region) {
+    cv::Rect frame(0, 0, thresh_.cols, thresh_.rows);
+
+    // an opening never grows a blob, so the output is empty out of range
+    cv::Rect output = expand(region, morph_margin_, frame) & range_roi_.rect();
+    if (!output.area()) return;
+
+    cv::Rect input = expand(output, morph_margin_, frame);
+    work_ += input.area() * parameters_.morph_iterations * 2;
+
+    if (parameters_.bit_morphology) {
+        const cv::Rect& roi = range_roi_.rect();
+        bits_.threshold(filtered_(input), parameters_.threshold, roi.y - input.y, roi.y + roi.height - input.y);
+        BitMask::open(bits_, bits_open_, bit_kernel_, parameters_.morph_iterations, bits_work_);
+
+        cv::Mat dst = opened_(output);
+        bits_open_.copy_to(dst, output - input.tl());
+        bits_open_.copy_to(mask_, output - input.tl(), output.tl());
+        return;
+    }
+
+    // the dilation runs on the eroded block: isolate it from the rest of the
+    // pool buffer, left over from earlier pings, as the image border would be
+    cv::Mat& buffer = pool_.get(BUFFER_MORPHOLOGY_BLOCK, frame.size(), CV_32FC1);
+    cv::Mat block = buffer(cv::Rect(0, 0, input.width, input.height));
+    cv::morphologyEx(thresh_(input), block, cv::MORPH_OPEN, kernel_, cv::Point(-1, -1), parameters_.morph_iterations,
+                     cv::BORDER_CONSTANT | cv::BORDER_ISOLATED);
+    block(output - input.tl()).copyTo(opened_(output));
+}
+
+} /* namespace sonarlog_obstacle_detection */
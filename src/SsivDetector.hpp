@@ -0,0 +1,193 @@
+#ifndef SsivDetector_hpp
+#define SsivDetector_hpp
+
+#include <vector>
+#include <opencv2/opencv.hpp>
+#include <base/samples/Sonar.hpp>
+#include "sonarlog_obstacle_detection/BitMask.hpp"
+#include "sonarlog_obstacle_detection/BlobTracker.hpp"
+#include "sonarlog_obstacle_detection/Detection.hpp"
+#include "sonarlog_obstacle_detection/FramePool.hpp"
+#include "sonarlog_obstacle_detection/RangeRoi.hpp"
+#include "sonarlog_obstacle_detection/SymmetricRemoval.hpp"
+
+namespace sonarlog_obstacle_detection {
+
+struct SsivParameters {
+    SsivParameters()
+        : min_range(1)
+        , max_range(7)
+        , threshold(0.1)
+        , morph_size(5)
+        , morph_iterations(2)
+        , min_contour_pixels(100)
+        , bit_morphology(true)
+        , track_blobs(false)
+        , world_range(0) {
+    }
+
+    // range limits (meters) of the region of interest
+    float min_range;
+    float max_range;
+
+    // binarization threshold of the filtered image
+    double threshold;
+
+    // elliptic opening applied to the binary image
+    int morph_size;
+    int morph_iterations;
+
+    // contours with fewer points are ignored (with bit_morphology, masks with fewer pixels)
+    int min_contour_pixels;
+
+    // run the opening on bit-packed masks (same binary image as cv::morphologyEx); the
+    // target is then the bbox and pixel count of the whole mask, from its words, and
+    // blobs() stays empty
+    bool bit_morphology;
+
+    // follow the blob with a BlobTracker instead of findBiggestBlob (blobs() stays empty);
+    // it keeps components of tracker.min_area pixels rather than contours of
+    // min_contour_pixels points, and ignores new blobs out of its gate while it
+    // holds a track
+    bool track_blobs;
+    BlobTrackerParameters tracker;
+
+    // range (meters) covered by the image height in getWorldPoint, 0 for the range of the ping
+    float world_range;
+};
+
+/*
+ * Obstacle detection on the forward half of a ScanningHolder canvas:
+ * blur, symmetric reflection removal, range ROI, threshold, opening and
+ * biggest blob.
+ *
+ * Every stage keeps its output between pings. When the caller passes the
+ * region of the canvas that changed (see ScanningWedge), each stage only
+ * recomputes that region widened by its filter radius. The result is
+ * identical to processing the whole frame. With track_blobs, the blob
+ * search only labels a window around the tracked target.
+ */
+class SsivDetector {
+public:
+
+    /* stages that a late ping may skip, see set_skip() */
+    enum Skip {
+        SKIP_NONE = 0,
+        SKIP_SYMMETRIC_REMOVAL = 1,
+        SKIP_MORPHOLOGY = 2
+    };
+
+    SsivDetector(const SsivParameters& parameters = SsivParameters());
+
+    /* processes the whole canvas */
+    void process(const cv::Mat& cart, const base::samples::Sonar& sample);
+
+    /* processes a canvas that changed only inside dirty since the last call */
+    void process(const cv::Mat& cart, const base::samples::Sonar& sample, const cv::Rect& dirty);
+
+    const cv::Mat& filtered() const {
+        return filtered_;
+    }
+
+    /* the filtered rows inside [min_range, max_range] */
+    const cv::Mat& roi() const {
+        return roi_;
+    }
+
+    const RangeRoi& range_roi() const {
+        return range_roi_;
+    }
+
+    const cv::Mat& binary() const {
+        return opened_;
+    }
+
+    const cv::Mat& blobs() const {
+        return blobs_;
+    }
+
+    const BlobTracker& tracker() const {
+        return tracker_;
+    }
+
+    const detection::Target& target() const {
+        return target_;
+    }
+
+    const SsivParameters& parameters() const {
+        return parameters_;
+    }
+
+    /* buffers of every stage, with their allocation counters */
+    const FramePool& pool() const {
+        return pool_;
+    }
+
+    /* pixels recomputed by the last call, in the blur stage */
+    size_t processed_pixels() const {
+        return processed_pixels_;
+    }
+
+    /* pixels written by every stage in the last call, a deterministic measure of its cost */
+    size_t work() const {
+        return work_;
+    }
+
+    /*
+     * Skips stages of the next calls (a mask of Skip): a skipped stage
+     * copies its input into its output inside the changed region. Those
+     * pixels stay degraded until the region changes again.
+     */
+    void set_skip(int skip) {
+        skip_ = skip;
+    }
+
+    int skip() const {
+        return skip_;
+    }
+
+private:
+
+    void blur_region(const cv::Mat& cart, const cv::Rect& region);
+
+    void remove_symmetric_region(const cv::Rect& region, std::vector<cv::Rect>& changed);
+
+    void threshold_region(const cv::Rect& region);
+
+    void morphology_region(const cv::Rect& region);
+
+    SsivParameters parameters_;
+    cv::Mat kernel_;
+    BitMask::Kernel bit_kernel_;
+    int morph_margin_;
+
+    SymmetricRemoval symmetric_;
+    FramePool pool_;
+
+    cv::Mat blurred_;
+    cv::Mat filtered_;
+    cv::Mat roi_;
+    cv::Mat thresh_;
+    cv::Mat opened_;
+    cv::Mat blobs_;
+    std::vector<cv::Rect> changed_;
+
+    BitMask bits_;
+    BitMask bits_open_;
+    BitMask bits_work_;
+
+    // opened_ as bits, kept up to date by the bit-packed opening
+    BitMask mask_;
+
+    RangeRoi range_roi_;
+    BlobTracker tracker_;
+
+    detection::Target target_;
+    size_t processed_pixels_;
+    size_t work_;
+    int skip_;
+};
+
+} /* namespace sonarlog_obstacle_detection */
+
+#endif /* SsivDetector_hpp */
@@ -0,0 +1,89 @@
+#include <algorithm>
+#include "sonarlog_obstacle_detection/SymmetricRemoval.hpp"
+
+namespace sonarlog_obstacle_detection {
+
+namespace {
+
+inline void sort2(float& a, float& b) {
+    float t = std::min(a, b);
+    b = std::max(a, b);
+    a = t;
+}
+
+/* median of nine values with the sorting network used by cv::medianBlur */
+inline float median9(float p0, float p1, float p2, float p3, float p4, float p5, float p6, float p7, float p8) {
+    sort2(p1, p2); sort2(p4, p5); sort2(p7, p8);
+    sort2(p0, p1); sort2(p3, p4); sort2(p6, p7);
+    sort2(p1, p2); sort2(p4, p5); sort2(p7, p8);
+    sort2(p0, p3); sort2(p5, p8); sort2(p4, p7);
+    sort2(p3, p6); sort2(p1, p4); sort2(p2, p5);
+    sort2(p4, p7); sort2(p4, p2); sort2(p6, p4);
+    sort2(p4, p2);
+    return p4;
+}
+
+}
+
+void SymmetricRemoval::apply(const cv::Mat& src, cv::Mat& dst) {
+    dst.create(src.size(), CV_32FC1);
+    apply(src, dst, cv::Rect(0, 0, src.cols / 2, src.rows));
+}
+
+void SymmetricRemoval::compute_row(const cv::Mat& src, int y, int x0, float *row) const {
+    const int half = src.cols / 2;
+    const int width = ring_.size() / 3;
+    const float *s = src.ptr<float>(y);
+
+    // row[k] holds column x0 - 1 + k, replicated at the borders of the half
+    for (int k = 0; k < width; k++) {
+        int x = std::min(std::max(x0 - 1 + k, 0), half - 1);
+        row[k] = 1 - (s[half - 1 - x] + s[half + x]);
+    }
+}
+
+void SymmetricRemoval::apply(const cv::Mat& src, cv::Mat& dst, const cv::Rect& region) {
+    const int half = src.cols / 2;
+    cv::Rect r = region & cv::Rect(0, 0, half, src.rows);
+    if (!r.area()) return;
+
+    const int width = r.width + 2;
+    ring_.resize(3 * width);
+    ring_rows_[0] = ring_rows_[1] = ring_rows_[2] = -1;
+
+    for (int y = r.y; y < r.y + r.height; y++) {
+        const int rows[3] = { std::max(y - 1, 0), y, std::min(y + 1, src.rows - 1) };
+        const float *ring[3];
+
+        for (int i = 0; i < 3; i++) {
+            int slot = rows[i] % 3;
+            float *row = &ring_[slot * width];
+            if (ring_rows_[slot] != rows[i]) {
+                compute_row(src, rows[i], r.x, row);
+                ring_rows_[slot] = rows[i];
+            }
+            ring[i] = row;
+        }
+
+        const float *s = src.ptr<float>(y);
+        float *d = dst.ptr<float>(y);
+
+        for (int k = 0; k < r.width; k++) {
+            float m = median9(ring[0][k], ring[0][k + 1], ring[0][k + 2],
+                              ring[1][k], ring[1][k + 1], ring[1][k + 2],
+                              ring[2][k], ring[2][k + 1], ring[2][k + 2]);
+            float sym = (m < threshold_) ? 0 : m;
+
+            int right = half + r.x + k;
+            int left = half - 1 - r.x - k;
+
+            float v = s[right] - sym;
+            d[right] = (v < 0) ? 0 : v;
+
+            v = s[left] - sym;
+            d[left] = (v < 0) ? 0 : v;
+        }
+    }
+}
+
+} /* namespace sonarlog_obstacle_detection */
@@ -0,0 +1,45 @@
+#ifndef SymmetricRemoval_hpp
+#define SymmetricRemoval_hpp
+
+#include <vector>
+#include <opencv2/opencv.hpp>
+
+namespace sonarlog_obstacle_detection {
+
+/*
+ * Fused version of detection::removeSymmetricData.
+ *
+ * The symmetry measure 1 - (left mirror + right) is computed row by row
+ * into a ring of three rows, the 3x3 median runs on that ring with a
+ * sorting network, and both halves of dst are written in the same pass.
+ * Nothing is allocated once dst and the ring have their size.
+ */
+class SymmetricRemoval {
+public:
+
+    SymmetricRemoval(float threshold = 0.8f)
+        : threshold_(threshold) {
+    }
+
+    /* processes the whole CV_32FC1 image src into dst */
+    void apply(const cv::Mat& src, cv::Mat& dst);
+
+    /*
+     * Processes only the columns of region, given in coordinates of the
+     * right half, and their mirror in the left half. dst must already
+     * have the size of src.
+     */
+    void apply(const cv::Mat& src, cv::Mat& dst, const cv::Rect& region);
+
+private:
+
+    void compute_row(const cv::Mat& src, int y, int x0, float *row) const;
+
+    float threshold_;
+    std::vector<float> ring_;
+    int ring_rows_[3];
+};
+
+} /* namespace sonarlog_obstacle_detection */
+
+#endif /* SymmetricRemoval_hpp */
@@ -0,0 +1,137 @@
+#include <fstream>
+#include <stdint.h>
+#include "sonarlog_obstacle_detection/MappedLog.hpp"
+#include "sonarlog_obstacle_detection/SyntheticLog.hpp"
+
+namespace sonarlog_obstacle_detection {
+
+namespace {
+
+template <typename T>
+void append(std::string& out, const T& value) {
+    out.append(reinterpret_cast<const char*>(&value), sizeof(T));
+}
+
+void append_block(std::string& out, uint8_t type, uint16_t stream, const std::string& payload) {
+    append(out, type);
+    append(out, uint8_t(0));
+    append(out, stream);
+    append(out, uint32_t(payload.size()));
+    out += payload;
+}
+
+void append_string(std::string& out, const std::string& value) {
+    append(out, uint32_t(value.size()));
+    out += value;
+}
+
+void append_declaration(std::string& out, uint16_t stream, const std::string& name,
+                        const std::string& type_name, const std::string& registry) {
+    std::string declaration;
+    append(declaration, uint8_t(1));
+    append_string(declaration, name);
+    append_string(declaration, type_name);
+    append_string(declaration, registry);
+    append_string(declaration, "");
+    append_block(out, 1, stream, declaration);
+}
+
+/* a data block stamped with time as the real time and the logical time */
+void append_sample(std::string& out, uint16_t stream, const base::Time& time, const char *data, size_t size) {
+    int64_t microseconds = time.toMicroseconds();
+    int32_t seconds = microseconds / 1000000;
+    int32_t rest = microseconds % 1000000;
+
+    std::string payload;
+    for (int i = 0; i < 2; i++) {
+        append(payload, seconds);
+        append(payload, rest);
+    }
+    append(payload, uint32_t(size));
+    append(payload, uint8_t(0));
+    payload.append(data, size);
+    append_block(out, 2, stream, payload);
+}
+
+}
+
+void SyntheticLog::add_stream(const std::string& name, const std::vector<base::samples::Sonar>& samples,
+                              const std::string& registry) {
+    Stream stream;
+    stream.name = name;
+    stream.registry = registry;
+    stream.samples = samples;
+    streams_.push_back(stream);
+}
+
+bool SyntheticLog::write(const std::string& filename) const {
+    std::string log("POCOSIM");
+    append(log, uint8_t(0));
+    append(log, uint32_t(2));
+    append(log, uint32_t(0));
+
+    append_declaration(log, 0, "other.samples", "/int32_t", "");
+    for (size_t i = 0; i < streams_.size(); i++) {
+        append_declaration(log, i + 1, streams_[i].name, "/base/samples/Sonar", streams_[i].registry);
+    }
+
+    // the oldest next sample of any stream, the first stream on a tie
+    std::vector<size_t> next(streams_.size(), 0);
+    std::vector<char> data;
+    for (;;) {
+        size_t stream = streams_.size();
+        for (size_t i = 0; i < streams_.size(); i++) {
+            if (next[i] == streams_[i].samples.size()) continue;
+            if (stream == streams_.size() ||
+                streams_[i].samples[next[i]].time < streams_[stream].samples[next[stream]].time) {
+                stream = i;
+            }
+        }
+        if (stream == streams_.size()) break;
+
+        const base::samples::Sonar& sample = streams_[stream].samples[next[stream]++];
+        SonarView::marshal(sample, data);
+        append_sample(log, stream + 1, sample.time, &data[0], data.size());
+
+        int32_t other = 42;
+        append_sample(log, 0, sample.time, reinterpret_cast<const char*>(&other), sizeof(other));
+    }
+
+    std::ofstream file(filename.c_str(), std::ios::binary);
+    file.write(log.data(), log.size());
+    return file.good();
+}
+
+std::string SyntheticLog::sonar_registry() {
+    return "<?xml version=\"1.0\"?>\n"
+           "<typelib>\n"
+           "  <compound name=\"/base/Angle\" size=\"8\" >\n"
+           "    <field name=\"rad\" type=\"/double\" offset=\"0\" />\n"
+           "  </compound>\n"
+           "  <compound name=\"/base/Time\" size=\"8\" >\n"
+           "    <field name=\"microseconds\" type=\"/int64_t\" offset=\"0\" />\n"
+           "  </compound>\n"
+           "  <compound name=\"/base/samples/Sonar\" size=\"120\" >\n"
+           "    <field name=\"time\" type=\"/base/Time\" offset=\"0\" />\n"
+           "    <field name=\"timestamps\" type=\"/std/vector&lt;/base/Time&gt;\" offset=\"8\" />\n"
+           "    <field name=\"bin_duration\" type=\"/base/Time\" offset=\"32\" />\n"
+           "    <field name=\"beam_width\" type=\"/base/Angle\" offset=\"40\" />\n"
+           "    <field name=\"beam_height\" type=\"/base/Angle\" offset=\"48\" />\n"
+           "    <field name=\"bearings\" type=\"/std/vector&lt;/base/Angle&gt;\" offset=\"56\" />\n"
+           "    <field name=\"speed_of_sound\" type=\"/float\" offset=\"80\" />\n"
+           "    <field name=\"bin_count\" type=\"/uint32_t\" offset=\"84\" />\n"
+           "    <field name=\"beam_count\" type=\"/uint32_t\" offset=\"88\" />\n"
+           "    <field name=\"bins\" type=\"/std/vector&lt;/float&gt;\" offset=\"96\" />\n"
+           "  </compound>\n"
+           "  <container name=\"/std/vector&lt;/base/Angle&gt;\" of=\"/base/Angle\" size=\"24\" kind=\"/std/vector\" />\n"
+           "  <container name=\"/std/vector&lt;/base/Time&gt;\" of=\"/base/Time\" size=\"24\" kind=\"/std/vector\" />\n"
+           "  <container name=\"/std/vector&lt;/float&gt;\" of=\"/float\" size=\"24\" kind=\"/std/vector\" />\n"
+           "  <numeric name=\"/double\" category=\"float\" size=\"8\" />\n"
+           "  <numeric name=\"/float\" category=\"float\" size=\"4\" />\n"
+           "  <numeric name=\"/int32_t\" category=\"sint\" size=\"4\" />\n"
+           "  <numeric name=\"/int64_t\" category=\"sint\" size=\"8\" />\n"
+           "  <numeric name=\"/uint32_t\" category=\"uint\" size=\"4\" />\n"
+           "</typelib>\n";
+}
+
+} /* namespace sonarlog_obstacle_detection */
@@ -0,0 +1,49 @@
+#ifndef SyntheticLog_hpp
+#define SyntheticLog_hpp
+
+#include <string>
+#include <vector>
+#include <base/samples/Sonar.hpp>
+
+namespace sonarlog_obstacle_detection {
+
+/*
+ * Writer of small uncompressed pocolog files for tests and benchmarks.
+ *
+ * Every stream is declared with its typelib registry (the one of
+ * base::samples::Sonar by default) and its samples are written in time
+ * order across the streams, with their time in the block headers. An
+ * int32 stream is declared first and gets a sample after every sonar
+ * sample, so the readers have to skip the blocks of other streams.
+ */
+class SyntheticLog {
+public:
+
+    /* adds a stream of samples, in time order */
+    void add_stream(const std::string& name, const std::vector<base::samples::Sonar>& samples,
+                    const std::string& registry = sonar_registry());
+
+    /* writes the log, returns false if the file cannot be written */
+    bool write(const std::string& filename) const;
+
+    size_t stream_count() const {
+        return streams_.size();
+    }
+
+    /* the typelib registry of a Sonar stream, with the declaration of base/samples/Sonar.hpp */
+    static std::string sonar_registry();
+
+private:
+
+    struct Stream {
+        std::string name;
+        std::string registry;
+        std::vector<base::samples::Sonar> samples;
+    };
+
+    std::vector<Stream> streams_;
+};
+
+} /* namespace sonarlog_obstacle_detection */
+
+#endif /* SyntheticLog_hpp */
@@ -0,0 +1,107 @@
+#include <cmath>
+#include "sonarlog_obstacle_detection/SyntheticSonar.hpp"
+
+namespace sonarlog_obstacle_detection {
+
+SyntheticSonarConfig SyntheticSonarConfig::multibeam() {
+    SyntheticSonarConfig config;
+    config.bin_count = 500;
+    config.beam_count = 256;
+    config.range = 50;
+    config.field_of_view = base::Angle::fromDeg(130);
+    config.beam_width = base::Angle::fromDeg(0.5);
+    config.ping_period = base::Time::fromMilliseconds(100);
+    return config;
+}
+
+SyntheticSonarConfig SyntheticSonarConfig::scanning() {
+    SyntheticSonarConfig config;
+    config.bin_count = 400;
+    config.beam_count = 1;
+    config.range = 20;
+    config.beam_width = base::Angle::fromDeg(3);
+    config.scan_limit = base::Angle::fromDeg(45);
+    config.scan_step = base::Angle::fromDeg(1.8);
+    config.ping_period = base::Time::fromMilliseconds(40);
+    config.target_range = 5;
+    config.target_bearing = base::Angle::fromDeg(10);
+    config.target_radius = 0.5;
+    return config;
+}
+
+SyntheticSonar::SyntheticSonar(const SyntheticSonarConfig& config)
+    : config_(config) {
+    reset();
+}
+
+void SyntheticSonar::reset() {
+    state_ = config_.seed ? config_.seed : 1;
+    ping_ = 0;
+    bearing_ = -config_.scan_limit.getRad();
+    direction_ = 1;
+}
+
+float SyntheticSonar::random() {
+    // xorshift32
+    state_ ^= state_ << 13;
+    state_ ^= state_ >> 17;
+    state_ ^= state_ << 5;
+    return (state_ >> 8) / 16777216.0f;
+}
+
+void SyntheticSonar::next(base::samples::Sonar& sample) {
+    const double speed_of_sound = 1500;
+    const uint32_t bin_count = config_.bin_count;
+    const uint32_t beam_count = config_.beam_count;
+
+    sample.time = base::Time::fromMicroseconds(ping_ * config_.ping_period.toMicroseconds());
+    sample.bin_duration = base::Time::fromSeconds(2 * config_.range / (bin_count * speed_of_sound));
+    sample.beam_width = config_.beam_width;
+    sample.beam_height = base::Angle::fromDeg(20);
+    sample.speed_of_sound = speed_of_sound;
+    sample.bin_count = bin_count;
+    sample.beam_count = beam_count;
+
+    sample.bearings.resize(beam_count);
+    if (beam_count == 1) {
+        sample.bearings[0] = base::Angle::fromRad(bearing_);
+
+        double limit = config_.scan_limit.getRad();
+        bearing_ += direction_ * config_.scan_step.getRad();
+        if (bearing_ > limit || bearing_ < -limit) {
+            direction_ = -direction_;
+            bearing_ += 2 * direction_ * config_.scan_step.getRad();
+        }
+    }
+    else {
+        double fov = config_.field_of_view.getRad();
+        for (uint32_t beam = 0; beam < beam_count; beam++) {
+            sample.bearings[beam] = base::Angle::fromRad(fov / 2 - fov * beam / (beam_count - 1));
+        }
+    }
+
+    const double resolution = config_.range / bin_count;
+    const double tx = config_.target_range * cos(config_.target_bearing.getRad());
+    const double ty = config_.target_range * sin(config_.target_bearing.getRad());
+    const double radius2 = config_.target_radius * config_.target_radius;
+
+    sample.bins.resize(bin_count * beam_count);
+    for (uint32_t beam = 0; beam < beam_count; beam++) {
+        double bearing = sample.bearings[beam].getRad();
+        double c = cos(bearing), s = sin(bearing);
+        float *bins = &sample.bins[beam * bin_count];
+
+        for (uint32_t bin = 0; bin < bin_count; bin++) {
+            double r = bin * resolution;
+            double dx = r * c - tx, dy = r * s - ty;
+
+            float value = (random() < config_.speckle_density) ? random() * config_.speckle_level : 0;
+            if (dx * dx + dy * dy <= radius2) value = config_.target_level;
+            bins[bin] = value;
+        }
+    }
+
+    ping_++;
+}
+
+} /* namespace sonarlog_obstacle_detection */
@@ -0,0 +1,103 @@
+#ifndef SyntheticSonar_hpp
+#define SyntheticSonar_hpp
+
+#include <stdint.h>
+#include <base/Angle.hpp>
+#include <base/Time.hpp>
+#include <base/samples/Sonar.hpp>
+
+namespace sonarlog_obstacle_detection {
+
+struct SyntheticSonarConfig {
+    SyntheticSonarConfig()
+        : bin_count(500)
+        , beam_count(256)
+        , range(50)
+        , field_of_view(base::Angle::fromDeg(130))
+        , beam_width(base::Angle::fromDeg(0.5))
+        , scan_limit(base::Angle::fromDeg(45))
+        , scan_step(base::Angle::fromDeg(1.8))
+        , ping_period(base::Time::fromMilliseconds(100))
+        , speckle_density(0.05)
+        , speckle_level(0.3)
+        , target_range(15)
+        , target_bearing(base::Angle::fromDeg(10))
+        , target_radius(1)
+        , target_level(0.9)
+        , seed(1) {
+    }
+
+    /* a Gemini-like multibeam imager */
+    static SyntheticSonarConfig multibeam();
+
+    /* a Micron-like mechanically scanned sonar (one beam per ping) */
+    static SyntheticSonarConfig scanning();
+
+    uint32_t bin_count;
+    uint32_t beam_count;
+
+    // maximum range in meters
+    double range;
+
+    // sector covered by the beams of a multibeam ping
+    base::Angle field_of_view;
+    base::Angle beam_width;
+
+    // single beam sonars sweep between -scan_limit and scan_limit
+    base::Angle scan_limit;
+    base::Angle scan_step;
+
+    base::Time ping_period;
+
+    // fraction of bins with random noise and its maximum intensity
+    float speckle_density;
+    float speckle_level;
+
+    // a disc planted in the scene
+    double target_range;
+    base::Angle target_bearing;
+    double target_radius;
+    float target_level;
+
+    uint32_t seed;
+};
+
+/*
+ * Deterministic generator of sonar samples for benchmarks and tests.
+ *
+ * Every ping carries uniform speckle on a fraction of the bins plus the
+ * echo of a disc at a fixed position. The same config always produces the
+ * same sequence of samples.
+ */
+class SyntheticSonar {
+public:
+
+    SyntheticSonar(const SyntheticSonarConfig& config = SyntheticSonarConfig());
+
+    /* writes the next ping into sample, reusing its storage */
+    void next(base::samples::Sonar& sample);
+
+    void reset();
+
+    const SyntheticSonarConfig& config() const {
+        return config_;
+    }
+
+    size_t pings() const {
+        return ping_;
+    }
+
+private:
+
+    float random();
+
+    SyntheticSonarConfig config_;
+    uint32_t state_;
+    size_t ping_;
+    double bearing_;
+    double direction_;
+};
+
+} /* namespace sonarlog_obstacle_detection */
+
+#endif /* SyntheticSonar_hpp */
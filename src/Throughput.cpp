@@ -0,0 +1,27 @@
+#include <iomanip>
+#include "sonarlog_obstacle_detection/Throughput.hpp"
+
+namespace sonarlog_obstacle_detection {
+
+double Throughput::pings_per_second() const {
+    double seconds = elapsed_seconds();
+    return (seconds > 0) ? pings_ / seconds : 0;
+}
+
+double Throughput::megabytes_per_second() const {
+    double seconds = elapsed_seconds();
+    return (seconds > 0) ? (bytes_ / (1024.0 * 1024.0)) / seconds : 0;
+}
+
+std::ostream& operator<<(std::ostream& out, const Throughput& throughput) {
+    std::ios::fmtflags flags = out.flags();
+    out << std::fixed << std::setprecision(2)
+        << throughput.pings() << " pings in "
+        << throughput.elapsed_seconds() << "s ("
+        << throughput.pings_per_second() << " pings/s, "
+        << throughput.megabytes_per_second() << " MB/s)";
+    out.flags(flags);
+    return out;
+}
+
+} /* namespace sonarlog_obstacle_detection */
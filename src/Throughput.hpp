@@ -0,0 +1,69 @@
+#ifndef Throughput_hpp
+#define Throughput_hpp
+
+#include <iostream>
+#include <string>
+#include <base/Time.hpp>
+#include <base/samples/Sonar.hpp>
+#include "sonarlog_obstacle_detection/MappedLog.hpp"
+
+namespace sonarlog_obstacle_detection {
+
+class Throughput {
+public:
+
+    Throughput()
+        : pings_(0)
+        , bytes_(0) {
+    }
+
+    void start() {
+        pings_ = 0;
+        bytes_ = 0;
+        start_time_ = base::Time::now();
+        elapsed_ = base::Time();
+    }
+
+    void stop() {
+        elapsed_ = base::Time::now() - start_time_;
+    }
+
+    void add(const base::samples::Sonar& sample) {
+        pings_++;
+        bytes_ += sample.bins.size() * sizeof(float) + sample.bearings.size() * sizeof(base::Angle);
+    }
+
+    void add(const SonarView& view) {
+        pings_++;
+        bytes_ += (size_t)view.bin_count * view.beam_count * sizeof(float) + view.beam_count * sizeof(base::Angle);
+    }
+
+    size_t pings() const {
+        return pings_;
+    }
+
+    size_t bytes() const {
+        return bytes_;
+    }
+
+    double elapsed_seconds() const {
+        return elapsed_.toSeconds();
+    }
+
+    double pings_per_second() const;
+
+    double megabytes_per_second() const;
+
+private:
+
+    size_t pings_;
+    size_t bytes_;
+    base::Time start_time_;
+    base::Time elapsed_;
+};
+
+std::ostream& operator<<(std::ostream& out, const Throughput& throughput);
+
+} /* namespace sonarlog_obstacle_detection */
+
+#endif /* Throughput_hpp */
@@ -1,6 +1,8 @@
 #include <iostream>
+#include <stdexcept>
 #include "sonarlog_obstacle_detection/ArgumentParser.hpp"
 #include "sonarlog_obstacle_detection/Application.hpp"
+#include "sonarlog_obstacle_detection/ParameterSweep.hpp"
 
 using namespace sonarlog_obstacle_detection;
 
@@ -11,11 +13,48 @@ int main(int argc, char const *argv[]) {
         std::cout << "Sonar's log processing" << std::endl;
         for (size_t i = 0; i < argument_parser.input_files().size(); i++) {
             std::cout << "intput-file: " << argument_parser.input_files()[i]  << std::endl;
-            std::cout << "stream-name: " << argument_parser.stream_name() << "\n" << std::endl;
-            Application::instance()->init(argument_parser.input_files()[i], argument_parser.stream_name());
-            Application::instance()->process_logfile();
+        }
+        for (size_t i = 0; i < argument_parser.stream_names().size(); i++) {
+            std::cout << "stream-name: " << argument_parser.stream_names()[i] << std::endl;
+        }
+        std::cout << std::endl;
+
+        ProcessingOptions options;
+        options.headless = argument_parser.headless();
+        options.queue_size = argument_parser.queue_size();
+        options.mmap = argument_parser.mmap();
+        options.denoise = argument_parser.denoise();
+        options.denoise_window = argument_parser.denoise_window();
+        options.metrics_format = argument_parser.metrics_format();
+        options.metrics_interval = argument_parser.metrics_interval();
+        options.first_index = argument_parser.first_index();
+        options.last_index = argument_parser.last_index();
+        options.from_time = argument_parser.from_time();
+        options.to_time = argument_parser.to_time();
+        options.sweep = argument_parser.sweep();
+        options.sweep_jobs = argument_parser.sweep_jobs();
+        options.sweep_output = argument_parser.sweep_output();
+        options.latency_budget = argument_parser.latency_budget();
+        options.realtime_policy = argument_parser.realtime_policy();
+        options.pixel_cost = argument_parser.pixel_cost();
+        options.detections_output = argument_parser.detections_output();
+        options.detections_format = argument_parser.detections_format();
+        options.plot_every = argument_parser.plot_every();
+        options.plot_rate = argument_parser.plot_rate();
+
+        if (!options.sweep.empty()) {
+            try {
+                std::cout << "sweep: " << ParameterSweep::parse(options.sweep).size() << " configurations\n" << std::endl;
+            } catch (std::invalid_argument& e) {
+                std::cerr << "ERROR: " << e.what() << std::endl;
+                return 1;
+            }
         }
 
+        Application::instance()->set_options(options);
+        Application::instance()->set_jobs(argument_parser.jobs());
+        Application::instance()->init(argument_parser.input_files(), argument_parser.stream_names());
+        Application::instance()->process_logfiles();
     }
 
     return 0;
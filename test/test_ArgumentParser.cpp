@@ -37,3 +37,215 @@ BOOST_AUTO_TEST_CASE(input_file_is_existent)
     ArgumentParser argument_parser;
     BOOST_CHECK_MESSAGE(argument_parser.run(argc, argv) == true, "Return false if the input-file is existent");
 }
+
+BOOST_AUTO_TEST_CASE(headless_flag)
+{
+    char input_file_arg[256];
+    int n = snprintf(input_file_arg, 256, "--input-file=%s/logs/gemini-ferry.0.log", DATA_PATH);
+
+    BOOST_ASSERT(n >= 0 && n < 256);
+
+    int argc = 4;
+    char const *argv[4] = {
+        "sonarlog_obstacle_detection",
+        input_file_arg,
+        "--stream-name=gemini.sonar_samples",
+        "--headless"
+    };
+
+    ArgumentParser argument_parser;
+    BOOST_CHECK(argument_parser.run(argc, argv) == true);
+    BOOST_CHECK_MESSAGE(argument_parser.headless() == true, "Return true if --headless is given");
+}
+
+BOOST_AUTO_TEST_CASE(jobs_option)
+{
+    char input_file_arg[256];
+    int n = snprintf(input_file_arg, 256, "--input-file=%s/logs/gemini-ferry.0.log", DATA_PATH);
+
+    BOOST_ASSERT(n >= 0 && n < 256);
+
+    int argc = 4;
+    char const *argv[4] = {
+        "sonarlog_obstacle_detection",
+        input_file_arg,
+        "--stream-name=gemini.sonar_samples",
+        "--jobs=4"
+    };
+
+    ArgumentParser argument_parser;
+    BOOST_CHECK(argument_parser.run(argc, argv) == true);
+    BOOST_CHECK_EQUAL(argument_parser.jobs(), 4);
+}
+
+BOOST_AUTO_TEST_CASE(metrics_option)
+{
+    char input_file_arg[256];
+    int n = snprintf(input_file_arg, 256, "--input-file=%s/logs/gemini-ferry.0.log", DATA_PATH);
+
+    BOOST_ASSERT(n >= 0 && n < 256);
+
+    int argc = 5;
+    char const *argv[5] = {
+        "sonarlog_obstacle_detection",
+        input_file_arg,
+        "--stream-name=gemini.sonar_samples",
+        "--metrics=json",
+        "--metrics-interval=2.5"
+    };
+
+    ArgumentParser argument_parser;
+    BOOST_CHECK(argument_parser.run(argc, argv) == true);
+    BOOST_CHECK_EQUAL(argument_parser.metrics_format(), "json");
+    BOOST_CHECK_CLOSE(argument_parser.metrics_interval(), 2.5, 1e-9);
+
+    char const *invalid_argv[4] = {
+        "sonarlog_obstacle_detection",
+        input_file_arg,
+        "--stream-name=gemini.sonar_samples",
+        "--metrics=xml"
+    };
+
+    ArgumentParser invalid_parser;
+    BOOST_CHECK(invalid_parser.run(4, invalid_argv) == false);
+}
+
+BOOST_AUTO_TEST_CASE(sample_window_options)
+{
+    char input_file_arg[256];
+    int n = snprintf(input_file_arg, 256, "--input-file=%s/logs/gemini-ferry.0.log", DATA_PATH);
+
+    BOOST_ASSERT(n >= 0 && n < 256);
+
+    int argc = 7;
+    char const *argv[7] = {
+        "sonarlog_obstacle_detection",
+        input_file_arg,
+        "--stream-name=gemini.sonar_samples",
+        "--first-index=100",
+        "--last-index=200",
+        "--from-time=1.5",
+        "--to-time=30"
+    };
+
+    ArgumentParser argument_parser;
+    BOOST_CHECK(argument_parser.run(argc, argv) == true);
+    BOOST_CHECK_EQUAL(argument_parser.first_index(), 100);
+    BOOST_CHECK_EQUAL(argument_parser.last_index(), 200);
+    BOOST_CHECK_CLOSE(argument_parser.from_time(), 1.5, 1e-9);
+    BOOST_CHECK_CLOSE(argument_parser.to_time(), 30.0, 1e-9);
+
+    char const *empty_argv[5] = {
+        "sonarlog_obstacle_detection",
+        input_file_arg,
+        "--stream-name=gemini.sonar_samples",
+        "--first-index=200",
+        "--last-index=100"
+    };
+
+    ArgumentParser empty_parser;
+    BOOST_CHECK(empty_parser.run(5, empty_argv) == false);
+}
+
+BOOST_AUTO_TEST_CASE(sweep_options)
+{
+    char input_file_arg[256];
+    int n = snprintf(input_file_arg, 256, "--input-file=%s/logs/gemini-ferry.0.log", DATA_PATH);
+
+    BOOST_ASSERT(n >= 0 && n < 256);
+
+    int argc = 6;
+    char const *argv[6] = {
+        "sonarlog_obstacle_detection",
+        input_file_arg,
+        "--stream-name=gemini.sonar_samples",
+        "--sweep=threshold=0.05:0.2:0.05;morph_size=3,5",
+        "--sweep-jobs=4",
+        "--sweep-output=/tmp"
+    };
+
+    ArgumentParser argument_parser;
+    BOOST_CHECK(argument_parser.run(argc, argv) == true);
+    BOOST_CHECK_EQUAL(argument_parser.sweep(), "threshold=0.05:0.2:0.05;morph_size=3,5");
+    BOOST_CHECK_EQUAL(argument_parser.sweep_jobs(), 4);
+    BOOST_CHECK_EQUAL(argument_parser.sweep_output(), "/tmp");
+}
+
+BOOST_AUTO_TEST_CASE(multiple_stream_names)
+{
+    char input_file_arg[256];
+    int n = snprintf(input_file_arg, 256, "--input-file=%s/logs/gemini-ferry.0.log", DATA_PATH);
+
+    BOOST_ASSERT(n >= 0 && n < 256);
+
+    int argc = 6;
+    char const *argv[6] = {
+        "sonarlog_obstacle_detection",
+        input_file_arg,
+        "--stream-name",
+        "gemini.sonar_samples",
+        "micron_front.sonar_samples",
+        "--detections=/tmp"
+    };
+
+    ArgumentParser argument_parser;
+    BOOST_CHECK(argument_parser.run(argc, argv) == true);
+    BOOST_REQUIRE_EQUAL(argument_parser.stream_names().size(), 2);
+    BOOST_CHECK_EQUAL(argument_parser.stream_names()[1], "micron_front.sonar_samples");
+    BOOST_CHECK_EQUAL(argument_parser.stream_name(), "gemini.sonar_samples");
+    BOOST_CHECK_EQUAL(argument_parser.detections_output(), "/tmp");
+
+    char const *default_argv[2] = {
+        "sonarlog_obstacle_detection",
+        input_file_arg
+    };
+
+    ArgumentParser default_parser;
+    BOOST_CHECK(default_parser.run(2, default_argv) == true);
+    BOOST_CHECK_EQUAL(default_parser.stream_names().size(), 1);
+    BOOST_CHECK_EQUAL(default_parser.stream_name(), "sonar.sonar_scan_samples");
+}
+
+BOOST_AUTO_TEST_CASE(plot_options)
+{
+    char input_file_arg[256];
+    int n = snprintf(input_file_arg, 256, "--input-file=%s/logs/gemini-ferry.0.log", DATA_PATH);
+
+    BOOST_ASSERT(n >= 0 && n < 256);
+
+    int argc = 4;
+    char const *argv[4] = {
+        "sonarlog_obstacle_detection",
+        input_file_arg,
+        "--plot-every=5",
+        "--plot-rate=2.5"
+    };
+
+    ArgumentParser argument_parser;
+    BOOST_CHECK(argument_parser.run(argc, argv) == true);
+    BOOST_CHECK_EQUAL(argument_parser.plot_every(), 5);
+    BOOST_CHECK_EQUAL(argument_parser.plot_rate(), 2.5);
+}
+
+BOOST_AUTO_TEST_CASE(detections_format)
+{
+    char input_file_arg[256];
+    int n = snprintf(input_file_arg, 256, "--input-file=%s/logs/gemini-ferry.0.log", DATA_PATH);
+
+    BOOST_ASSERT(n >= 0 && n < 256);
+
+    char const *argv[4] = {
+        "sonarlog_obstacle_detection",
+        input_file_arg,
+        "--detections=/tmp",
+        "--detections-format=binary"
+    };
+
+    ArgumentParser argument_parser;
+    BOOST_CHECK(argument_parser.run(4, argv) == true);
+    BOOST_CHECK_EQUAL(argument_parser.detections_format(), "binary");
+
+    argv[3] = "--detections-format=xml";
+    ArgumentParser invalid_parser;
+    BOOST_CHECK_MESSAGE(invalid_parser.run(4, argv) == false, "Return false for an unknown detections format");
+}
@@ -0,0 +1,126 @@
+#define BOOST_TEST_MODULE test_BitMask
+#include <boost/test/unit_test.hpp>
+#include <cstdlib>
+#include <opencv2/opencv.hpp>
+
+#include "sonarlog_obstacle_detection/BitMask.hpp"
+
+using namespace sonarlog_obstacle_detection;
+
+namespace {
+
+cv::Mat random_image(int rows, int cols, int density) {
+    cv::Mat image(rows, cols, CV_32FC1);
+    for (int y = 0; y < rows; y++) {
+        for (int x = 0; x < cols; x++) {
+            image.at<float>(y, x) = (rand() % 100 < density) ? (rand() % 1000) / 1000.0f : 0.0f;
+        }
+    }
+    return image;
+}
+
+bool equal(const BitMask& mask, const cv::Mat& expected) {
+    cv::Mat actual;
+    mask.copy_to(actual);
+    return cv::norm(actual, expected, cv::NORM_INF) == 0;
+}
+
+/* count and bounding box of the mask against countNonZero and boundingRect(findNonZero) */
+void check_limits(const BitMask& mask, const cv::Mat& expected) {
+    BOOST_CHECK_EQUAL(mask.count(), (size_t)cv::countNonZero(expected));
+
+    cv::Mat expected_8u;
+    expected.convertTo(expected_8u, CV_8U);
+    cv::Rect bbox;
+    if (cv::countNonZero(expected_8u)) {
+        std::vector<cv::Point> points;
+        cv::findNonZero(expected_8u, points);
+        bbox = cv::boundingRect(points);
+    }
+    BOOST_CHECK(mask.bounding_box() == bbox);
+}
+
+}
+
+BOOST_AUTO_TEST_CASE(matches_opencv)
+{
+    const int sizes[][2] = { {1, 1}, {7, 63}, {9, 64}, {13, 65}, {40, 200}, {31, 129}, {400, 800} };
+    const int shapes[] = { cv::MORPH_ELLIPSE, cv::MORPH_RECT, cv::MORPH_CROSS };
+
+    srand(3);
+    for (size_t s = 0; s < sizeof(sizes) / sizeof(sizes[0]); s++) {
+        for (int density = 10; density <= 90; density += 40) {
+            cv::Mat src = random_image(sizes[s][0], sizes[s][1], density);
+
+            cv::Mat thresh;
+            cv::threshold(src, thresh, 0.1, 1.0, CV_THRESH_BINARY);
+
+            BitMask mask;
+            mask.threshold(src, 0.1f);
+            BOOST_REQUIRE(equal(mask, thresh));
+            check_limits(mask, thresh);
+
+            // the rows out of a range stay clear
+            BitMask rows;
+            rows.threshold(src, 0.1f, src.rows / 4, src.rows / 2);
+            cv::Mat banded = thresh.clone();
+            banded.rowRange(0, src.rows / 4).setTo(0);
+            banded.rowRange(src.rows / 2, src.rows).setTo(0);
+            BOOST_CHECK(equal(rows, banded));
+            check_limits(rows, banded);
+
+            for (size_t k = 0; k < sizeof(shapes) / sizeof(shapes[0]); k++) {
+                cv::Mat element = cv::getStructuringElement(shapes[k], cv::Size(5, 5));
+                BitMask::Kernel kernel = BitMask::kernel(element);
+
+                cv::Mat eroded, dilated, opened;
+                cv::erode(thresh, eroded, element);
+                cv::dilate(thresh, dilated, element);
+                cv::morphologyEx(thresh, opened, cv::MORPH_OPEN, element, cv::Point(-1, -1), 2);
+
+                BitMask bits_eroded, bits_dilated, bits_opened, work;
+                BitMask::erode(mask, bits_eroded, kernel);
+                BitMask::dilate(mask, bits_dilated, kernel);
+                BitMask::open(mask, bits_opened, kernel, 2, work);
+
+                BOOST_CHECK(equal(bits_eroded, eroded));
+                BOOST_CHECK(equal(bits_dilated, dilated));
+                BOOST_CHECK(equal(bits_opened, opened));
+                check_limits(bits_opened, opened);
+            }
+        }
+    }
+}
+
+BOOST_AUTO_TEST_CASE(copy_region)
+{
+    BitMask mask(3, 130);
+    mask.set(1, 0, true);
+    mask.set(1, 128, true);
+    BOOST_CHECK(mask.get(1, 128));
+    BOOST_CHECK(!mask.get(1, 127));
+    BOOST_CHECK_EQUAL(mask.count(), 2);
+    BOOST_CHECK(mask.bounding_box() == cv::Rect(0, 1, 129, 1));
+
+    // a region pasted across a word boundary, the rest of the destination unchanged
+    BitMask pasted(2, 70);
+    pasted.set(0, 0, true);
+    mask.copy_to(pasted, cv::Rect(127, 1, 2, 1), cv::Point(63, 1));
+    BOOST_CHECK_EQUAL(pasted.count(), 2);
+    BOOST_CHECK(pasted.get(0, 0));
+    BOOST_CHECK(!pasted.get(1, 63));
+    BOOST_CHECK(pasted.get(1, 64));
+    BOOST_CHECK(pasted.bounding_box() == cv::Rect(0, 0, 65, 2));
+
+    cv::Mat dst = cv::Mat::zeros(1, 2, CV_8UC1);
+    mask.copy_to(dst, cv::Rect(127, 1, 2, 1), 255);
+    BOOST_CHECK_EQUAL(dst.at<uchar>(0, 0), 0);
+    BOOST_CHECK_EQUAL(dst.at<uchar>(0, 1), 255);
+
+    mask.set(1, 0, false);
+    mask.set(1, 128, false);
+    BOOST_CHECK(!mask.get(1, 0));
+    BOOST_CHECK(!mask.get(1, 128));
+    BOOST_CHECK_EQUAL(mask.count(), 0);
+    BOOST_CHECK(mask.bounding_box() == cv::Rect());
+}
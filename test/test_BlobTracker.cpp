@@ -0,0 +1,105 @@
+#define BOOST_TEST_MODULE test_BlobTracker
+#include <boost/test/unit_test.hpp>
+
+#include "sonarlog_obstacle_detection/BlobTracker.hpp"
+
+using namespace sonarlog_obstacle_detection;
+
+namespace {
+
+cv::Mat frame_with(const cv::Rect& blob) {
+    cv::Mat binary = cv::Mat::zeros(400, 800, CV_32FC1);
+    binary(blob).setTo(1);
+    return binary;
+}
+
+}
+
+BOOST_AUTO_TEST_CASE(matches_target_distance)
+{
+    cv::Rect blob(300, 200, 40, 30);
+    cv::Mat binary = frame_with(blob);
+
+    BlobTracker tracker;
+    detection::Target target = tracker.update(binary, 20);
+
+    // findBiggestBlob draws the blob in color for getTargetDistance
+    cv::Mat gray, drawn;
+    binary.convertTo(gray, CV_8U, 255);
+    cv::cvtColor(gray, drawn, CV_GRAY2BGR);
+    detection::Target expected = detection::getTargetDistance(drawn, 20);
+
+    BOOST_CHECK(target.valid);
+    BOOST_CHECK(tracker.tracking());
+    BOOST_CHECK(target.bbox == blob);
+    BOOST_CHECK(target.closest == expected.closest);
+    BOOST_CHECK_CLOSE(target.position.x(), expected.position.x(), 1e-6);
+    BOOST_CHECK_CLOSE(target.position.y(), expected.position.y(), 1e-6);
+}
+
+BOOST_AUTO_TEST_CASE(min_area)
+{
+    BlobTracker tracker;
+    BOOST_CHECK(!tracker.update(frame_with(cv::Rect(10, 10, 9, 9)), 20).valid);
+    BOOST_CHECK(!tracker.tracking());
+    BOOST_CHECK(tracker.update(frame_with(cv::Rect(10, 10, 10, 10)), 20).valid);
+}
+
+BOOST_AUTO_TEST_CASE(gated_search)
+{
+    BlobTracker tracker;
+    cv::Rect blob(100, 100, 30, 20);
+    tracker.update(frame_with(blob), 20);
+    BOOST_CHECK_EQUAL(tracker.full_searches(), 1);
+
+    // a target moving 5 px per ping stays inside the predicted window
+    for (int i = 1; i <= 20; i++) {
+        cv::Rect moved = blob + cv::Point(5 * i, 2 * i);
+        cv::Mat binary = frame_with(moved);
+
+        // a bigger blob outside the window does not take over the track
+        binary(cv::Rect(600, 300, 100, 80)).setTo(1);
+
+        const detection::Target& target = tracker.update(binary, 20);
+        BOOST_CHECK(target.valid);
+        BOOST_CHECK(target.bbox == moved);
+        BOOST_CHECK(tracker.window().area() < binary.rows * binary.cols / 10);
+    }
+    BOOST_CHECK_EQUAL(tracker.full_searches(), 1);
+}
+
+BOOST_AUTO_TEST_CASE(cut_by_window)
+{
+    BlobTracker tracker;
+    tracker.update(frame_with(cv::Rect(100, 100, 30, 20)), 20);
+
+    // the blob grows beyond the gate, the full frame gives its whole bbox
+    cv::Rect grown(100, 100, 200, 20);
+    const detection::Target& target = tracker.update(frame_with(grown), 20);
+    BOOST_CHECK(target.bbox == grown);
+    BOOST_CHECK_EQUAL(tracker.full_searches(), 2);
+}
+
+BOOST_AUTO_TEST_CASE(track_loss)
+{
+    BlobTrackerParameters parameters;
+    parameters.max_misses = 2;
+    BlobTracker tracker(parameters);
+    tracker.update(frame_with(cv::Rect(100, 100, 30, 20)), 20);
+
+    cv::Mat empty = cv::Mat::zeros(400, 800, CV_32FC1);
+    BOOST_CHECK(!tracker.update(empty, 20).valid);
+    BOOST_CHECK(tracker.tracking());
+    BOOST_CHECK(!tracker.update(empty, 20).valid);
+    BOOST_CHECK(tracker.tracking());
+    BOOST_CHECK_EQUAL(tracker.full_searches(), 1);
+
+    // the third miss drops the track after a full frame search
+    BOOST_CHECK(!tracker.update(empty, 20).valid);
+    BOOST_CHECK(!tracker.tracking());
+    BOOST_CHECK_EQUAL(tracker.full_searches(), 2);
+
+    // and a target anywhere is found again
+    cv::Rect blob(600, 50, 40, 40);
+    BOOST_CHECK(tracker.update(frame_with(blob), 20).bbox == blob);
+}
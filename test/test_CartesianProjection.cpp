@@ -0,0 +1,124 @@
+#define BOOST_TEST_MODULE test_CartesianProjection
+#include <boost/test/unit_test.hpp>
+#include <opencv2/opencv.hpp>
+
+#include "rock_util/Utilities.hpp"
+#include "sonar_processing/SonarHolder.hpp"
+#include "sonarlog_obstacle_detection/CartesianProjection.hpp"
+#include "sonarlog_obstacle_detection/SyntheticSonar.hpp"
+
+using namespace sonarlog_obstacle_detection;
+
+namespace {
+
+/* a multibeam ping with the given number of bins */
+base::samples::Sonar ping(uint32_t bin_count) {
+    SyntheticSonarConfig config = SyntheticSonarConfig::multibeam();
+    config.bin_count = bin_count;
+    base::samples::Sonar sample;
+    SyntheticSonar(config).next(sample);
+    return sample;
+}
+
+}
+
+BOOST_AUTO_TEST_CASE(cache_hits_and_misses)
+{
+    CartesianProjection projection(cv::Size(), 2);
+    base::samples::Sonar sample = ping(500);
+
+    const CartesianTable *table = &projection.lookup(sample);
+    const uint64_t key = table->key();
+    BOOST_CHECK_EQUAL(projection.misses(), 1);
+    BOOST_CHECK_EQUAL(projection.hits(), 0);
+    BOOST_CHECK(table->size() == CartesianTable::default_size(sample));
+
+    // the same geometry reuses the table, whatever the bins hold
+    for (size_t i = 0; i < 3; i++) {
+        sample.bins.assign(sample.bins.size(), i);
+        BOOST_CHECK(&projection.lookup(sample) == table);
+    }
+    BOOST_CHECK_EQUAL(projection.misses(), 1);
+    BOOST_CHECK_EQUAL(projection.hits(), 3);
+
+    // another range or another bearing is a new geometry
+    projection.lookup(ping(250));
+    BOOST_CHECK_EQUAL(projection.misses(), 2);
+
+    sample.bearings[0] = base::Angle::fromRad(sample.bearings[0].getRad() + 1e-6);
+    BOOST_CHECK(projection.lookup(sample).key() != key);
+    BOOST_CHECK_EQUAL(projection.misses(), 3);
+}
+
+BOOST_AUTO_TEST_CASE(least_recently_used_eviction)
+{
+    CartesianProjection projection(cv::Size(200, 100), 2);
+    base::samples::Sonar a = ping(500), b = ping(400), c = ping(300);
+
+    const CartesianTable *table_a = &projection.lookup(a);
+    const CartesianTable *table_b = &projection.lookup(b);
+    BOOST_CHECK_EQUAL(projection.misses(), 2);
+
+    // a is used again, so c evicts b and takes its storage
+    BOOST_CHECK(&projection.lookup(a) == table_a);
+    BOOST_CHECK(&projection.lookup(c) == table_b);
+    BOOST_CHECK_EQUAL(projection.misses(), 3);
+    BOOST_CHECK_EQUAL(projection.hits(), 1);
+
+    BOOST_CHECK(&projection.lookup(a) == table_a);
+    BOOST_CHECK_EQUAL(projection.hits(), 2);
+
+    // b is rebuilt in place of c, the least recently used one
+    BOOST_CHECK(&projection.lookup(b) == table_b);
+    BOOST_CHECK_EQUAL(projection.misses(), 4);
+    BOOST_CHECK(projection.table().matches(b, cv::Size(200, 100), CartesianTable::geometry_key(b, cv::Size(200, 100))));
+
+    // the table of a stays valid across the evictions
+    cv::Mat expected;
+    table_a->project(a.bins, expected);
+    BOOST_CHECK_EQUAL(cv::norm(projection.project(a), expected, cv::NORM_INF), 0);
+    BOOST_CHECK_EQUAL(projection.hits(), 3);
+}
+
+BOOST_AUTO_TEST_CASE(matches_sonar_holder)
+{
+    SyntheticSonarConfig config = SyntheticSonarConfig::multibeam();
+    config.speckle_density = 0.1;
+    SyntheticSonar generator(config);
+    base::samples::Sonar sample;
+
+    sonar_processing::SonarHolder sonar_holder;
+    std::auto_ptr<CartesianProjection> projection;
+
+    for (size_t i = 0; i < 5; i++) {
+        generator.next(sample);
+        sonar_holder.Reset(sample.bins,
+            rock_util::Utilities::get_radians(sample.bearings),
+            sample.beam_width.getRad(),
+            sample.bin_count,
+            sample.beam_count);
+
+        const cv::Mat& expected = sonar_holder.cart_image();
+        if (!projection.get()) projection.reset(new CartesianProjection(expected.size()));
+
+        const cv::Mat& actual = projection->project(sample);
+        BOOST_REQUIRE(actual.size() == expected.size());
+
+        // SonarHolder fills the polygon of every bin, the table samples the pixel centers, so
+        // a pixel on a beam or bin edge may show its neighbour: every pixel lies within the
+        // values of the 3x3 neighbourhood of the same pixel, and 95% of them are equal
+        cv::Mat lower, upper;
+        cv::erode(expected, lower, cv::Mat());
+        cv::dilate(expected, upper, cv::Mat());
+        cv::Mat below, above, differs;
+        cv::compare(actual, lower, below, cv::CMP_LT);
+        cv::compare(actual, upper, above, cv::CMP_GT);
+        cv::compare(actual, expected, differs, cv::CMP_NE);
+        BOOST_CHECK_EQUAL(cv::countNonZero(below), 0);
+        BOOST_CHECK_EQUAL(cv::countNonZero(above), 0);
+        BOOST_CHECK_LE(cv::countNonZero(differs), 0.05 * actual.total());
+    }
+
+    BOOST_CHECK_EQUAL(projection->misses(), 1);
+    BOOST_CHECK_EQUAL(projection->hits(), 4);
+}
@@ -0,0 +1,121 @@
+#define BOOST_TEST_MODULE test_DeadlineScheduler
+#include <boost/test/unit_test.hpp>
+
+#include "sonarlog_obstacle_detection/DeadlineScheduler.hpp"
+
+using namespace sonarlog_obstacle_detection;
+
+namespace {
+
+base::Time at(double seconds) {
+    return base::Time::fromSeconds(1000 + seconds);
+}
+
+}
+
+BOOST_AUTO_TEST_CASE(keeps_up)
+{
+    DeadlineScheduler scheduler(0.05, DeadlineScheduler::DROP);
+    for (int i = 0; i < 100; i++) {
+        BOOST_CHECK_EQUAL(scheduler.arrive(at(i * 0.04)), DeadlineScheduler::RUN);
+        scheduler.finish(0.03);
+    }
+
+    BOOST_CHECK_EQUAL(scheduler.stats().pings, 100);
+    BOOST_CHECK_EQUAL(scheduler.stats().dropped, 0);
+    BOOST_CHECK_EQUAL(scheduler.stats().missed, 0);
+    BOOST_CHECK_CLOSE(scheduler.stats().max_latency, 0.03, 1e-6);
+}
+
+BOOST_AUTO_TEST_CASE(drops_after_a_spike)
+{
+    DeadlineScheduler scheduler(0.05, DeadlineScheduler::DROP);
+
+    // a 200 ms spike on a 40 ms ping period
+    scheduler.arrive(at(0));
+    scheduler.finish(0.2);
+    BOOST_CHECK_EQUAL(scheduler.stats().missed, 1);
+
+    // pings starting more than 50 ms late are dropped, then it catches up
+    BOOST_CHECK_EQUAL(scheduler.arrive(at(0.04)), DeadlineScheduler::SKIP);
+    BOOST_CHECK_CLOSE(scheduler.lateness(), 0.16, 1e-6);
+    scheduler.finish(0.001);
+    BOOST_CHECK_EQUAL(scheduler.arrive(at(0.08)), DeadlineScheduler::SKIP);
+    scheduler.finish(0.001);
+    BOOST_CHECK_EQUAL(scheduler.arrive(at(0.12)), DeadlineScheduler::SKIP);
+    scheduler.finish(0.001);
+    BOOST_CHECK_EQUAL(scheduler.arrive(at(0.16)), DeadlineScheduler::RUN);
+    scheduler.finish(0.005);
+    BOOST_CHECK_EQUAL(scheduler.arrive(at(0.20)), DeadlineScheduler::RUN);
+
+    BOOST_CHECK_EQUAL(scheduler.stats().dropped, 3);
+    BOOST_CHECK_EQUAL(scheduler.stats().missed, 1);
+}
+
+BOOST_AUTO_TEST_CASE(degrades_before_dropping)
+{
+    DeadlineScheduler scheduler(0.05, DeadlineScheduler::DEGRADE);
+
+    scheduler.arrive(at(0));
+    scheduler.finish(0.11);
+
+    // 70 ms late: degraded
+    BOOST_CHECK_EQUAL(scheduler.arrive(at(0.04)), DeadlineScheduler::RUN_DEGRADED);
+    scheduler.finish(0.07);
+
+    // 140 ms late: dropped
+    BOOST_CHECK_EQUAL(scheduler.arrive(at(0.04)), DeadlineScheduler::SKIP);
+    scheduler.finish(0);
+
+    BOOST_CHECK_EQUAL(scheduler.stats().degraded, 1);
+    BOOST_CHECK_EQUAL(scheduler.stats().dropped, 1);
+}
+
+BOOST_AUTO_TEST_CASE(deterministic_replay)
+{
+    typedef DeadlineScheduler D;
+
+    // 40 ms ping period, 50 ms budget, two spikes; a degraded ping costs
+    // half and a dropped one 1 ms
+    const double costs[] = { 0.03, 0.15, 0.03, 0.03, 0.03, 0.03, 0.2, 0.03, 0.03, 0.03, 0.03, 0.03 };
+    const size_t count = sizeof(costs) / sizeof(costs[0]);
+
+    // lateness at the start of every ping, in ms:
+    //   drop:    0 0 110 71 32 22 12 172 133 94 55 16
+    //   degrade: 0 0 110 71 46 36 26 186 147 108 69 44
+    const D::Decision drop[] = { D::RUN, D::RUN, D::SKIP, D::SKIP, D::RUN, D::RUN,
+                                 D::RUN, D::SKIP, D::SKIP, D::SKIP, D::SKIP, D::RUN };
+    const D::Decision degrade[] = { D::RUN, D::RUN, D::SKIP, D::RUN_DEGRADED, D::RUN, D::RUN,
+                                    D::RUN, D::SKIP, D::SKIP, D::SKIP, D::RUN_DEGRADED, D::RUN };
+
+    for (int policy = 0; policy < 2; policy++) {
+        const D::Decision *expected = (policy) ? degrade : drop;
+
+        // a replay of the same times and costs gives the same decisions
+        for (int run = 0; run < 2; run++) {
+            DeadlineScheduler scheduler(0.05, (policy) ? D::DEGRADE : D::DROP);
+            for (size_t i = 0; i < count; i++) {
+                D::Decision decision = scheduler.arrive(at(i * 0.04));
+                BOOST_CHECK_EQUAL(decision, expected[i]);
+
+                double cost = costs[i];
+                if (decision == D::RUN_DEGRADED) cost *= 0.5;
+                if (decision == D::SKIP) cost = 0.001;
+                scheduler.finish(cost);
+            }
+
+            const D::Stats& stats = scheduler.stats();
+            BOOST_CHECK_EQUAL(stats.pings, count);
+            BOOST_CHECK_EQUAL(stats.degraded, (policy) ? 2 : 0);
+            BOOST_CHECK_EQUAL(stats.dropped, (policy) ? 4 : 6);
+            BOOST_CHECK_EQUAL(stats.missed, (policy) ? 7 : 4);
+            BOOST_CHECK_CLOSE(stats.max_latency, (policy) ? 0.226 : 0.212, 1e-3);
+        }
+    }
+
+    BOOST_CHECK_EQUAL(DeadlineScheduler().policy(), DeadlineScheduler::DROP);
+    DeadlineScheduler::Policy policy;
+    BOOST_CHECK(DeadlineScheduler::parse_policy("degrade", policy));
+    BOOST_CHECK_EQUAL(policy, DeadlineScheduler::DEGRADE);
+    BOOST_CHECK(!DeadlineScheduler::parse_policy("newest", policy));
+}
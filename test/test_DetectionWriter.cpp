@@ -0,0 +1,184 @@
+#define BOOST_TEST_MODULE test_DetectionWriter
+#include <boost/test/unit_test.hpp>
+#include <fstream>
+#include <iterator>
+#include <stdexcept>
+#include <string>
+#include <vector>
+#include <boost/filesystem.hpp>
+
+#include "sonarlog_obstacle_detection/DetectionReader.hpp"
+#include "sonarlog_obstacle_detection/DetectionWriter.hpp"
+
+using namespace sonarlog_obstacle_detection;
+
+namespace {
+
+std::string temp_path(const std::string& name) {
+    return (boost::filesystem::temp_directory_path() / ("test_DetectionWriter." + name)).string();
+}
+
+std::vector<std::string> stream_names() {
+    std::vector<std::string> streams;
+    streams.push_back("micron_front.sonar_samples");
+    streams.push_back("gemini.sonar_samples");
+    return streams;
+}
+
+detection::TimedTarget make_detection(size_t i) {
+    detection::TimedTarget detection;
+    detection.time = base::Time::fromMicroseconds(1000000 + i * 40000);
+    detection.stream = i % 2;
+    detection.ping = i;
+    detection.target.valid = true;
+    detection.target.bbox = cv::Rect(i % 100, 20, 30, 10 + i % 7);
+    detection.target.closest = cv::Point(i % 100 + 15, 30);
+    detection.target.position = base::Vector2d(0.25 * i, -0.5);
+    detection.target.area = 200 + i;
+    detection.target.confidence = 0.75f;
+    return detection;
+}
+
+std::vector<std::string> read_lines(const std::string& path) {
+    std::ifstream in(path.c_str());
+    std::vector<std::string> lines;
+    std::string line;
+    while (std::getline(in, line)) lines.push_back(line);
+    return lines;
+}
+
+}
+
+BOOST_AUTO_TEST_CASE(binary_roundtrip)
+{
+    const size_t count = 5000;
+    std::string path = temp_path("bin");
+
+    DetectionWriter writer(path, DetectionEncoder::BINARY, stream_names(), 8192);
+    for (size_t i = 0; i < count; i++) BOOST_REQUIRE(writer.push(make_detection(i)));
+    writer.close();
+    BOOST_CHECK_EQUAL(writer.written(), count);
+    BOOST_CHECK_EQUAL(writer.dropped(), 0);
+
+    DetectionReader reader(path);
+    BOOST_REQUIRE(reader.streams() == stream_names());
+
+    std::vector<DetectionRecord> records = reader.read_all();
+    BOOST_REQUIRE_EQUAL(records.size(), count);
+    for (size_t i = 0; i < count; i++) {
+        DetectionRecord expected = DetectionRecord::from(make_detection(i));
+        const DetectionRecord& record = records[i];
+        BOOST_CHECK_EQUAL(record.time, expected.time);
+        BOOST_CHECK_EQUAL(record.ping, i);
+        BOOST_CHECK_EQUAL(reader.stream_name(record), stream_names()[i % 2]);
+        BOOST_CHECK_EQUAL(record.x, expected.x);
+        BOOST_CHECK_EQUAL(record.height, expected.height);
+        BOOST_CHECK_EQUAL(record.closest_x, expected.closest_x);
+        BOOST_CHECK_EQUAL(record.position_x, expected.position_x);
+        BOOST_CHECK_EQUAL(record.position_y, expected.position_y);
+        BOOST_CHECK_EQUAL(record.area, expected.area);
+        BOOST_CHECK_EQUAL(record.confidence, expected.confidence);
+    }
+
+    boost::filesystem::remove(path);
+}
+
+BOOST_AUTO_TEST_CASE(text_formats)
+{
+    std::string csv = temp_path("csv");
+    std::string jsonl = temp_path("jsonl");
+    {
+        DetectionWriter csv_writer(csv, DetectionEncoder::CSV, stream_names());
+        DetectionWriter jsonl_writer(jsonl, DetectionEncoder::JSON_LINES, stream_names());
+        for (size_t i = 0; i < 3; i++) {
+            csv_writer.push(make_detection(i));
+            jsonl_writer.push(make_detection(i));
+        }
+    }
+
+    std::vector<std::string> lines = read_lines(csv);
+    BOOST_REQUIRE_EQUAL(lines.size(), 4);
+    BOOST_CHECK_EQUAL(lines[0], "time,stream,ping,x,y,width,height,closest_x,closest_y,position_x,position_y,area,confidence");
+    BOOST_CHECK_EQUAL(lines[2], "1040000,gemini.sonar_samples,1,1,20,30,11,16,30,0.250,-0.500,201,0.750");
+
+    lines = read_lines(jsonl);
+    BOOST_REQUIRE_EQUAL(lines.size(), 3);
+    BOOST_CHECK_EQUAL(lines[1], "{\"time\":1040000,\"stream\":\"gemini.sonar_samples\",\"ping\":1,"
+                                "\"bbox\":[1,20,30,11],\"closest\":[16,30],\"position\":[0.250,-0.500],"
+                                "\"area\":201,\"confidence\":0.750}");
+
+    // only the binary format has a reader
+    BOOST_CHECK_THROW(DetectionReader reader(csv), std::runtime_error);
+
+    boost::filesystem::remove(csv);
+    boost::filesystem::remove(jsonl);
+}
+
+BOOST_AUTO_TEST_CASE(damaged_header)
+{
+    std::string path = temp_path("header.bin");
+    {
+        DetectionWriter writer(path, DetectionEncoder::BINARY, stream_names());
+        writer.push(make_detection(0));
+    }
+
+    std::string bytes;
+    {
+        std::ifstream in(path.c_str(), std::ios::in | std::ios::binary);
+        bytes.assign(std::istreambuf_iterator<char>(in), std::istreambuf_iterator<char>());
+    }
+
+    // magic, version, record size, stream count, then the length of the first name
+    const size_t record_size_offset = 12, stream_count_offset = 16, length_offset = 20;
+    BOOST_REQUIRE_GT(bytes.size(), length_offset + 4);
+
+    std::vector<std::string> damaged;
+    damaged.push_back(bytes.substr(0, length_offset + 10));
+    damaged.push_back(bytes.substr(0, stream_count_offset + 2));
+    const uint32_t huge = 0xfffffff0;
+    const size_t offsets[] = { record_size_offset, stream_count_offset, length_offset };
+    for (size_t i = 0; i < sizeof(offsets) / sizeof(offsets[0]); i++) {
+        damaged.push_back(bytes);
+        damaged.back().replace(offsets[i], sizeof(huge), reinterpret_cast<const char*>(&huge), sizeof(huge));
+    }
+    damaged.push_back(bytes);
+    damaged.back()[0] = 'X';
+
+    // every one fails before allocating what its header claims
+    for (size_t i = 0; i < damaged.size(); i++) {
+        {
+            std::ofstream out(path.c_str(), std::ios::out | std::ios::binary | std::ios::trunc);
+            out.write(damaged[i].data(), damaged[i].size());
+        }
+        BOOST_CHECK_THROW(DetectionReader reader(path), std::runtime_error);
+    }
+
+    boost::filesystem::remove(path);
+}
+
+BOOST_AUTO_TEST_CASE(full_ring_drops)
+{
+    std::string path = temp_path("drop.bin");
+
+    // the producer never waits: what does not fit in the ring is counted
+    DetectionWriter writer(path, DetectionEncoder::BINARY, stream_names(), 16);
+    const size_t count = 100000;
+    for (size_t i = 0; i < count; i++) writer.push(make_detection(i));
+    writer.close();
+    BOOST_CHECK_EQUAL(writer.written() + writer.dropped(), count);
+
+    DetectionReader reader(path);
+    BOOST_CHECK_EQUAL(reader.read_all().size(), writer.written());
+
+    boost::filesystem::remove(path);
+}
+
+BOOST_AUTO_TEST_CASE(format_names)
+{
+    DetectionEncoder::Format format = DetectionEncoder::CSV;
+    BOOST_CHECK(DetectionEncoder::parse_format("jsonl", format));
+    BOOST_CHECK_EQUAL(format, DetectionEncoder::JSON_LINES);
+    BOOST_CHECK(DetectionEncoder::parse_format("binary", format));
+    BOOST_CHECK_EQUAL(DetectionEncoder::extension(format), std::string("bin"));
+    BOOST_CHECK(!DetectionEncoder::parse_format("xml", format));
+}
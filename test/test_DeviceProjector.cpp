@@ -0,0 +1,113 @@
+#define BOOST_TEST_MODULE test_DeviceProjector
+#include <boost/test/unit_test.hpp>
+#include <cstring>
+#include <opencv2/opencv.hpp>
+
+#include "sonarlog_obstacle_detection/CartesianProjection.hpp"
+#include "sonarlog_obstacle_detection/DeviceProfile.hpp"
+#include "sonarlog_obstacle_detection/DeviceProjector.hpp"
+#include "sonarlog_obstacle_detection/MappedLog.hpp"
+#include "sonarlog_obstacle_detection/SparseBinFilter.hpp"
+#include "sonarlog_obstacle_detection/SyntheticSonar.hpp"
+
+using namespace sonarlog_obstacle_detection;
+
+BOOST_AUTO_TEST_CASE(profile_dispatch)
+{
+    base::samples::Sonar sample;
+
+    SyntheticSonar(SyntheticSonarConfig::multibeam()).next(sample);
+    BOOST_CHECK(profiles::matches<profiles::Gemini>(sample));
+    BOOST_CHECK(!profiles::matches<profiles::BlueView>(sample));
+    BOOST_CHECK_EQUAL(std::string(DeviceProjector::create(sample)->name()), "gemini");
+
+    SyntheticSonar(SyntheticSonarConfig::scanning()).next(sample);
+    BOOST_CHECK(profiles::matches<profiles::Micron>(sample));
+    BOOST_CHECK(!profiles::matches<profiles::Gemini>(sample));
+
+    // a 256 beam sonar with another sector is not a Gemini
+    SyntheticSonarConfig narrow = SyntheticSonarConfig::multibeam();
+    narrow.field_of_view = base::Angle::fromDeg(90);
+    SyntheticSonar(narrow).next(sample);
+    BOOST_CHECK_EQUAL(std::string(DeviceProjector::create(sample)->name()), "generic");
+
+    SyntheticSonarConfig unknown = SyntheticSonarConfig::multibeam();
+    unknown.beam_count = 100;
+    SyntheticSonar(unknown).next(sample);
+    std::auto_ptr<DeviceProjector> generic = DeviceProjector::create(sample);
+    BOOST_CHECK_EQUAL(std::string(generic->name()), "generic");
+    BOOST_CHECK(!generic->scanning());
+    cv::Size size = CartesianTable::default_size(sample);
+    BOOST_CHECK(generic->project(sample) == cv::Rect(0, 0, size.width, size.height));
+}
+
+BOOST_AUTO_TEST_CASE(profile_matches_generic_projection)
+{
+    SyntheticSonar generator(SyntheticSonarConfig::multibeam());
+    base::samples::Sonar sample;
+    generator.next(sample);
+
+    std::auto_ptr<DeviceProjector> projector = DeviceProjector::create(sample);
+    CartesianProjection projection(cv::Size(profiles::Gemini::width, profiles::Gemini::height));
+
+    for (size_t i = 0; i < 5; i++) {
+        generator.next(sample);
+        BOOST_CHECK(projector->project(sample) == cv::Rect(0, 0, profiles::Gemini::width, profiles::Gemini::height));
+
+        const cv::Mat& expected = projection.project(sample);
+        cv::Mat actual = projector->image();
+        BOOST_REQUIRE(actual.size() == expected.size());
+        BOOST_CHECK(memcmp(actual.ptr<float>(), expected.ptr<float>(), expected.total() * sizeof(float)) == 0);
+    }
+
+    // a reconfigured device keeps working through the generic gather
+    SyntheticSonarConfig config = SyntheticSonarConfig::multibeam();
+    config.beam_count = 128;
+    SyntheticSonar(config).next(sample);
+    projector->project(sample);
+    BOOST_CHECK(memcmp(projector->image().ptr<float>(), projection.project(sample).ptr<float>(),
+                       projection.image().total() * sizeof(float)) == 0);
+}
+
+BOOST_AUTO_TEST_CASE(view_matches_sample)
+{
+    SyntheticSonarConfig narrow = SyntheticSonarConfig::multibeam();
+    narrow.field_of_view = base::Angle::fromDeg(90);
+    const SyntheticSonarConfig configs[] = { SyntheticSonarConfig::multibeam(), narrow, SyntheticSonarConfig::scanning() };
+
+    for (size_t c = 0; c < sizeof(configs) / sizeof(configs[0]); c++) {
+        SyntheticSonar generator(configs[c]);
+        base::samples::Sonar sample;
+        std::auto_ptr<DeviceProjector> from_sample, from_view;
+        SparseBinFilter sample_filter(SparseBinFilter::SPATIO_TEMPORAL), view_filter(SparseBinFilter::SPATIO_TEMPORAL);
+
+        for (size_t i = 0; i < 5; i++) {
+            generator.next(sample);
+
+            // the payload moved to the offset where its spans are aligned, as in a mapped log
+            std::vector<char> payload;
+            SonarView::marshal(sample, payload);
+            std::vector<double> storage(payload.size() / sizeof(double) + 2);
+            SonarView view;
+            for (size_t offset = 0; offset < sizeof(double) && !view.aligned; offset++) {
+                char *data = reinterpret_cast<char*>(&storage[0]) + offset;
+                memcpy(data, &payload[0], payload.size());
+                BOOST_REQUIRE(view.parse(data, payload.size()));
+            }
+            BOOST_REQUIRE(view.aligned);
+
+            if (!from_sample.get()) {
+                from_sample = DeviceProjector::create(sample);
+                from_view = DeviceProjector::create(view);
+                BOOST_CHECK_EQUAL(std::string(from_view->name()), from_sample->name());
+            }
+
+            BOOST_CHECK(from_view->project(view) == from_sample->project(sample));
+            BOOST_CHECK_EQUAL(cv::norm(from_view->image(), from_sample->image(), cv::NORM_INF), 0);
+
+            BOOST_CHECK_EQUAL(view_filter.push(view), sample_filter.push(sample));
+            BOOST_CHECK(view_filter.output().bins == sample_filter.output().bins);
+            BOOST_CHECK(view_filter.output().time == sample_filter.output().time);
+        }
+    }
+}
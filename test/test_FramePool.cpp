@@ -0,0 +1,90 @@
+#define BOOST_TEST_MODULE test_FramePool
+#include <boost/test/unit_test.hpp>
+#include <opencv2/opencv.hpp>
+
+#include "sonarlog_obstacle_detection/FramePool.hpp"
+#include "sonarlog_obstacle_detection/SsivDetector.hpp"
+#include "sonarlog_obstacle_detection/SyntheticSonar.hpp"
+
+using namespace sonarlog_obstacle_detection;
+
+BOOST_AUTO_TEST_CASE(allocates_on_geometry_change)
+{
+    FramePool pool;
+    cv::Mat& blurred = pool.get(BUFFER_BLURRED, cv::Size(800, 400), CV_32FC1);
+    const uchar *data = blurred.data;
+    BOOST_CHECK_EQUAL(pool.allocations(), 1);
+    BOOST_CHECK_EQUAL(pool.allocated_bytes(), 800 * 400 * sizeof(float));
+
+    // the same geometry gives the same storage back
+    for (int i = 0; i < 10; i++) {
+        cv::Mat& buffer = pool.get(BUFFER_BLURRED, cv::Size(800, 400), CV_32FC1);
+        BOOST_CHECK(&buffer == &blurred);
+        BOOST_CHECK(buffer.data == data);
+    }
+    BOOST_CHECK_EQUAL(pool.allocations(), 1);
+    BOOST_CHECK_EQUAL(pool.requests(), 11);
+
+    // every buffer id has its own storage
+    cv::Mat& thresh = pool.get(BUFFER_THRESH, cv::Size(800, 400), CV_32FC1);
+    BOOST_CHECK(thresh.data != data);
+    BOOST_CHECK_EQUAL(pool.allocations(), 2);
+
+    pool.reset_counters();
+    pool.get(BUFFER_BLURRED, cv::Size(400, 200), CV_32FC1);
+    pool.get(BUFFER_THRESH, cv::Size(800, 400), CV_8UC1);
+    BOOST_CHECK_EQUAL(pool.allocations(), 2);
+    BOOST_CHECK_EQUAL(pool.allocated_bytes(), 400 * 200 * sizeof(float) + 800 * 400);
+    BOOST_CHECK_EQUAL(pool.requests(), 2);
+}
+
+BOOST_AUTO_TEST_CASE(reused_buffers_match_fresh_buffers)
+{
+    SyntheticSonar generator(SyntheticSonarConfig::scanning());
+    base::samples::Sonar sample;
+    generator.next(sample);
+
+    // the whole frame is in range, so the blocks reach the frame edges
+    SsivParameters parameters;
+    parameters.min_range = 0;
+    parameters.max_range = generator.config().range;
+    parameters.bit_morphology = false;
+    parameters.track_blobs = false;
+
+    // a blob that stays, and one moving along the bottom edge of the frame
+    // into both corners, where the old blocks are left in the pool buffers
+    const cv::Rect fixed(40, 20, 120, 100);
+    const cv::Rect moving[] = {
+        cv::Rect(0, 170, 40, 30),
+        cv::Rect(60, 170, 40, 30),
+        cv::Rect(180, 165, 40, 35),
+        cv::Rect(300, 170, 40, 30),
+        cv::Rect(360, 170, 40, 30),
+        cv::Rect(360, 60, 40, 30),
+        cv::Rect(0, 120, 30, 80)
+    };
+
+    cv::Mat canvas(400, 400, CV_32FC1);
+    SsivDetector reused(parameters);
+    size_t allocations = 0;
+
+    for (size_t i = 0; i < sizeof(moving) / sizeof(moving[0]); i++) {
+        canvas.setTo(0);
+        canvas(fixed).setTo(1);
+        canvas(moving[i]).setTo(0.8);
+
+        cv::Rect dirty = (i) ? (moving[i - 1] | moving[i]) : cv::Rect(0, 0, canvas.cols, canvas.rows);
+        reused.process(canvas, sample, dirty);
+        if (i == 0) allocations = reused.pool().allocations();
+
+        SsivDetector fresh(parameters);
+        fresh.process(canvas, sample);
+
+        BOOST_CHECK_EQUAL(cv::norm(reused.binary(), fresh.binary(), cv::NORM_INF), 0);
+        BOOST_CHECK_EQUAL(reused.target().valid, fresh.target().valid);
+        BOOST_CHECK(reused.target().bbox == fresh.target().bbox);
+    }
+
+    // the pings after the first one only reuse the buffers
+    BOOST_CHECK_EQUAL(reused.pool().allocations(), allocations);
+}
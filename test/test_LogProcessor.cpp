@@ -0,0 +1,128 @@
+#define BOOST_TEST_MODULE test_LogProcessor
+#include <boost/test/unit_test.hpp>
+#include <opencv2/opencv.hpp>
+
+#include "sonarlog_obstacle_detection/BeamDenoiser.hpp"
+#include "sonarlog_obstacle_detection/LogProcessor.hpp"
+#include "sonarlog_obstacle_detection/PolarSweep.hpp"
+#include "sonarlog_obstacle_detection/SyntheticSonar.hpp"
+
+using namespace sonarlog_obstacle_detection;
+
+namespace {
+
+/* options of a processor fed through process_sample(), which never opens its log */
+ProcessingOptions detection_options() {
+    ProcessingOptions options;
+    options.headless = true;
+    options.queue_size = 0;
+    options.detections_output = ".";
+    return options;
+}
+
+}
+
+BOOST_AUTO_TEST_CASE(denoise_feeds_the_detection)
+{
+    ProcessingOptions options = detection_options();
+    LogProcessor raw("synthetic.log", "micron.sonar_samples", options);
+    options.denoise = true;
+    LogProcessor denoised("synthetic.log", "micron.sonar_samples", options);
+
+    SyntheticSonar generator(SyntheticSonarConfig::scanning());
+    BeamDenoiser reference(options.denoise_window);
+    PolarSweep expected;
+    base::samples::Sonar sample;
+
+    raw.start();
+    denoised.start();
+
+    size_t differs = 0;
+    for (size_t i = 0; i < 150; i++) {
+        generator.next(sample);
+        raw.process_sample(sample);
+        denoised.process_sample(sample);
+
+        // the polar detector sees the beams filtered over their own bearing
+        expected.update(reference.apply(sample));
+        BOOST_REQUIRE_EQUAL(cv::norm(denoised.polar_sweep().grid(), expected.grid(), cv::NORM_INF), 0);
+
+        // once a sweep has started the estimates, its input differs from the raw pings
+        if (i >= 100 && cv::norm(raw.polar_sweep().grid(), denoised.polar_sweep().grid(), cv::NORM_INF) > 0) differs++;
+    }
+
+    raw.finish();
+    denoised.finish();
+
+    BOOST_CHECK_EQUAL(differs, 50);
+    BOOST_CHECK(denoised.denoised().bins == reference.output().bins);
+    BOOST_CHECK(raw.denoised().bins.empty());
+}
+
+BOOST_AUTO_TEST_CASE(detectors_see_the_drawn_ping)
+{
+    ProcessingOptions options = detection_options();
+    options.detections_output.clear();
+    options.sweep = "threshold=0.1";
+    options.sweep_jobs = 1;
+    LogProcessor swept("synthetic.log", "micron.sonar_samples", options);
+    options.sweep.clear();
+    options.latency_budget = 1;
+    LogProcessor realtime("synthetic.log", "micron.sonar_samples", options);
+
+    // the range halves in the second sweep, so a detection located with the
+    // newest ping instead of the one drawn lands somewhere else
+    SyntheticSonarConfig config = SyntheticSonarConfig::scanning();
+    config.target_radius = 1.5;
+    SyntheticSonar first(config);
+    config.range = 10;
+    config.bin_count = 200;
+    SyntheticSonar second(config);
+
+    SparseBinFilter filter(SparseBinFilter::SPATIO_TEMPORAL);
+    std::auto_ptr<DeviceProjector> projector;
+    SsivDetector expected;
+    std::vector<base::Time> drawn;
+    base::samples::Sonar sample;
+
+    swept.start();
+    realtime.start();
+
+    size_t found = 0;
+    for (size_t i = 0; i < 120; i++) {
+        if (i < 60) {
+            first.next(sample);
+        }
+        else {
+            second.next(sample);
+            sample.time = base::Time::fromMicroseconds(i * config.ping_period.toMicroseconds());
+        }
+        swept.process_sample(sample);
+        realtime.process_sample(sample);
+
+        if (!filter.push(sample)) continue;
+        drawn.push_back(filter.output().time);
+        if (!projector.get()) projector = DeviceProjector::create(filter.output());
+        projector->project(filter.output());
+        expected.process(projector->image(), filter.output());
+
+        BOOST_REQUIRE(realtime.detector()->target().valid == expected.target().valid);
+        BOOST_REQUIRE(realtime.detector()->target().bbox == expected.target().bbox);
+        BOOST_REQUIRE(realtime.detector()->target().position.x() == expected.target().position.x());
+        BOOST_REQUIRE(realtime.detector()->target().position.y() == expected.target().position.y());
+        if (expected.target().valid) found++;
+    }
+
+    swept.finish();
+    realtime.finish();
+
+    BOOST_CHECK_GT(found, 0);
+
+    // the sweep stamps its detections with the time of the ping on the canvas
+    const std::vector<ParameterSweep::Detection>& track = swept.sweep()->track(0);
+    BOOST_CHECK(!track.empty());
+    for (size_t i = 0; i < track.size(); i++) {
+        BOOST_REQUIRE_LT(track[i].ping, drawn.size());
+        BOOST_CHECK_EQUAL(track[i].time.toMicroseconds(), drawn[track[i].ping].toMicroseconds());
+    }
+}
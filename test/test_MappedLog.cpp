@@ -0,0 +1,131 @@
+#define BOOST_TEST_MODULE test_MappedLog
+#include <boost/test/unit_test.hpp>
+#include <cstdio>
+#include <string>
+#include <vector>
+
+#include "sonarlog_obstacle_detection/MappedLog.hpp"
+#include "sonarlog_obstacle_detection/SyntheticLog.hpp"
+#include "sonarlog_obstacle_detection/SyntheticSonar.hpp"
+
+using namespace sonarlog_obstacle_detection;
+
+namespace {
+
+std::string replace(std::string text, const std::string& from, const std::string& to) {
+    size_t pos = text.find(from);
+    if (pos != std::string::npos) text.replace(pos, from.size(), to);
+    return text;
+}
+
+/* a log with one Sonar stream and another stream in between */
+std::string write_log(const std::vector<base::samples::Sonar>& samples, const std::string& stream_name,
+                      const std::string& registry = SyntheticLog::sonar_registry()) {
+    SyntheticLog log;
+    log.add_stream(stream_name, samples, registry);
+
+    std::string filename = "/tmp/test_MappedLog.log";
+    BOOST_REQUIRE(log.write(filename));
+    return filename;
+}
+
+void check_equal(const base::samples::Sonar& expected, const base::samples::Sonar& actual) {
+    BOOST_CHECK_EQUAL(expected.time.toMicroseconds(), actual.time.toMicroseconds());
+    BOOST_CHECK_EQUAL(expected.bin_duration.toMicroseconds(), actual.bin_duration.toMicroseconds());
+    BOOST_CHECK_EQUAL(expected.bin_count, actual.bin_count);
+    BOOST_CHECK_EQUAL(expected.beam_count, actual.beam_count);
+    BOOST_CHECK_EQUAL(expected.speed_of_sound, actual.speed_of_sound);
+    BOOST_REQUIRE_EQUAL(expected.bearings.size(), actual.bearings.size());
+    for (size_t i = 0; i < expected.bearings.size(); i++) {
+        BOOST_CHECK_EQUAL(expected.bearings[i].getRad(), actual.bearings[i].getRad());
+    }
+    BOOST_CHECK(expected.bins == actual.bins);
+}
+
+}
+
+BOOST_AUTO_TEST_CASE(view_roundtrip)
+{
+    SyntheticSonarConfig config = SyntheticSonarConfig::multibeam();
+    config.beam_count = 16;
+    config.bin_count = 50;
+    SyntheticSonar generator(config);
+
+    base::samples::Sonar sample;
+    generator.next(sample);
+
+    std::vector<char> data;
+    SonarView::marshal(sample, data);
+
+    // an odd offset leaves the spans unaligned
+    for (size_t shift = 0; shift < 2; shift++) {
+        std::vector<char> buffer(shift);
+        buffer.insert(buffer.end(), data.begin(), data.end());
+
+        SonarView view;
+        BOOST_REQUIRE(view.parse(&buffer[shift], data.size()));
+
+        base::samples::Sonar copy;
+        view.copy_to(copy);
+        check_equal(sample, copy);
+    }
+
+    // a truncated payload or a different layout is refused
+    SonarView view;
+    BOOST_CHECK(!view.parse(&data[0], data.size() - 1));
+    data.push_back(0);
+    BOOST_CHECK(!view.parse(&data[0], data.size()));
+}
+
+BOOST_AUTO_TEST_CASE(mapped_log)
+{
+    SyntheticSonar generator(SyntheticSonarConfig::scanning());
+    std::vector<base::samples::Sonar> samples(5);
+    for (size_t i = 0; i < samples.size(); i++) generator.next(samples[i]);
+
+    std::string filename = write_log(samples, "micron.sonar_samples");
+
+    MappedLog log;
+    BOOST_CHECK(!log.open(filename, "missing.sonar_samples"));
+    BOOST_REQUIRE(log.open(filename, "micron.sonar_samples"));
+    BOOST_CHECK(log.uncompressed());
+    BOOST_REQUIRE_EQUAL(log.size(), samples.size());
+
+    for (size_t i = 0; i < samples.size(); i++) {
+        SonarView view;
+        BOOST_REQUIRE(log.view(i, view));
+
+        base::samples::Sonar copy;
+        view.copy_to(copy);
+        check_equal(samples[i], copy);
+    }
+
+    log.close();
+    remove(filename.c_str());
+}
+
+BOOST_AUTO_TEST_CASE(layout_check)
+{
+    std::string registry = SyntheticLog::sonar_registry();
+    BOOST_CHECK(SonarView::matches_layout("/base/samples/Sonar", registry));
+    BOOST_CHECK(!SonarView::matches_layout("/base/samples/SonarBeam", registry));
+    BOOST_CHECK(!SonarView::matches_layout("/base/samples/Sonar", ""));
+
+    // fields in another order, an added field or another field type change the marshalling
+    std::string swapped = replace(replace(registry, "\"bin_count\"", "\"tmp\""), "\"beam_count\"", "\"bin_count\"");
+    BOOST_CHECK(!SonarView::matches_layout("/base/samples/Sonar", replace(swapped, "\"tmp\"", "\"beam_count\"")));
+    BOOST_CHECK(!SonarView::matches_layout("/base/samples/Sonar",
+        replace(registry, "  </compound>\n  <container", "    <field name=\"pulse_length\" type=\"/float\" offset=\"120\" />\n  </compound>\n  <container")));
+    BOOST_CHECK(!SonarView::matches_layout("/base/samples/Sonar", replace(registry, "/int64_t\" offset", "/uint64_t\" offset")));
+
+    // the mapped reader refuses such a stream, so the decoder reads it
+    SyntheticSonar generator(SyntheticSonarConfig::scanning());
+    std::vector<base::samples::Sonar> samples(2);
+    for (size_t i = 0; i < samples.size(); i++) generator.next(samples[i]);
+
+    std::string filename = write_log(samples, "micron.sonar_samples", replace(registry, "/float\" offset=\"80", "/double\" offset=\"80"));
+    MappedLog log;
+    BOOST_CHECK(!log.open(filename, "micron.sonar_samples"));
+    BOOST_CHECK(!log.is_open());
+    remove(filename.c_str());
+}
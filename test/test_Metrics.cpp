@@ -0,0 +1,63 @@
+#define BOOST_TEST_MODULE test_Metrics
+#include <boost/test/unit_test.hpp>
+#include <sstream>
+
+#include "sonarlog_obstacle_detection/Metrics.hpp"
+
+using namespace sonarlog_obstacle_detection;
+
+BOOST_AUTO_TEST_CASE(bucket_limits)
+{
+    for (uint64_t ns = 0; ns < 100000; ns++) {
+        size_t index = LatencyHistogram::bucket(ns);
+        BOOST_REQUIRE(ns <= LatencyHistogram::bucket_limit(index));
+        BOOST_REQUIRE(index == 0 || ns > LatencyHistogram::bucket_limit(index - 1));
+    }
+
+    BOOST_CHECK(LatencyHistogram::bucket(~0ULL) < LatencyHistogram::BUCKET_COUNT);
+}
+
+BOOST_AUTO_TEST_CASE(percentiles)
+{
+    LatencyHistogram histogram;
+    for (uint64_t us = 1; us <= 1000; us++) histogram.record(us * 1000);
+
+    BOOST_CHECK_EQUAL(histogram.count(), 1000);
+    BOOST_CHECK_EQUAL(histogram.max(), 1000000);
+    BOOST_CHECK_CLOSE(histogram.mean(), 500500.0, 1e-9);
+
+    // buckets are a quarter of an octave wide
+    BOOST_CHECK(histogram.percentile(0.50) >= 500000 && histogram.percentile(0.50) <= 500000 * 1.25);
+    BOOST_CHECK(histogram.percentile(0.95) >= 950000 && histogram.percentile(0.95) <= 950000 * 1.25);
+    BOOST_CHECK(histogram.percentile(0.99) >= 990000 && histogram.percentile(0.99) <= 1000000);
+    BOOST_CHECK_EQUAL(histogram.percentile(1.0), 1000000);
+
+    LatencyHistogram other;
+    other.record(5000000);
+    histogram.merge(other);
+    BOOST_CHECK_EQUAL(histogram.count(), 1001);
+    BOOST_CHECK_EQUAL(histogram.max(), 5000000);
+}
+
+BOOST_AUTO_TEST_CASE(summary)
+{
+    Metrics metrics;
+    size_t stage = metrics.add_stage("process");
+    metrics.record(stage, 2000);
+    metrics.count(Metrics::PINGS_PROCESSED);
+    metrics.count(Metrics::PINGS_DETECTED, 3);
+
+    std::ostringstream json;
+    metrics.write_json(json, "a.log");
+    BOOST_CHECK(json.str().find("\"pings_processed\": 1") != std::string::npos);
+    BOOST_CHECK(json.str().find("\"pings_detected\": 3") != std::string::npos);
+    BOOST_CHECK(json.str().find("\"process\": {\"count\": 1") != std::string::npos);
+
+    std::ostringstream csv;
+    metrics.write_csv(csv, "a.log");
+    BOOST_CHECK(csv.str().find("a.log,process,1,2.000,2.000,2.000,2.000,2.000") != std::string::npos);
+
+    metrics.reset();
+    BOOST_CHECK_EQUAL(metrics.counter(Metrics::PINGS_PROCESSED), 0);
+    BOOST_CHECK_EQUAL(metrics.stage(stage).count(), 0);
+}
@@ -0,0 +1,91 @@
+#define BOOST_TEST_MODULE test_MultiStreamProcessor
+#include <boost/test/unit_test.hpp>
+#include <cstdio>
+#include <string>
+#include <vector>
+
+#include "sonarlog_obstacle_detection/LogProcessor.hpp"
+#include "sonarlog_obstacle_detection/MultiStreamProcessor.hpp"
+#include "sonarlog_obstacle_detection/SyntheticLog.hpp"
+#include "sonarlog_obstacle_detection/SyntheticSonar.hpp"
+
+using namespace sonarlog_obstacle_detection;
+
+namespace {
+
+std::vector<base::samples::Sonar> scan(const SyntheticSonarConfig& config, size_t count, int64_t offset) {
+    SyntheticSonar generator(config);
+    std::vector<base::samples::Sonar> samples(count);
+    for (size_t i = 0; i < count; i++) {
+        generator.next(samples[i]);
+        samples[i].time = samples[i].time + base::Time::fromMicroseconds(offset);
+    }
+    return samples;
+}
+
+void check_equal(const detection::TimedTarget& expected, const detection::TimedTarget& actual) {
+    BOOST_CHECK_EQUAL(expected.time.toMicroseconds(), actual.time.toMicroseconds());
+    BOOST_CHECK_EQUAL(expected.ping, actual.ping);
+    BOOST_CHECK(expected.target.bbox == actual.target.bbox);
+    BOOST_CHECK(expected.target.closest == actual.target.closest);
+    BOOST_CHECK_EQUAL(expected.target.position.x(), actual.target.position.x());
+    BOOST_CHECK_EQUAL(expected.target.position.y(), actual.target.position.y());
+}
+
+}
+
+BOOST_AUTO_TEST_CASE(single_pass_matches_separate_streams)
+{
+    // two scanning sonars pinging 20 ms apart, with their targets elsewhere
+    SyntheticSonarConfig front = SyntheticSonarConfig::scanning();
+    front.target_radius = 1.5;
+    SyntheticSonarConfig rear = front;
+    rear.target_range = 4;
+    rear.target_bearing = base::Angle::fromDeg(-20);
+    rear.seed = front.seed + 1;
+
+    std::vector<std::string> names;
+    names.push_back("front.sonar_samples");
+    names.push_back("rear.sonar_samples");
+
+    SyntheticLog log;
+    log.add_stream(names[0], scan(front, 150, 0));
+    log.add_stream(names[1], scan(rear, 150, 20000));
+
+    const std::string filename = "/tmp/test_MultiStreamProcessor.log";
+    BOOST_REQUIRE(log.write(filename));
+
+    ProcessingOptions options;
+    options.headless = true;
+    options.queue_size = 2;
+    options.detections_output = "/tmp";
+
+    MultiStreamProcessor multi(filename, names, options);
+    multi.process_logfile();
+    BOOST_CHECK_EQUAL(multi.throughput().pings(), 300);
+
+    size_t total = 0;
+    for (size_t i = 0; i < names.size(); i++) {
+        LogProcessor separate(filename, names[i], options);
+        separate.process_logfile();
+
+        const std::vector<detection::TimedTarget>& expected = separate.detections();
+        const std::vector<detection::TimedTarget>& actual = multi.processor(i).detections();
+        BOOST_CHECK_EQUAL(multi.processor(i).throughput().pings(), separate.throughput().pings());
+        BOOST_CHECK(!expected.empty());
+        BOOST_REQUIRE_EQUAL(actual.size(), expected.size());
+        for (size_t j = 0; j < expected.size(); j++) check_equal(expected[j], actual[j]);
+        total += expected.size();
+    }
+
+    // the merge keeps every detection, in time order, with its stream
+    const std::vector<detection::TimedTarget>& merged = multi.detections();
+    BOOST_REQUIRE_EQUAL(merged.size(), total);
+    for (size_t j = 0; j < merged.size(); j++) {
+        if (j) BOOST_CHECK(!(merged[j].time < merged[j - 1].time));
+        BOOST_CHECK_EQUAL(merged[j].time.toMicroseconds() % 40000, (merged[j].stream) ? 20000 : 0);
+    }
+
+    remove(filename.c_str());
+    remove("/tmp/test_MultiStreamProcessor.detections.csv");
+}
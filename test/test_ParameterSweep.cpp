@@ -0,0 +1,133 @@
+#define BOOST_TEST_MODULE test_ParameterSweep
+#include <boost/test/unit_test.hpp>
+#include <algorithm>
+#include <cstdlib>
+#include <sstream>
+#include <stdexcept>
+#include <opencv2/opencv.hpp>
+
+#include "sonarlog_obstacle_detection/ParameterSweep.hpp"
+#include "sonarlog_obstacle_detection/SyntheticSonar.hpp"
+
+using namespace sonarlog_obstacle_detection;
+
+BOOST_AUTO_TEST_CASE(parse_grid)
+{
+    std::vector<SsivParameters> configs = ParameterSweep::parse("threshold=0.05:0.2:0.05;morph_size=3,5;min_contour=50");
+    BOOST_REQUIRE_EQUAL(configs.size(), 8);
+    BOOST_CHECK_CLOSE(configs[0].threshold, 0.05, 1e-9);
+    BOOST_CHECK_CLOSE(configs[7].threshold, 0.2, 1e-9);
+    BOOST_CHECK_EQUAL(configs[0].morph_size, 3);
+    BOOST_CHECK_EQUAL(configs[1].morph_size, 5);
+    BOOST_CHECK_EQUAL(configs[1].min_contour_pixels, 50);
+    BOOST_CHECK_EQUAL(configs[1].tracker.min_area, 50);
+    BOOST_CHECK_EQUAL(configs[1].max_range, SsivParameters().max_range);
+
+    BOOST_CHECK_EQUAL(ParameterSweep::parse("").size(), 1);
+    BOOST_CHECK_THROW(ParameterSweep::parse("thresold=0.1"), std::invalid_argument);
+    BOOST_CHECK_THROW(ParameterSweep::parse("threshold=0.1,x"), std::invalid_argument);
+    BOOST_CHECK_THROW(ParameterSweep::parse("threshold=0.2:0.1:0.05"), std::invalid_argument);
+    BOOST_CHECK_THROW(ParameterSweep::parse("min_range=8"), std::invalid_argument);
+}
+
+BOOST_AUTO_TEST_CASE(matches_serial_detectors)
+{
+    std::vector<SsivParameters> configs = ParameterSweep::parse("threshold=0.05,0.1,0.3;morph_size=3,5;min_contour=20,100");
+
+    std::vector<SsivDetector> serial;
+    for (size_t i = 0; i < configs.size(); i++) serial.push_back(SsivDetector(configs[i]));
+
+    ParameterSweep sweep(configs, 3);
+    BOOST_CHECK_EQUAL(sweep.jobs(), 3);
+
+    SyntheticSonar generator(SyntheticSonarConfig::scanning());
+    base::samples::Sonar sample;
+    generator.next(sample);
+
+    srand(5);
+    cv::Mat canvas = cv::Mat::zeros(800, 800, CV_32FC1);
+    for (size_t ping = 0; ping < 10; ping++) {
+        // a moving target over speckle
+        canvas.setTo(0);
+        for (int i = 0; i < 2000; i++) canvas.at<float>(rand() % 400, rand() % 800) = (rand() % 100) / 100.0f;
+        cv::circle(canvas, cv::Point(300 + 10 * ping, 320), 15, cv::Scalar(0.8), -1);
+
+        sweep.process(canvas, sample, cv::Rect(0, 0, 800, 800));
+
+        for (size_t i = 0; i < configs.size(); i++) {
+            serial[i].process(canvas, sample);
+            const detection::Target& expected = serial[i].target();
+            const detection::Target& actual = sweep.detector(i).target();
+            BOOST_CHECK_EQUAL(actual.valid, expected.valid);
+            BOOST_CHECK(actual.bbox == expected.bbox);
+        }
+    }
+
+    BOOST_CHECK_EQUAL(sweep.pings(), 10);
+    for (size_t i = 0; i < configs.size(); i++) {
+        BOOST_CHECK_EQUAL(sweep.latency(i).count(), 10);
+        BOOST_CHECK(sweep.track(i).size() <= 10);
+    }
+
+    // the target is bigger than every min_contour
+    BOOST_CHECK_EQUAL(sweep.track(0).size(), 10);
+    BOOST_CHECK_EQUAL(sweep.track(0).back().ping, 9);
+}
+
+BOOST_AUTO_TEST_CASE(summary_columns)
+{
+    std::vector<SsivParameters> configs = ParameterSweep::parse("track_blobs=0,1");
+    BOOST_REQUIRE_EQUAL(configs.size(), 2);
+
+    ParameterSweep sweep(configs, 1);
+    SyntheticSonar generator(SyntheticSonarConfig::scanning());
+    base::samples::Sonar sample;
+    generator.next(sample);
+
+    cv::Mat canvas = cv::Mat::zeros(800, 800, CV_32FC1);
+    cv::circle(canvas, cv::Point(400, 320), 15, cv::Scalar(0.8), -1);
+    for (size_t ping = 0; ping < 3; ping++) sweep.process(canvas, sample, cv::Rect(0, 0, 800, 800));
+
+    std::ostringstream out;
+    sweep.write_summary(out);
+
+    std::istringstream in(out.str());
+    std::string line, column;
+    std::getline(in, line);
+    std::vector<std::string> header;
+    std::istringstream header_in(line);
+    while (std::getline(header_in, column, ',')) header.push_back(column);
+
+    size_t track_blobs = std::find(header.begin(), header.end(), "track_blobs") - header.begin();
+    size_t detections = std::find(header.begin(), header.end(), "detections") - header.begin();
+    BOOST_REQUIRE(track_blobs < header.size());
+    BOOST_REQUIRE(detections < header.size());
+    size_t pings = std::find(header.begin(), header.end(), "pings") - header.begin();
+    BOOST_REQUIRE(pings < header.size());
+
+    // one row per configuration, with as many columns as the header
+    for (size_t i = 0; i < configs.size(); i++) {
+        BOOST_REQUIRE(std::getline(in, line));
+        std::vector<std::string> row;
+        std::istringstream row_in(line);
+        while (std::getline(row_in, column, ',')) row.push_back(column);
+
+        BOOST_REQUIRE_EQUAL(row.size(), header.size());
+        BOOST_CHECK_EQUAL(atoi(row[0].c_str()), (int)i);
+        BOOST_CHECK_EQUAL(atoi(row[track_blobs].c_str()), (int)i);
+        BOOST_CHECK_EQUAL((size_t)atoi(row[detections].c_str()), sweep.track(i).size());
+
+        // the parameter columns, between config and pings, are names parse() takes with their values
+        for (size_t j = 1; j < pings; j++) {
+            BOOST_CHECK_NO_THROW(ParameterSweep::parse(header[j] + "=" + row[j]));
+        }
+    }
+    BOOST_CHECK(!std::getline(in, line));
+
+    // every grid parameter has a column
+    const char *names[] = { "min_range", "max_range", "threshold", "morph_size", "morph_iterations", "min_contour", "track_blobs" };
+    BOOST_CHECK_EQUAL(pings, 1 + sizeof(names) / sizeof(names[0]));
+    for (size_t j = 0; j < sizeof(names) / sizeof(names[0]); j++) {
+        BOOST_CHECK(std::find(header.begin(), header.begin() + pings, names[j]) != header.begin() + pings);
+    }
+}
@@ -0,0 +1,141 @@
+#define BOOST_TEST_MODULE test_PlotSink
+#include <boost/test/unit_test.hpp>
+#include <vector>
+#include <boost/bind.hpp>
+#include <boost/thread/mutex.hpp>
+#include <boost/thread/condition_variable.hpp>
+#include <opencv2/opencv.hpp>
+
+#include "sonarlog_obstacle_detection/PlotSink.hpp"
+
+using namespace sonarlog_obstacle_detection;
+
+namespace {
+
+/* keeps the first pixel of every frame drawn; a closed gate holds the output */
+class Recorder {
+public:
+
+    Recorder()
+        : open_(true)
+        , waiting_(false) {
+    }
+
+    void draw(const cv::Mat& mat) {
+        boost::mutex::scoped_lock lock(mutex_);
+        waiting_ = true;
+        changed_.notify_all();
+        while (!open_) changed_.wait(lock);
+        waiting_ = false;
+        values_.push_back(mat.at<float>(0, 0));
+    }
+
+    void close() {
+        boost::mutex::scoped_lock lock(mutex_);
+        open_ = false;
+    }
+
+    void open() {
+        boost::mutex::scoped_lock lock(mutex_);
+        open_ = true;
+        changed_.notify_all();
+    }
+
+    /* waits until the output is held by the gate */
+    void wait_blocked() {
+        boost::mutex::scoped_lock lock(mutex_);
+        while (!waiting_) changed_.wait(lock);
+    }
+
+    std::vector<float> values() {
+        boost::mutex::scoped_lock lock(mutex_);
+        return values_;
+    }
+
+private:
+
+    boost::mutex mutex_;
+    boost::condition_variable changed_;
+    bool open_;
+    bool waiting_;
+    std::vector<float> values_;
+};
+
+cv::Mat frame(float value) {
+    return cv::Mat(4, 4, CV_32FC1, cv::Scalar(value));
+}
+
+}
+
+BOOST_AUTO_TEST_CASE(every_nth_frame)
+{
+    Recorder recorder;
+    PlotSink sink(boost::bind(&Recorder::draw, &recorder, _1), 3);
+
+    for (int i = 0; i < 9; i++) {
+        BOOST_CHECK_EQUAL(sink.push(frame(i)), i % 3 == 0);
+        sink.flush();
+    }
+
+    std::vector<float> values = recorder.values();
+    BOOST_REQUIRE_EQUAL(values.size(), 3);
+    BOOST_CHECK_EQUAL(values[0], 0);
+    BOOST_CHECK_EQUAL(values[1], 3);
+    BOOST_CHECK_EQUAL(values[2], 6);
+
+    PlotSink::Stats stats = sink.stats();
+    BOOST_CHECK_EQUAL(stats.pushed, 9);
+    BOOST_CHECK_EQUAL(stats.decimated, 6);
+    BOOST_CHECK_EQUAL(stats.drawn, 3);
+}
+
+BOOST_AUTO_TEST_CASE(max_rate)
+{
+    Recorder recorder;
+    PlotSink sink(boost::bind(&Recorder::draw, &recorder, _1), 1, 10);
+
+    // 40 Hz frames for one second
+    for (int i = 0; i < 40; i++) {
+        sink.push(frame(i), base::Time::fromMilliseconds(25 * i));
+        sink.flush();
+    }
+
+    std::vector<float> values = recorder.values();
+    BOOST_REQUIRE_EQUAL(values.size(), 10);
+    for (size_t i = 0; i < values.size(); i++) BOOST_CHECK_EQUAL(values[i], 4 * i);
+}
+
+BOOST_AUTO_TEST_CASE(latest_frame_wins)
+{
+    Recorder recorder;
+    PlotSink sink(boost::bind(&Recorder::draw, &recorder, _1));
+
+    // the output holds frame 0 while the processing keeps pushing
+    recorder.close();
+    BOOST_CHECK(sink.push(frame(0)));
+    recorder.wait_blocked();
+    for (int i = 1; i <= 4; i++) BOOST_CHECK(sink.push(frame(i)));
+
+    recorder.open();
+    sink.flush();
+
+    std::vector<float> values = recorder.values();
+    BOOST_REQUIRE_EQUAL(values.size(), 2);
+    BOOST_CHECK_EQUAL(values[0], 0);
+    BOOST_CHECK_EQUAL(values[1], 4);
+    BOOST_CHECK_EQUAL(sink.stats().replaced, 3);
+}
+
+BOOST_AUTO_TEST_CASE(stop_draws_the_mailbox)
+{
+    Recorder recorder;
+    PlotSink sink(boost::bind(&Recorder::draw, &recorder, _1));
+
+    sink.push(frame(7));
+    sink.stop();
+    BOOST_CHECK(!sink.push(frame(8)));
+
+    std::vector<float> values = recorder.values();
+    BOOST_REQUIRE_EQUAL(values.size(), 1);
+    BOOST_CHECK_EQUAL(values[0], 7);
+}
@@ -0,0 +1,95 @@
+#define BOOST_TEST_MODULE test_PolarDetector
+#include <boost/test/unit_test.hpp>
+#include <cmath>
+
+#include "sonarlog_obstacle_detection/Labeling.hpp"
+#include "sonarlog_obstacle_detection/PolarDetector.hpp"
+#include "sonarlog_obstacle_detection/PolarSweep.hpp"
+#include "sonarlog_obstacle_detection/SyntheticSonar.hpp"
+
+using namespace sonarlog_obstacle_detection;
+
+namespace {
+
+// closest point of the planted disc
+base::Vector2d expected_position(const SyntheticSonarConfig& config) {
+    double range = config.target_range - config.target_radius;
+    double bearing = config.target_bearing.getRad();
+    return base::Vector2d(range * cos(bearing), range * sin(bearing));
+}
+
+}
+
+BOOST_AUTO_TEST_CASE(connected_components)
+{
+    cv::Mat mask = cv::Mat::zeros(5, 6, CV_8UC1);
+    mask.at<uchar>(0, 0) = 1;
+    mask.at<uchar>(1, 1) = 1;   // diagonal neighbour of (0, 0)
+    mask.at<uchar>(0, 4) = 1;
+    mask.at<uchar>(1, 3) = 1;   // joins (0, 4) and (2, 2) through the diagonals
+    mask.at<uchar>(2, 2) = 1;
+    mask.at<uchar>(4, 5) = 1;
+
+    labeling::Labeler labeler;
+    BOOST_CHECK_EQUAL(labeler.label(mask), 2);
+
+    const std::vector<labeling::Component>& components = labeler.components();
+    BOOST_CHECK_EQUAL(components[0].area, 5);
+    BOOST_CHECK(components[0].bbox == cv::Rect(0, 0, 5, 3));
+    BOOST_CHECK(components[0].first == cv::Point(0, 0));
+    BOOST_CHECK_EQUAL(components[1].area, 1);
+    BOOST_CHECK_EQUAL(labeler.largest(), 0);
+    BOOST_CHECK_EQUAL(labeler.largest(6), -1);
+
+    // a roi leaves the rest unlabeled
+    BOOST_CHECK_EQUAL(labeler.label(mask, cv::Rect(0, 3, 6, 2)), 1);
+    BOOST_CHECK_EQUAL(labeler.labels().at<int>(0, 0), 0);
+}
+
+BOOST_AUTO_TEST_CASE(scanning_target)
+{
+    SyntheticSonarConfig config = SyntheticSonarConfig::scanning();
+    SyntheticSonar generator(config);
+
+    PolarSweep sweep(config.scan_limit, base::Angle::fromRad(-config.scan_limit.getRad()), config.scan_step);
+    base::samples::Sonar sample;
+    for (size_t i = 0; i < 60; i++) {
+        generator.next(sample);
+        sweep.update(sample);
+    }
+
+    BOOST_CHECK_EQUAL(sweep.grid().rows, (int)config.bin_count);
+    BOOST_CHECK_EQUAL(sweep.grid().cols, 50);
+
+    PolarDetector detector;
+    const detection::Target& target = detector.process(sweep);
+
+    BOOST_REQUIRE(target.valid);
+    BOOST_CHECK_SMALL((target.position - expected_position(config)).norm(), 0.3);
+}
+
+BOOST_AUTO_TEST_CASE(multibeam_target)
+{
+    SyntheticSonarConfig config = SyntheticSonarConfig::multibeam();
+    SyntheticSonar generator(config);
+
+    PolarSweep sweep;
+    base::samples::Sonar sample;
+    generator.next(sample);
+    sweep.update(sample);
+
+    BOOST_CHECK_EQUAL(sweep.grid().cols, (int)config.beam_count);
+
+    PolarParameters parameters;
+    parameters.max_range = 20;
+    PolarDetector detector(parameters);
+    const detection::Target& target = detector.process(sweep);
+
+    BOOST_REQUIRE(target.valid);
+    BOOST_CHECK_SMALL((target.position - expected_position(config)).norm(), 0.3);
+
+    // out of the range limits nothing is found
+    parameters.max_range = 10;
+    PolarDetector near_detector(parameters);
+    BOOST_CHECK(!near_detector.process(sweep).valid);
+}
@@ -0,0 +1,134 @@
+#define BOOST_TEST_MODULE test_RlsDenoiser
+#include <boost/test/unit_test.hpp>
+#include <cmath>
+#include <cstdlib>
+#include <cstring>
+#include <vector>
+
+#include "sonarlog_obstacle_detection/BeamDenoiser.hpp"
+#include "sonarlog_obstacle_detection/RlsDenoiser.hpp"
+#include "sonarlog_obstacle_detection/SyntheticSonar.hpp"
+
+using namespace sonarlog_obstacle_detection;
+
+namespace {
+
+std::vector<float> random_frame(size_t size) {
+    std::vector<float> frame(size);
+    for (size_t i = 0; i < size; i++) frame[i] = (rand() % 1000) / 1000.0f;
+    return frame;
+}
+
+}
+
+BOOST_AUTO_TEST_CASE(isa_equivalence)
+{
+    const sparse_bins::Isa isas[] = { sparse_bins::ISA_SSE2, sparse_bins::ISA_AVX2 };
+
+    srand(7);
+    std::vector<std::vector<float> > frames;
+    for (size_t i = 0; i < 20; i++) frames.push_back(random_frame(1003));
+
+    RlsDenoiser reference(4);
+    reference.set_isa(sparse_bins::ISA_SCALAR);
+
+    std::vector<RlsDenoiser> denoisers(2, RlsDenoiser(4));
+    for (size_t j = 0; j < 2; j++) denoisers[j].set_isa(isas[j]);
+
+    for (size_t i = 0; i < frames.size(); i++) {
+        const float *expected = reference.apply(frames[i]);
+
+        for (size_t j = 0; j < 2; j++) {
+            if (!sparse_bins::isa_supported(isas[j])) continue;
+            const float *actual = denoisers[j].apply(frames[i]);
+            BOOST_REQUIRE_MESSAGE(memcmp(expected, actual, frames[i].size() * sizeof(float)) == 0,
+                                  sparse_bins::isa_name(isas[j]) << " differs at frame " << i);
+        }
+    }
+}
+
+BOOST_AUTO_TEST_CASE(converges_to_constant_signal)
+{
+    RlsDenoiser denoiser(4);
+
+    std::vector<float> first(16, 0.0f);
+    std::vector<float> signal(16, 0.5f);
+
+    denoiser.apply(first);
+    for (size_t i = 0; i < 50; i++) denoiser.apply(signal);
+
+    for (size_t i = 0; i < signal.size(); i++) BOOST_CHECK_CLOSE(denoiser.estimate()[i], 0.5f, 1e-3);
+
+    // a new frame size restarts from the frame
+    std::vector<float> other(8, 0.25f);
+    std::vector<float> dst;
+    denoiser.apply(other, dst);
+    BOOST_CHECK(dst == other);
+}
+
+BOOST_AUTO_TEST_CASE(slots_keep_their_history)
+{
+    srand(11);
+    RlsDenoiser slotted(4);
+    std::vector<RlsDenoiser> single(3, RlsDenoiser(4));
+
+    // rows updated in any order match a denoiser per row
+    const size_t order[] = { 0, 2, 2, 1, 0, 2, 1, 1, 0, 0 };
+    for (size_t i = 0; i < sizeof(order) / sizeof(order[0]); i++) {
+        std::vector<float> frame = random_frame(37);
+        const float *actual = slotted.apply(order[i], 3, &frame[0], frame.size());
+        const float *expected = single[order[i]].apply(frame);
+        BOOST_REQUIRE(memcmp(expected, actual, frame.size() * sizeof(float)) == 0);
+    }
+}
+
+BOOST_AUTO_TEST_CASE(scanning_bearings_are_not_mixed)
+{
+    SyntheticSonar generator(SyntheticSonarConfig::scanning());
+    BeamDenoiser denoiser(4);
+
+    // the reference filters each bearing over its own pings only
+    std::vector<RlsDenoiser> bearings(denoiser.slots(), RlsDenoiser(4));
+
+    base::samples::Sonar sample;
+    size_t changed = 0;
+    for (size_t i = 0; i < 200; i++) {
+        generator.next(sample);
+        const base::samples::Sonar& output = denoiser.apply(sample);
+
+        size_t slot = denoiser.slot(sample.bearings[0].getRad());
+        std::vector<float> expected;
+        bearings[slot].apply(sample.bins, expected);
+
+        BOOST_CHECK_EQUAL(output.time.toMicroseconds(), sample.time.toMicroseconds());
+        BOOST_CHECK_EQUAL(output.bearings[0].getRad(), sample.bearings[0].getRad());
+        BOOST_REQUIRE(output.bins == expected);
+        if (output.bins != sample.bins) changed++;
+    }
+
+    // the first sweep starts the estimates, the later ones filter the speckle
+    BOOST_CHECK_GT(changed, 100);
+
+    // neighbouring steps of the scan have their own slots
+    BOOST_CHECK(denoiser.slot(0) != denoiser.slot(M_PI / 100));
+    BOOST_CHECK_EQUAL(denoiser.slot(-M_PI / 100), denoiser.slot(2 * M_PI - M_PI / 100));
+}
+
+BOOST_AUTO_TEST_CASE(multibeam_frames)
+{
+    SyntheticSonarConfig config = SyntheticSonarConfig::multibeam();
+    config.beam_count = 32;
+    config.bin_count = 100;
+    SyntheticSonar generator(config);
+
+    BeamDenoiser denoiser(4);
+    RlsDenoiser reference(4);
+
+    base::samples::Sonar sample;
+    for (size_t i = 0; i < 10; i++) {
+        generator.next(sample);
+        std::vector<float> expected;
+        reference.apply(sample.bins, expected);
+        BOOST_REQUIRE(denoiser.apply(sample).bins == expected);
+    }
+}
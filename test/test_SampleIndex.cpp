@@ -0,0 +1,160 @@
+#define BOOST_TEST_MODULE test_SampleIndex
+#include <boost/test/unit_test.hpp>
+#include <cstdio>
+#include <fstream>
+#include <string>
+#include <vector>
+#include <boost/filesystem.hpp>
+
+#include "rock_util/LogReader.hpp"
+#include "sonarlog_obstacle_detection/SampleIndex.hpp"
+#include "sonarlog_obstacle_detection/SyntheticLog.hpp"
+#include "sonarlog_obstacle_detection/SyntheticSonar.hpp"
+
+using namespace sonarlog_obstacle_detection;
+
+namespace {
+
+const std::string filename = "/tmp/test_SampleIndex.log";
+const std::string stream_name = "micron.sonar_samples";
+
+/* ten scanning pings 40 ms apart, the range doubling after the fifth */
+std::vector<base::samples::Sonar> write_log() {
+    SyntheticSonarConfig config = SyntheticSonarConfig::scanning();
+    SyntheticSonar first(config);
+    config.bin_count *= 2;
+    config.range *= 2;
+    SyntheticSonar second(config);
+
+    std::vector<base::samples::Sonar> samples(10);
+    for (size_t i = 0; i < samples.size(); i++) {
+        if (i < 5) first.next(samples[i]);
+        else second.next(samples[i]);
+        samples[i].time = base::Time::fromMilliseconds(40 * i);
+    }
+
+    SyntheticLog log;
+    log.add_stream(stream_name, samples);
+    BOOST_REQUIRE(log.write(filename));
+    return samples;
+}
+
+/* builds and saves the index of the synthetic log */
+void build_index(SampleIndex& index) {
+    rock_util::LogReader reader(filename);
+    rock_util::LogStream stream = reader.stream(stream_name);
+    stream.set_current_sample_index(3);
+    index.build(filename, stream_name, stream);
+    BOOST_CHECK_EQUAL(stream.current_sample_index(), 3);
+    index.save();
+}
+
+void cleanup() {
+    remove(SampleIndex::sidecar_path(filename, stream_name).c_str());
+    remove(filename.c_str());
+}
+
+}
+
+BOOST_AUTO_TEST_CASE(save_and_load)
+{
+    std::vector<base::samples::Sonar> samples = write_log();
+    SampleIndex built;
+    build_index(built);
+    BOOST_REQUIRE_EQUAL(built.size(), samples.size());
+
+    SampleIndex loaded;
+    BOOST_REQUIRE(loaded.load(filename, stream_name));
+    BOOST_REQUIRE_EQUAL(loaded.size(), samples.size());
+    for (size_t i = 0; i < samples.size(); i++) {
+        SampleIndex::Entry expected = SampleIndex::entry(samples[i]);
+        BOOST_CHECK_EQUAL(loaded[i].time, expected.time);
+        BOOST_CHECK_EQUAL(loaded[i].bin_count, expected.bin_count);
+        BOOST_CHECK_EQUAL(loaded[i].range, expected.range);
+    }
+    BOOST_CHECK_EQUAL(loaded[4].bin_count * 2, loaded[5].bin_count);
+
+    // the sidecar belongs to one stream
+    BOOST_CHECK(!loaded.load(filename, "other.samples"));
+    BOOST_CHECK(loaded.empty());
+
+    cleanup();
+}
+
+BOOST_AUTO_TEST_CASE(changed_log_invalidates)
+{
+    write_log();
+    SampleIndex index;
+    build_index(index);
+    BOOST_REQUIRE(index.load(filename, stream_name));
+
+    // same size, another modification time
+    std::time_t mtime = boost::filesystem::last_write_time(filename);
+    boost::filesystem::last_write_time(filename, mtime + 10);
+    BOOST_CHECK(!index.load(filename, stream_name));
+    boost::filesystem::last_write_time(filename, mtime);
+    BOOST_CHECK(index.load(filename, stream_name));
+
+    // same modification time, another size
+    {
+        std::ofstream log(filename.c_str(), std::ios::binary | std::ios::app);
+        log.put(0);
+    }
+    boost::filesystem::last_write_time(filename, mtime);
+    BOOST_CHECK(!index.load(filename, stream_name));
+
+    cleanup();
+}
+
+BOOST_AUTO_TEST_CASE(damaged_sidecar)
+{
+    write_log();
+    SampleIndex index;
+    build_index(index);
+
+    const std::string path = SampleIndex::sidecar_path(filename, stream_name);
+    const std::streamoff count_offset = 8 + 8 + 8 + 4 + stream_name.size();
+
+    // a count larger than the entries left in the file is refused before any allocation
+    const uint64_t counts[] = { 11, 1ULL << 40, ~0ULL };
+    for (size_t i = 0; i < sizeof(counts) / sizeof(counts[0]); i++) {
+        {
+            std::fstream sidecar(path.c_str(), std::ios::binary | std::ios::in | std::ios::out);
+            sidecar.seekp(count_offset);
+            sidecar.write(reinterpret_cast<const char*>(&counts[i]), sizeof(counts[i]));
+        }
+        BOOST_CHECK(!index.load(filename, stream_name));
+        BOOST_CHECK(index.empty());
+    }
+
+    // a truncated sidecar too
+    build_index(index);
+    boost::filesystem::resize_file(path, boost::filesystem::file_size(path) - 1);
+    BOOST_CHECK(!index.load(filename, stream_name));
+
+    cleanup();
+}
+
+BOOST_AUTO_TEST_CASE(time_bounds)
+{
+    write_log();
+    SampleIndex index;
+    build_index(index);
+
+    // pings at 0, 40, ..., 360 ms
+    BOOST_CHECK_EQUAL(index.lower_bound(base::Time()), 0);
+    BOOST_CHECK_EQUAL(index.lower_bound(base::Time::fromMilliseconds(40)), 1);
+    BOOST_CHECK_EQUAL(index.lower_bound(base::Time::fromMilliseconds(41)), 2);
+    BOOST_CHECK_EQUAL(index.lower_bound(base::Time::fromMilliseconds(361)), 10);
+
+    BOOST_CHECK_EQUAL(index.upper_bound(base::Time::fromMicroseconds(-1)), 0);
+    BOOST_CHECK_EQUAL(index.upper_bound(base::Time::fromMilliseconds(40)), 2);
+    BOOST_CHECK_EQUAL(index.upper_bound(base::Time::fromMilliseconds(79)), 2);
+    BOOST_CHECK_EQUAL(index.upper_bound(base::Time::fromMilliseconds(360)), 10);
+
+    // [lower_bound(from), upper_bound(to)) is the window of samples within [from, to]
+    BOOST_CHECK_EQUAL(index.upper_bound(base::Time::fromMilliseconds(200)) -
+                      index.lower_bound(base::Time::fromMilliseconds(80)), 4);
+
+    cleanup();
+}
@@ -0,0 +1,98 @@
+#define BOOST_TEST_MODULE test_SampleQueue
+#include <boost/test/unit_test.hpp>
+#include <cstdio>
+#include <string>
+#include <vector>
+#include <boost/thread/thread.hpp>
+
+#include "rock_util/LogReader.hpp"
+#include "sonarlog_obstacle_detection/SampleQueue.hpp"
+#include "sonarlog_obstacle_detection/SyntheticLog.hpp"
+#include "sonarlog_obstacle_detection/SyntheticSonar.hpp"
+
+using namespace sonarlog_obstacle_detection;
+
+namespace {
+
+const std::string filename = "/tmp/test_SampleQueue.log";
+const std::string stream_name = "gemini.sonar_samples";
+
+/* a log of count multibeam pings, 100 ms apart */
+std::vector<base::samples::Sonar> write_log(size_t count) {
+    SyntheticSonar generator(SyntheticSonarConfig::multibeam());
+    std::vector<base::samples::Sonar> samples(count);
+    for (size_t i = 0; i < count; i++) generator.next(samples[i]);
+
+    SyntheticLog log;
+    log.add_stream(stream_name, samples);
+    BOOST_REQUIRE(log.write(filename));
+    return samples;
+}
+
+}
+
+BOOST_AUTO_TEST_CASE(stream_order_up_to_end)
+{
+    std::vector<base::samples::Sonar> samples = write_log(10);
+
+    rock_util::LogReader reader(filename);
+    rock_util::LogStream stream = reader.stream(stream_name);
+    stream.set_current_sample_index(2);
+
+    // a ring smaller than the window, so the reader wraps around it
+    SampleQueue queue(stream, 2, 7);
+    queue.start();
+
+    size_t index = 2;
+    while (const base::samples::Sonar *sample = queue.front()) {
+        BOOST_REQUIRE_LT(index, 7);
+        BOOST_CHECK_EQUAL(sample->time.toMicroseconds(), samples[index].time.toMicroseconds());
+        BOOST_CHECK(sample->bins == samples[index].bins);
+        queue.pop();
+        index++;
+    }
+
+    BOOST_CHECK_EQUAL(index, 7);
+    BOOST_CHECK_EQUAL(stream.current_sample_index(), 7);
+    BOOST_CHECK(queue.front() == NULL);
+
+    SampleQueue::Timing timing = queue.timing();
+    BOOST_CHECK_EQUAL(timing.samples, 5);
+    BOOST_CHECK(timing.decode > base::Time());
+    BOOST_CHECK(!(timing.decode < timing.hidden()));
+
+    remove(filename.c_str());
+}
+
+BOOST_AUTO_TEST_CASE(stop_with_a_full_ring)
+{
+    write_log(10);
+
+    rock_util::LogReader reader(filename);
+    rock_util::LogStream stream = reader.stream(stream_name);
+
+    SampleQueue queue(stream, 2);
+    queue.start();
+
+    // the consumer keeps the first sample and stops early: the reader fills
+    // the ring and waits for a free buffer until stop() releases it
+    BOOST_REQUIRE(queue.front());
+    boost::this_thread::sleep(boost::posix_time::milliseconds(100));
+    queue.stop();
+
+    SampleQueue::Timing timing = queue.timing();
+    BOOST_CHECK_EQUAL(timing.samples, 2);
+    BOOST_CHECK(timing.reader_wait > base::Time());
+    BOOST_CHECK_EQUAL(stream.current_sample_index(), 2);
+
+    // a restart goes on from the stream position
+    queue.start();
+    size_t count = 0;
+    while (queue.front()) {
+        queue.pop();
+        count++;
+    }
+    BOOST_CHECK_EQUAL(count, 8);
+
+    remove(filename.c_str());
+}
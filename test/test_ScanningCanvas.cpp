@@ -0,0 +1,138 @@
+#define BOOST_TEST_MODULE test_ScanningCanvas
+#include <boost/test/unit_test.hpp>
+#include <cmath>
+#include <opencv2/opencv.hpp>
+
+#include "sonarlog_obstacle_detection/Detection.hpp"
+#include "sonarlog_obstacle_detection/ScanningCanvas.hpp"
+#include "sonarlog_obstacle_detection/ScanningWedge.hpp"
+#include "sonarlog_obstacle_detection/SyntheticSonar.hpp"
+
+using namespace sonarlog_obstacle_detection;
+
+namespace {
+
+/* canvas pixel of a point at range meters and bearing degrees */
+cv::Point pixel(const ScanningCanvas& canvas, double range, double bearing) {
+    double half = canvas.size() / 2;
+    double radius = range / canvas.meters_per_pixel();
+    return cv::Point(half - radius * sin(bearing * M_PI / 180), half - radius * cos(bearing * M_PI / 180));
+}
+
+/* scanning ping with a single beam at bearing degrees */
+base::samples::Sonar scanning_ping(double bearing) {
+    base::samples::Sonar sample;
+    sample.bin_count = 100;
+    sample.beam_count = 1;
+    sample.beam_width = base::Angle::fromDeg(1);
+    sample.bearings.push_back(base::Angle::fromDeg(bearing));
+    return sample;
+}
+
+/* checks that rect holds every pixel of the arc between two bearings (degrees) */
+void check_arc(const ScanningWedge& wedge, const cv::Rect& rect, double from, double to) {
+    cv::Size size = wedge.size();
+    double radius = std::min(size.width, size.height) / 2.0;
+    for (double bearing = from; bearing <= to; bearing += 0.05) {
+        double angle = bearing * M_PI / 180;
+        cv::Point point(size.width / 2.0 - radius * sin(angle), size.height / 2.0 - radius * cos(angle));
+        point.x = std::min(point.x, size.width - 1);
+        point.y = std::min(point.y, size.height - 1);
+        BOOST_CHECK_MESSAGE(rect.contains(point), "bearing " << bearing << " outside the wedge");
+    }
+}
+
+}
+
+BOOST_AUTO_TEST_CASE(canvas_size_follows_bins_and_range)
+{
+    // one pixel per bin
+    BOOST_CHECK_EQUAL(ScanningCanvas::canvas_size(100, 20, 800, 0.01), 200);
+    BOOST_CHECK_EQUAL(ScanningCanvas::canvas_size(400, 20, 800, 0.01), 800);
+
+    // capped by the maximum size and by the finest pixel
+    BOOST_CHECK_EQUAL(ScanningCanvas::canvas_size(1000, 50, 800, 0.01), 800);
+    BOOST_CHECK_EQUAL(ScanningCanvas::canvas_size(400, 2, 800, 0.01), 400);
+    BOOST_CHECK_EQUAL(ScanningCanvas::canvas_size(400, 2, 800, 0), 800);
+}
+
+BOOST_AUTO_TEST_CASE(dirty_region_covers_changes)
+{
+    SyntheticSonar generator(SyntheticSonarConfig::scanning());
+    ScanningCanvas canvas;
+    base::samples::Sonar sample;
+
+    generator.next(sample);
+    BOOST_CHECK(canvas.update(sample) == cv::Rect(0, 0, 800, 800));
+    BOOST_CHECK_CLOSE(canvas.meters_per_pixel(), 20.0 / 400, 1e-6);
+
+    cv::Mat previous = canvas.image().clone();
+    for (size_t i = 0; i < 60; i++) {
+        generator.next(sample);
+        cv::Rect dirty = canvas.update(sample);
+        BOOST_CHECK(dirty.area() < 800 * 800 / 4);
+
+        // nothing changed outside the returned region
+        cv::Mat outside = canvas.image().clone();
+        previous(dirty).copyTo(outside(dirty));
+        BOOST_CHECK(cv::norm(outside, previous, cv::NORM_INF) == 0);
+        canvas.image().copyTo(previous);
+    }
+    BOOST_CHECK_EQUAL(canvas.retargets(), 1);
+}
+
+BOOST_AUTO_TEST_CASE(range_change_keeps_the_sweep)
+{
+    SyntheticSonarConfig config = SyntheticSonarConfig::scanning();
+    SyntheticSonar generator(config);
+    ScanningCanvas canvas;
+    base::samples::Sonar sample;
+
+    // a full sweep at 20 meters, the target at 5 meters and 10 degrees
+    for (size_t i = 0; i < 60; i++) {
+        generator.next(sample);
+        canvas.update(sample);
+    }
+    cv::Point target = pixel(canvas, 5, 10);
+    BOOST_CHECK_GT(canvas.image().at<float>(target), 0.5f);
+
+    // the first ping at 10 meters (at -45 degrees) shows the old sweep at the new scale
+    config.range = 10;
+    config.bin_count = 200;
+    SyntheticSonar(config).next(sample);
+    BOOST_CHECK(canvas.update(sample) == cv::Rect(0, 0, 400, 400));
+    BOOST_CHECK_EQUAL(canvas.retargets(), 2);
+    BOOST_CHECK_CLOSE(canvas.range(), 10.0, 1e-6);
+    BOOST_CHECK_CLOSE(canvas.meters_per_pixel(), 10.0 / 200, 1e-6);
+
+    target = pixel(canvas, 5, 10);
+    BOOST_CHECK_GT(canvas.image().at<float>(target), 0.5f);
+
+    // getWorldPoint on the forward half keeps the metric scale
+    base::Vector2d position = detection::getWorldPoint(target, cv::Size(canvas.size(), canvas.size() / 2), canvas.range());
+    BOOST_CHECK_SMALL(position.x() - 5 * cos(10 * M_PI / 180), 0.1);
+    BOOST_CHECK_SMALL(position.y() - 5 * sin(10 * M_PI / 180), 0.1);
+}
+
+BOOST_AUTO_TEST_CASE(wedge_crosses_the_stern)
+{
+    ScanningWedge wedge(1000, 1000);
+
+    // both ways across +-180 degrees, the bottom of the canvas is in the wedge
+    BOOST_CHECK(wedge.update(scanning_ping(170)) == cv::Rect(0, 0, 1000, 1000));
+    cv::Rect rect = wedge.update(scanning_ping(-170));
+    BOOST_CHECK_LT(rect.area(), 1000 * 1000 / 4);
+    check_arc(wedge, rect, 169.5, 190.5);
+
+    rect = wedge.update(scanning_ping(170));
+    BOOST_CHECK_LT(rect.area(), 1000 * 1000 / 4);
+    check_arc(wedge, rect, 169.5, 190.5);
+}
+
+BOOST_AUTO_TEST_CASE(wedge_holds_the_arc)
+{
+    ScanningWedge wedge(160, 120);
+    for (int from = -360; from < 360; from += 7) {
+        check_arc(wedge, wedge.wedge(from * M_PI / 180, (from + 25) * M_PI / 180), from, from + 25);
+    }
+}
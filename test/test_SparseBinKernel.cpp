@@ -0,0 +1,96 @@
+#define BOOST_TEST_MODULE test_SparseBinKernel
+#include <boost/test/unit_test.hpp>
+#include <cstdlib>
+#include <cstring>
+#include <limits>
+#include <vector>
+
+#include "sonarlog_obstacle_detection/SparseBinKernel.hpp"
+
+using namespace sonarlog_obstacle_detection;
+
+namespace {
+
+// the loops removeSparsenessBins used before the kernels existed
+void reference_temporal(std::vector<float>& current, const std::vector<float>& last, const std::vector<float>& next) {
+    for (size_t i = 0; i < current.size(); i++) {
+        if(current[i] && !last[i] && !next[i]) {
+            current[i] = 0;
+        }
+    }
+}
+
+void reference_spatio_temporal(std::vector<float>& current, const std::vector<float>& last, const std::vector<float>& next) {
+    for (size_t i = 1; i < current.size() - 1; i++) {
+        if(current[i] && ((!last[i] && !next[i]) || (!current[i - 1] && !current[i+1] ))) {
+            current[i] = 0;
+        }
+    }
+}
+
+std::vector<float> random_bins(size_t size, int density) {
+    std::vector<float> bins(size);
+    for (size_t i = 0; i < size; i++) {
+        int r = rand() % 100;
+        if (r < density) bins[i] = (rand() % 1000 + 1) / 1000.0f;
+        else if (r == 98) bins[i] = -0.0f;
+        else if (r == 99) bins[i] = std::numeric_limits<float>::quiet_NaN();
+        else bins[i] = 0;
+    }
+    return bins;
+}
+
+bool bitwise_equal(const std::vector<float>& a, const std::vector<float>& b) {
+    return a.size() == b.size() && !memcmp(&a[0], &b[0], a.size() * sizeof(float));
+}
+
+void check_isa(sparse_bins::Isa isa) {
+    if (!sparse_bins::isa_supported(isa)) {
+        BOOST_TEST_MESSAGE("skipping " << sparse_bins::isa_name(isa));
+        return;
+    }
+
+    srand(42);
+
+    const size_t sizes[] = { 3, 4, 5, 7, 8, 9, 15, 16, 17, 31, 33, 100, 797, 1500 };
+    const int densities[] = { 5, 30, 60, 90 };
+
+    for (size_t s = 0; s < sizeof(sizes) / sizeof(size_t); s++) {
+        for (size_t d = 0; d < sizeof(densities) / sizeof(int); d++) {
+            std::vector<float> last = random_bins(sizes[s], densities[d]);
+            std::vector<float> current = random_bins(sizes[s], densities[d]);
+            std::vector<float> next = random_bins(sizes[s], densities[d]);
+
+            std::vector<float> expected = current;
+            std::vector<float> actual = current;
+            reference_temporal(expected, last, next);
+            sparse_bins::remove_temporal(&actual[0], &last[0], &next[0], actual.size(), isa);
+            BOOST_CHECK_MESSAGE(bitwise_equal(expected, actual),
+                sparse_bins::isa_name(isa) << " temporal, size " << sizes[s] << ", density " << densities[d]);
+
+            expected = current;
+            actual = current;
+            reference_spatio_temporal(expected, last, next);
+            sparse_bins::remove_spatio_temporal(&actual[0], &last[0], &next[0], actual.size(), isa);
+            BOOST_CHECK_MESSAGE(bitwise_equal(expected, actual),
+                sparse_bins::isa_name(isa) << " spatio-temporal, size " << sizes[s] << ", density " << densities[d]);
+        }
+    }
+}
+
+}
+
+BOOST_AUTO_TEST_CASE(scalar_matches_reference)
+{
+    check_isa(sparse_bins::ISA_SCALAR);
+}
+
+BOOST_AUTO_TEST_CASE(sse2_matches_reference)
+{
+    check_isa(sparse_bins::ISA_SSE2);
+}
+
+BOOST_AUTO_TEST_CASE(avx2_matches_reference)
+{
+    check_isa(sparse_bins::ISA_AVX2);
+}
@@ -0,0 +1,185 @@
+#define BOOST_TEST_MODULE test_SsivDetector
+#include <boost/test/unit_test.hpp>
+#include <cmath>
+#include <opencv2/opencv.hpp>
+
+#include "sonarlog_obstacle_detection/Detection.hpp"
+#include "sonarlog_obstacle_detection/PolarDetector.hpp"
+#include "sonarlog_obstacle_detection/PolarSweep.hpp"
+#include "sonarlog_obstacle_detection/ScanningCanvas.hpp"
+#include "sonarlog_obstacle_detection/SsivDetector.hpp"
+#include "sonarlog_obstacle_detection/SyntheticSonar.hpp"
+
+using namespace sonarlog_obstacle_detection;
+
+namespace {
+
+bool same_target(const detection::Target& actual, const detection::Target& expected) {
+    return actual.valid == expected.valid &&
+           actual.bbox == expected.bbox &&
+           actual.closest == expected.closest &&
+           actual.position.x() == expected.position.x() &&
+           actual.position.y() == expected.position.y();
+}
+
+}
+
+BOOST_AUTO_TEST_CASE(untracked_by_default)
+{
+    BOOST_CHECK(!SsivParameters().track_blobs);
+
+    SyntheticSonarConfig config = SyntheticSonarConfig::scanning();
+    config.target_radius = 1.5;
+    SyntheticSonar generator(config);
+    ScanningCanvas canvas;
+    base::samples::Sonar sample;
+
+    SsivParameters parameters;
+    parameters.min_contour_pixels = 20;
+    parameters.bit_morphology = false;
+    SsivDetector detector(parameters);
+
+    size_t found = 0;
+    for (size_t i = 0; i < 120; i++) {
+        generator.next(sample);
+        cv::Rect dirty = canvas.update(sample);
+        detector.process(canvas.image(), sample, dirty);
+
+        // the blob of findBiggestBlob on the same mask, with the same contour rule
+        detection::Target expected;
+        cv::Mat blobs = detection::findBiggestBlob(detector.binary(), parameters.min_contour_pixels,
+                                                   sample.getBinStartDistance(sample.bin_count), expected);
+
+        BOOST_CHECK(same_target(detector.target(), expected));
+        BOOST_CHECK_EQUAL(cv::norm(detector.blobs(), blobs, cv::NORM_INF), 0);
+        if (expected.valid) found++;
+    }
+
+    // the target at 5 meters is in range and swept twice, the tracker never ran
+    BOOST_CHECK_GT(found, 0);
+    BOOST_CHECK_EQUAL(detector.tracker().full_searches(), 0);
+}
+
+BOOST_AUTO_TEST_CASE(bit_mask_target)
+{
+    BOOST_CHECK(SsivParameters().bit_morphology);
+
+    SyntheticSonarConfig config = SyntheticSonarConfig::scanning();
+    config.target_radius = 1.5;
+    config.speckle_density = 0.1;
+    SyntheticSonar generator(config);
+    ScanningCanvas canvas;
+    base::samples::Sonar sample;
+
+    SsivParameters parameters;
+    parameters.min_contour_pixels = 20;
+    SsivDetector detector(parameters);
+
+    size_t found = 0;
+    for (size_t i = 0; i < 120; i++) {
+        generator.next(sample);
+        cv::Rect dirty = canvas.update(sample);
+
+        // degraded pings copy the threshold into the mask instead of opening it
+        detector.set_skip((i % 7 == 3) ? SsivDetector::SKIP_MORPHOLOGY : SsivDetector::SKIP_NONE);
+        detector.process(canvas.image(), sample, dirty);
+
+        // the bbox and pixel count of the whole binary image
+        cv::Mat binary_8u;
+        detector.binary().convertTo(binary_8u, CV_8U);
+        int area = cv::countNonZero(binary_8u);
+
+        detection::Target expected;
+        if (area > parameters.min_contour_pixels) {
+            std::vector<cv::Point> points;
+            cv::findNonZero(binary_8u, points);
+            expected = detection::getTargetDistance(cv::boundingRect(points), binary_8u.size(),
+                                                    sample.getBinStartDistance(sample.bin_count));
+            BOOST_CHECK_EQUAL(detector.target().area, area);
+            found++;
+        }
+
+        BOOST_CHECK(same_target(detector.target(), expected));
+        BOOST_CHECK(detector.blobs().empty());
+    }
+
+    BOOST_CHECK_GT(found, 0);
+}
+
+BOOST_AUTO_TEST_CASE(dirty_region_matches_whole_frame)
+{
+    // both morphology engines, with the default range and with the whole frame in range
+    for (int config = 0; config < 4; config++) {
+        SsivParameters parameters;
+        parameters.bit_morphology = (config % 2 == 0);
+        if (config >= 2) {
+            parameters.min_range = 0;
+            parameters.max_range = 20;
+        }
+
+        SyntheticSonarConfig sonar = SyntheticSonarConfig::scanning();
+        sonar.target_radius = 1.5;
+        sonar.speckle_density = 0.1;
+        SyntheticSonar generator(sonar);
+        ScanningCanvas canvas;
+        base::samples::Sonar sample;
+
+        SsivDetector incremental(parameters);
+        SsivDetector whole(parameters);
+
+        for (size_t i = 0; i < 120; i++) {
+            generator.next(sample);
+            cv::Rect dirty = canvas.update(sample);
+
+            incremental.process(canvas.image(), sample, dirty);
+            whole.process(canvas.image(), sample);
+
+            BOOST_REQUIRE_EQUAL(cv::norm(incremental.filtered(), whole.filtered(), cv::NORM_INF), 0);
+            BOOST_REQUIRE_EQUAL(cv::norm(incremental.binary(), whole.binary(), cv::NORM_INF), 0);
+            BOOST_REQUIRE(same_target(incremental.target(), whole.target()));
+            if (i) BOOST_CHECK_LT(incremental.processed_pixels(), whole.processed_pixels());
+        }
+    }
+}
+
+BOOST_AUTO_TEST_CASE(polar_detector_agrees)
+{
+    SyntheticSonarConfig config = SyntheticSonarConfig::scanning();
+    config.target_radius = 1.5;
+    SyntheticSonar generator(config);
+    ScanningCanvas canvas;
+    PolarSweep sweep(config.scan_limit, base::Angle::fromRad(-config.scan_limit.getRad()), config.scan_step);
+    base::samples::Sonar sample;
+
+    SsivDetector cartesian;
+    PolarDetector polar;
+
+    // the closest point of the disc, at 3.5 meters
+    const double range = config.target_range - config.target_radius;
+
+    size_t compared = 0;
+    for (size_t i = 0; i < 150; i++) {
+        generator.next(sample);
+        cv::Rect dirty = canvas.update(sample);
+        cartesian.process(canvas.image(), sample, dirty);
+        sweep.update(sample);
+        polar.process(sweep);
+
+        // from the first full sweep on, both see the whole disc
+        if (i < 50) continue;
+
+        // as documented by PolarDetector: one bin, the arc of one column and one
+        // canvas pixel, each twice for the 3x3 blur that either side runs first
+        const double tolerance = 2 * (config.range / config.bin_count +
+                                      range * config.scan_step.getRad() +
+                                      canvas.meters_per_pixel());
+
+        BOOST_REQUIRE(cartesian.target().valid);
+        BOOST_REQUIRE(polar.target().valid);
+        BOOST_CHECK_SMALL((cartesian.target().position - polar.target().position).norm(), tolerance);
+        BOOST_CHECK_SMALL(polar.target().position.norm() - range, tolerance);
+        compared++;
+    }
+
+    BOOST_CHECK_EQUAL(compared, 100);
+}
@@ -0,0 +1,69 @@
+#define BOOST_TEST_MODULE test_SymmetricRemoval
+#include <boost/test/unit_test.hpp>
+#include <cstdlib>
+#include <opencv2/opencv.hpp>
+
+#include "sonarlog_obstacle_detection/Detection.hpp"
+#include "sonarlog_obstacle_detection/SymmetricRemoval.hpp"
+
+using namespace sonarlog_obstacle_detection;
+
+namespace {
+
+/* rect given in right half coordinates, mirrored into the left half */
+cv::Rect mirror(const cv::Rect& rect, int half) {
+    return cv::Rect(half - rect.x - rect.width, rect.y, rect.width, rect.height);
+}
+
+}
+
+BOOST_AUTO_TEST_CASE(mirrored_artefact_removed)
+{
+    cv::Mat src = cv::Mat::zeros(200, 400, CV_32FC1);
+    const int half = src.cols / 2;
+
+    // a faint echo mirrored on both sides of bearing zero
+    const cv::Rect artefact(50, 40, 20, 20);
+    src(artefact + cv::Point(half, 0)).setTo(0.08);
+    src(mirror(artefact, half)).setTo(0.08);
+
+    // a real target on the right side only
+    const cv::Rect target(120, 100, 30, 30);
+    src(target + cv::Point(half, 0)).setTo(0.6);
+
+    cv::Mat dst;
+    SymmetricRemoval symmetric;
+    symmetric.apply(src, dst);
+
+    BOOST_CHECK_EQUAL(cv::norm(dst(artefact + cv::Point(half, 0)), cv::NORM_INF), 0);
+    BOOST_CHECK_EQUAL(cv::norm(dst(mirror(artefact, half)), cv::NORM_INF), 0);
+
+    // the median only trims the corners of the target
+    cv::Rect inside(target.x + 1, target.y + 1, target.width - 2, target.height - 2);
+    cv::Mat kept = dst(inside + cv::Point(half, 0));
+    BOOST_CHECK_EQUAL(cv::norm(kept, src(inside + cv::Point(half, 0)), cv::NORM_INF), 0);
+    BOOST_CHECK_EQUAL(cv::norm(dst(mirror(target, half)), cv::NORM_INF), 0);
+}
+
+BOOST_AUTO_TEST_CASE(matches_reference)
+{
+    srand(5);
+    cv::Mat src(120, 300, CV_32FC1);
+    for (int y = 0; y < src.rows; y++) {
+        for (int x = 0; x < src.cols; x++) {
+            src.at<float>(y, x) = (rand() % 100 < 30) ? (rand() % 1000) / 1000.0f : 0.0f;
+        }
+    }
+
+    cv::Mat dst;
+    SymmetricRemoval symmetric;
+    symmetric.apply(src, dst);
+    BOOST_CHECK_SMALL(cv::norm(dst, detection::removeSymmetricData(src), cv::NORM_INF), 1e-6);
+
+    // a region and its mirror give the same columns as the whole image
+    cv::Mat partial = cv::Mat::zeros(src.size(), CV_32FC1);
+    const cv::Rect region(30, 10, 40, 50);
+    symmetric.apply(src, partial, region);
+    BOOST_CHECK_EQUAL(cv::norm(partial(region + cv::Point(150, 0)), dst(region + cv::Point(150, 0)), cv::NORM_INF), 0);
+    BOOST_CHECK_EQUAL(cv::norm(partial(mirror(region, 150)), dst(mirror(region, 150)), cv::NORM_INF), 0);
+}